@@ -0,0 +1,112 @@
+// Measures frustum culling throughput at every SIMD level the CPU supports.
+//
+// Objects are scattered uniformly through a cube around a camera looking down -z so that about a tenth of them are
+// visible. Culling runs in parallel chunks on the default worker pool so the results include the cost of splitting
+// the work and compacting the visible indices.
+#include <cstdio>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <oberon/memory.hpp>
+#include <oberon/math.hpp>
+#include <oberon/culling.hpp>
+
+namespace {
+
+  constexpr oberon::usize OBJECT_COUNT{ 1'000'000 };
+  constexpr oberon::f32 SCENE_EXTENT{ 200.0f };
+  constexpr oberon::usize WARMUP_ITERATIONS{ 5 };
+  constexpr oberon::usize MEASURED_ITERATIONS{ 50 };
+
+  struct scene final {
+    std::array<std::vector<oberon::f32>, 3> centers{ };
+    std::vector<oberon::f32> radii{ };
+    std::array<std::vector<oberon::f32>, 3> mins{ };
+    std::array<std::vector<oberon::f32>, 3> maxs{ };
+  };
+
+  scene make_scene() {
+    auto result = scene{ };
+    auto generator = std::mt19937{ 42 };
+    auto position = std::uniform_real_distribution<oberon::f32>{ -SCENE_EXTENT, SCENE_EXTENT };
+    auto size = std::uniform_real_distribution<oberon::f32>{ 0.1f, 2.0f };
+    for (auto i = oberon::usize{ 0 }; i < OBJECT_COUNT; ++i)
+    {
+      auto radius = size(generator);
+      result.radii.push_back(radius);
+      for (auto axis = oberon::usize{ 0 }; axis < 3; ++axis)
+      {
+        auto center = position(generator);
+        result.centers[axis].push_back(center);
+        result.mins[axis].push_back(center - radius);
+        result.maxs[axis].push_back(center + radius);
+      }
+    }
+    return result;
+  }
+
+  // Nanoseconds per object.
+  double measure_culling(const std::function<oberon::usize()>& cull) {
+    for (auto i = oberon::usize{ 0 }; i < WARMUP_ITERATIONS; ++i)
+    {
+      cull();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = oberon::usize{ 0 }; i < MEASURED_ITERATIONS; ++i)
+    {
+      cull();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>{ end - start }.count() / (MEASURED_ITERATIONS * OBJECT_COUNT);
+  }
+
+}
+
+int main() {
+  const auto objects = make_scene();
+  const auto camera = oberon::perspective(oberon::PI / 3.0f, 16.0f / 9.0f, 0.1f, 250.0f) *
+                      oberon::look_at({ 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f, 0.0f });
+  const auto frustum = oberon::make_frustum(camera);
+  const auto spheres = oberon::sphere_array{ objects.centers[0], objects.centers[1], objects.centers[2],
+                                             objects.radii };
+  const auto boxes = oberon::box_array{ objects.mins[0], objects.mins[1], objects.mins[2], objects.maxs[0],
+                                        objects.maxs[1], objects.maxs[2] };
+  auto visible = std::vector<oberon::u32>(OBJECT_COUNT);
+  auto visible_count = oberon::usize{ 0 };
+  const auto tests = std::array<std::pair<oberon::cstring, std::function<oberon::usize()>>, 2>{ {
+    { "spheres", [&]() { return visible_count = oberon::cull_spheres(frustum, spheres, visible); } },
+    { "boxes", [&]() { return visible_count = oberon::cull_boxes(frustum, boxes, visible); } }
+  } };
+  constexpr auto levels = std::array<std::pair<oberon::simd_level, oberon::cstring>, 3>{ {
+    { oberon::simd_level::scalar, "scalar" },
+    { oberon::simd_level::sse4, "sse4" },
+    { oberon::simd_level::avx2, "avx2" }
+  } };
+  std::printf("%-10s %-8s %12s %10s %10s\n", "volume", "level", "ns/object", "speedup", "visible");
+  for (const auto& [test_name, test] : tests)
+  {
+    auto scalar_ns = 0.0;
+    for (const auto& [level, level_name] : levels)
+    {
+      if (level > oberon::max_simd_level())
+      {
+        std::printf("%-10s %-8s %12s %10s\n", test_name, level_name, "-", "unsupported");
+        continue;
+      }
+      oberon::set_simd_level(level);
+      auto ns = measure_culling(test);
+      if (level == oberon::simd_level::scalar)
+      {
+        scalar_ns = ns;
+      }
+      std::printf("%-10s %-8s %12.3f %9.2fx %10zu\n", test_name, level_name, ns, scalar_ns / ns, visible_count);
+    }
+  }
+  oberon::set_simd_level(oberon::max_simd_level());
+  return 0;
+}
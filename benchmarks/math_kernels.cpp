@@ -0,0 +1,111 @@
+// Measures the throughput of the batch math kernels at every SIMD level the CPU supports.
+//
+// Each kernel runs over a working set small enough to stay in L2 so that the results reflect arithmetic throughput
+// rather than memory bandwidth. Speedups are relative to the scalar kernels in the same run.
+#include <cstdio>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <oberon/memory.hpp>
+#include <oberon/math.hpp>
+
+namespace {
+
+  constexpr oberon::usize ELEMENT_COUNT{ 4096 };
+  constexpr oberon::usize WARMUP_ITERATIONS{ 100 };
+  constexpr oberon::usize MEASURED_ITERATIONS{ 2000 };
+
+  struct working_set final {
+    std::vector<oberon::mat4> lhs{ };
+    std::vector<oberon::mat4> rhs{ };
+    std::vector<oberon::mat4> matrices{ };
+    std::vector<oberon::vec4> vectors{ };
+    std::vector<oberon::vec4> transformed_vectors{ };
+    std::array<std::vector<oberon::f32>, 3> points{ };
+    std::array<std::vector<oberon::f32>, 3> transformed_points{ };
+  };
+
+  working_set make_working_set() {
+    auto set = working_set{ };
+    for (auto i = oberon::usize{ 0 }; i < ELEMENT_COUNT; ++i)
+    {
+      auto f = static_cast<oberon::f32>(i);
+      auto rotation = oberon::axis_angle(oberon::normalize(oberon::vec3{ 1.0f, f, 2.0f }), f * 0.01f);
+      set.lhs.push_back(oberon::compose_transform({ f, 1.0f, -f }, rotation, { 1.0f, 2.0f, 1.0f }));
+      set.rhs.push_back(oberon::translation({ 0.0f, f, 0.5f }));
+      set.vectors.push_back({ f, -f, f * 0.5f, 1.0f });
+      for (auto& axis : set.points)
+      {
+        axis.push_back(f * 0.25f);
+      }
+    }
+    set.matrices.resize(ELEMENT_COUNT);
+    set.transformed_vectors.resize(ELEMENT_COUNT);
+    for (auto& axis : set.transformed_points)
+    {
+      axis.resize(ELEMENT_COUNT);
+    }
+    return set;
+  }
+
+  // Nanoseconds per element.
+  double measure_kernel(const std::function<void()>& kernel) {
+    for (auto i = oberon::usize{ 0 }; i < WARMUP_ITERATIONS; ++i)
+    {
+      kernel();
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = oberon::usize{ 0 }; i < MEASURED_ITERATIONS; ++i)
+    {
+      kernel();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>{ end - start }.count() / (MEASURED_ITERATIONS * ELEMENT_COUNT);
+  }
+
+}
+
+int main() {
+  auto set = make_working_set();
+  auto camera = oberon::perspective(oberon::PI / 3.0f, 16.0f / 9.0f, 0.1f, 100.0f) *
+                oberon::look_at({ 0.0f, 2.0f, 5.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f });
+  const auto kernels = std::array<std::pair<oberon::cstring, std::function<void()>>, 3>{ {
+    { "multiply_mat4", [&set]() { oberon::multiply_mat4(set.lhs, set.rhs, set.matrices); } },
+    { "transform_vec4", [&]() { oberon::transform_vec4(camera, set.vectors, set.transformed_vectors); } },
+    { "transform_points", [&]() {
+      oberon::transform_points(camera, set.points[0], set.points[1], set.points[2], set.transformed_points[0],
+                               set.transformed_points[1], set.transformed_points[2]);
+    } }
+  } };
+  constexpr auto levels = std::array<std::pair<oberon::simd_level, oberon::cstring>, 3>{ {
+    { oberon::simd_level::scalar, "scalar" },
+    { oberon::simd_level::sse4, "sse4" },
+    { oberon::simd_level::avx2, "avx2" }
+  } };
+  std::printf("%-18s %-8s %12s %10s\n", "kernel", "level", "ns/element", "speedup");
+  for (const auto& [kernel_name, kernel] : kernels)
+  {
+    auto scalar_ns = 0.0;
+    for (const auto& [level, level_name] : levels)
+    {
+      if (level > oberon::max_simd_level())
+      {
+        std::printf("%-18s %-8s %12s %10s\n", kernel_name, level_name, "-", "unsupported");
+        continue;
+      }
+      oberon::set_simd_level(level);
+      auto ns = measure_kernel(kernel);
+      if (level == oberon::simd_level::scalar)
+      {
+        scalar_ns = ns;
+      }
+      std::printf("%-18s %-8s %12.3f %9.2fx\n", kernel_name, level_name, ns, scalar_ns / ns);
+    }
+  }
+  oberon::set_simd_level(oberon::max_simd_level());
+  return 0;
+}
@@ -0,0 +1,88 @@
+// Measures transform_hierarchy updates of a wide, shallow scene with a few hundred thousand nodes.
+//
+// Each scenario writes every world matrix into an instance array the way a renderer's per-frame instance buffer would
+// be filled. Partial updates animate a fraction of the nodes so only they and their descendants are recomputed.
+#include <cstdio>
+
+#include <array>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include <oberon/memory.hpp>
+#include <oberon/math.hpp>
+#include <oberon/transform_hierarchy.hpp>
+
+namespace {
+
+  constexpr oberon::usize ROOT_COUNT{ 1024 };
+  constexpr oberon::usize CHILDREN_PER_NODE{ 8 };
+  constexpr oberon::usize NODE_COUNT{ 300'000 };
+  constexpr oberon::usize WARMUP_ITERATIONS{ 5 };
+  constexpr oberon::usize MEASURED_ITERATIONS{ 50 };
+
+  // Every node has CHILDREN_PER_NODE children apart from the leaves.
+  std::vector<oberon::transform_node> make_scene(oberon::transform_hierarchy& hierarchy) {
+    auto nodes = std::vector<oberon::transform_node>{ };
+    nodes.reserve(NODE_COUNT);
+    hierarchy.reserve(NODE_COUNT);
+    for (auto i = oberon::usize{ 0 }; i < NODE_COUNT; ++i)
+    {
+      auto parent = i < ROOT_COUNT ? oberon::NO_TRANSFORM_NODE : nodes[(i - ROOT_COUNT) / CHILDREN_PER_NODE];
+      auto f = static_cast<oberon::f32>(i % 97);
+      auto local = oberon::transform{ { f, 0.5f, -f }, oberon::axis_angle({ 0.0f, 1.0f, 0.0f }, f * 0.01f),
+                                      { 1.0f, 1.0f, 1.0f } };
+      nodes.push_back(hierarchy.create_node(parent, local));
+    }
+    return nodes;
+  }
+
+  // Milliseconds per update.
+  double measure_updates(oberon::transform_hierarchy& hierarchy, const std::vector<oberon::transform_node>& nodes,
+                         const oberon::usize animated_stride, std::vector<oberon::mat4>& instances) {
+    auto total = std::chrono::nanoseconds{ };
+    for (auto i = oberon::usize{ 0 }; i < WARMUP_ITERATIONS + MEASURED_ITERATIONS; ++i)
+    {
+      auto angle = static_cast<oberon::f32>(i) * 0.01f;
+      for (auto node = oberon::usize{ 0 }; animated_stride && node < std::size(nodes); node += animated_stride)
+      {
+        hierarchy.set_rotation(nodes[node], oberon::axis_angle({ 0.0f, 1.0f, 0.0f }, angle));
+      }
+      auto start = std::chrono::steady_clock::now();
+      hierarchy.update(instances);
+      auto end = std::chrono::steady_clock::now();
+      if (i >= WARMUP_ITERATIONS)
+      {
+        total += end - start;
+      }
+    }
+    return std::chrono::duration<double, std::milli>{ total }.count() / MEASURED_ITERATIONS;
+  }
+
+}
+
+int main() {
+  auto hierarchy = oberon::transform_hierarchy{ };
+  auto nodes = make_scene(hierarchy);
+  auto instances = std::vector<oberon::mat4>(NODE_COUNT);
+  {
+    auto start = std::chrono::steady_clock::now();
+    hierarchy.update(instances);
+    auto end = std::chrono::steady_clock::now();
+    std::printf("%zu nodes in %zu depths\n", hierarchy.size(), hierarchy.depth_count());
+    auto ms = std::chrono::duration<double, std::milli>{ end - start }.count();
+    std::printf("%-28s %10.3f ms\n", "first update", ms);
+  }
+  constexpr auto scenarios = std::array<std::pair<oberon::cstring, oberon::usize>, 4>{ {
+    { "every node animated", 1 },
+    { "1 in 16 nodes animated", 16 },
+    { "1 in 1024 nodes animated", 1024 },
+    { "static", 0 }
+  } };
+  for (const auto& [name, stride] : scenarios)
+  {
+    auto ms = measure_updates(hierarchy, nodes, stride, instances);
+    std::printf("%-28s %10.3f ms %8.2f ns/node\n", name, ms, ms * 1e6 / NODE_COUNT);
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+// Measures the frame time overhead of each debug_context validation profile against a plain context.
+//
+// Every configuration renders the test frame into a 640x480 window with immediate presentation and no frame pacing
+// so that the results reflect CPU and GPU work rather than the display refresh rate. Results depend heavily on the
+// driver and validation layer version so they should be compared within a single run.
+#include <cstdio>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include <oberon/errors.hpp>
+#include <oberon/context.hpp>
+#include <oberon/debug_context.hpp>
+#include <oberon/events.hpp>
+#include <oberon/window.hpp>
+#include <oberon/renderer_3d.hpp>
+
+namespace {
+
+  constexpr oberon::usize WARMUP_FRAMES{ 120 };
+  constexpr oberon::usize MEASURED_FRAMES{ 1200 };
+
+  struct frame_time_summary final {
+    double mean_ms{ };
+    double median_ms{ };
+    double p99_ms{ };
+  };
+
+  frame_time_summary measure_frames(oberon::context& ctx) {
+    auto win = oberon::window{ ctx, { { 0, 0 }, { 640, 480 } } };
+    auto rnd = oberon::renderer_3d{ win };
+    rnd.request_presentation_mode(oberon::presentation_mode::immediate);
+    rnd.disable_frame_pacing();
+    rnd.rebuild();
+    auto ev = oberon::event{ };
+    auto frame_times = std::vector<double>{ };
+    frame_times.reserve(MEASURED_FRAMES);
+    for (auto i = oberon::usize{ 0 }; i < WARMUP_FRAMES + MEASURED_FRAMES; ++i)
+    {
+      auto start = std::chrono::steady_clock::now();
+      while (ctx.poll_events(ev))
+      { }
+      if (rnd.should_rebuild())
+      {
+        rnd.rebuild();
+      }
+      rnd.begin_frame();
+      rnd.draw_test_frame();
+      rnd.end_frame();
+      auto end = std::chrono::steady_clock::now();
+      if (i >= WARMUP_FRAMES)
+      {
+        frame_times.push_back(std::chrono::duration<double, std::milli>{ end - start }.count());
+      }
+    }
+    rnd.dispose();
+    win.dispose();
+    std::sort(std::begin(frame_times), std::end(frame_times));
+    auto summary = frame_time_summary{ };
+    for (const auto frame_time : frame_times)
+    {
+      summary.mean_ms += frame_time;
+    }
+    summary.mean_ms /= std::size(frame_times);
+    summary.median_ms = frame_times[std::size(frame_times) / 2];
+    summary.p99_ms = frame_times[(std::size(frame_times) * 99) / 100];
+    return summary;
+  }
+
+  void print_summary(const oberon::cstring name, const frame_time_summary& summary, const double baseline_ms) {
+    std::printf("%-16s %10.3f %10.3f %10.3f %+9.1f%%\n", name, summary.mean_ms, summary.median_ms, summary.p99_ms,
+                ((summary.mean_ms - baseline_ms) / baseline_ms) * 100.0);
+  }
+
+}
+
+int main() {
+  try
+  {
+    std::printf("%-16s %10s %10s %10s %10s\n", "profile", "mean ms", "median ms", "p99 ms", "overhead");
+    auto baseline = frame_time_summary{ };
+    {
+      auto ctx = oberon::context{ "Validation Profiles", 1, 0, 0 };
+      baseline = measure_frames(ctx);
+      ctx.dispose();
+    }
+    print_summary("none", baseline, baseline.mean_ms);
+    constexpr auto profiles = std::array<std::pair<oberon::validation_profile, oberon::cstring>, 5>{ {
+      { oberon::validation_profile::minimal, "minimal" },
+      { oberon::validation_profile::standard, "standard" },
+      { oberon::validation_profile::synchronization, "synchronization" },
+      { oberon::validation_profile::best_practices, "best_practices" },
+      { oberon::validation_profile::gpu_assisted, "gpu_assisted" }
+    } };
+    for (const auto& [profile, name] : profiles)
+    {
+      auto ctx = oberon::debug_context{
+        "Validation Profiles",
+        1, 0, 0,
+        { "VK_LAYER_KHRONOS_validation" },
+        oberon::CONTEXT_NONE_BIT,
+        profile
+      };
+      // Messages are still counted but logging them would dominate the measurement.
+      oberon::set_log_severity(oberon::log_severity::error);
+      print_summary(name, measure_frames(ctx), baseline.mean_ms);
+      ctx.dispose();
+    }
+  }
+  catch (const oberon::error& err)
+  {
+    std::fprintf(stderr, "%s\n", err.message());
+    return err.result();
+  }
+  return 0;
+}
@@ -2,6 +2,7 @@
 #define OBERON_BOUNDS_HPP
 
 #include "types.hpp"
+#include "math.hpp"
 
 namespace oberon {
 
@@ -37,6 +38,17 @@ namespace oberon {
     extent_3d size{ };
   };
 
+  struct bounding_sphere final {
+    vec3 center{ };
+    f32 radius{ };
+  };
+
+  // An axis aligned box given by its minimum and maximum corners.
+  struct axis_aligned_box final {
+    vec3 min{ };
+    vec3 max{ };
+  };
+
 }
 
 #endif
@@ -1,6 +1,10 @@
 #ifndef OBERON_CONTEXT_HPP
 #define OBERON_CONTEXT_HPP
 
+#include <vector>
+#include <array>
+#include <chrono>
+
 #include "object.hpp"
 
 namespace oberon {
@@ -12,6 +16,46 @@ namespace detail {
 
   struct event;
 
+  enum context_flag_bits : u32 {
+    CONTEXT_NONE_BIT = 0,
+    // Wrap device level Vulkan calls to count them and measure their wall time. Only one context at a time can trace.
+    CONTEXT_VULKAN_CALL_TRACING_BIT = 0x01,
+    // Route Vulkan host allocations through oberon and count them by allocation scope.
+    CONTEXT_HOST_ALLOCATION_TRACKING_BIT = 0x02
+  };
+
+  struct vulkan_call_statistics final {
+    cstring name{ };
+    u64 call_count{ };
+    std::chrono::nanoseconds total_time{ };
+  };
+
+  // Corresponds to VkSystemAllocationScope.
+  enum class host_allocation_scope {
+    command,
+    object,
+    cache,
+    device,
+    instance
+  };
+
+  struct host_allocation_scope_statistics final {
+    u64 allocation_count{ };
+    u64 reallocation_count{ };
+    u64 free_count{ };
+    // Allocations served from the thread local pools.
+    u64 pooled_count{ };
+    usize current_bytes{ };
+    usize peak_bytes{ };
+    // Memory that the driver allocated itself and reported for informational purposes.
+    usize internal_bytes{ };
+  };
+
+  struct host_allocation_statistics final {
+    // Indexed by host_allocation_scope.
+    std::array<host_allocation_scope_statistics, 5> scopes{ };
+  };
+
   class context : public object {
   private:
     void v_dispose() noexcept override;
@@ -24,11 +68,28 @@ namespace detail {
       const u16 application_version_minor,
       const u16 application_version_patch
     );
+    context(
+      const std::string& application_name,
+      const u16 application_version_major,
+      const u16 application_version_minor,
+      const u16 application_version_patch,
+      const u32 flags
+    );
 
     virtual ~context() noexcept;
 
     const std::string& application_name() const;
 
+    bool is_tracing_vulkan_calls() const;
+    // Statistics accumulated since the context was created or since the last reset. Empty if tracing is disabled.
+    std::vector<vulkan_call_statistics> query_vulkan_call_statistics() const;
+    context& reset_vulkan_call_statistics();
+
+    bool is_tracking_host_allocations() const;
+    host_allocation_statistics query_host_allocation_statistics() const;
+    // Reset allocation event counters and peaks. Current byte counts are unaffected.
+    context& reset_host_allocation_counters();
+
     bool poll_events(event& ev);
   };
 
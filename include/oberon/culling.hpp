@@ -0,0 +1,62 @@
+#ifndef OBERON_CULLING_HPP
+#define OBERON_CULLING_HPP
+
+#include <array>
+#include <span>
+
+#include "types.hpp"
+#include "math.hpp"
+#include "bounds.hpp"
+
+namespace oberon {
+
+  // Six inward facing planes stored as { n.x, n.y, n.z, d } with unit normals. A point p is inside a plane when
+  // dot(n, p) + d >= 0. The planes are ordered left, right, bottom, top, near, far.
+  struct frustum final {
+    std::array<vec4, 6> planes{ };
+  };
+
+  // Extract the frustum of a projection * view matrix using Vulkan clip space.
+  frustum make_frustum(const mat4& view_projection) noexcept;
+
+  // Conservative tests. Objects straddling a plane are considered visible.
+  bool is_visible(const frustum& f, const bounding_sphere& sphere) noexcept;
+  bool is_visible(const frustum& f, const axis_aligned_box& box) noexcept;
+
+  // Bounding spheres stored as separate arrays. Every span *must* have the same size.
+  struct sphere_array final {
+    std::span<const f32> center_x{ };
+    std::span<const f32> center_y{ };
+    std::span<const f32> center_z{ };
+    std::span<const f32> radius{ };
+  };
+
+  // Axis aligned boxes stored as separate arrays. Every span *must* have the same size.
+  struct box_array final {
+    std::span<const f32> min_x{ };
+    std::span<const f32> min_y{ };
+    std::span<const f32> min_z{ };
+    std::span<const f32> max_x{ };
+    std::span<const f32> max_y{ };
+    std::span<const f32> max_z{ };
+  };
+
+  /**
+   * Write the index of every object that may be inside f to visible in ascending order.
+   *
+   * Objects are tested 4 or 8 at a time using the kernels selected by current_simd_level() and large arrays are split
+   * into chunks that are culled in parallel.
+   *
+   * @param f The frustum to test against.
+   * @param spheres The bounding volumes of the objects.
+   * @param visible Storage for the visible indices. It *must* be at least as large as the number of objects since
+   *                chunks are culled in place before being compacted.
+   *
+   * @return The number of visible objects.
+   */
+  usize cull_spheres(const frustum& f, const sphere_array& spheres, const std::span<u32> visible);
+  usize cull_boxes(const frustum& f, const box_array& boxes, const std::span<u32> visible);
+
+}
+
+#endif
@@ -43,7 +43,7 @@
 
 namespace oberon {
 
-  void assert(const std::source_location& location, const bool condition, const std::string_view& message_format, ...);
+  void assert(const std::source_location& location, const bool condition, const std::string_view message_format, ...);
 
 }
 
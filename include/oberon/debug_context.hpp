@@ -3,8 +3,10 @@
 
 #include <unordered_set>
 #include <string>
+#include <vector>
 
 #include "context.hpp"
+#include "log.hpp"
 
 namespace oberon {
 namespace detail {
@@ -13,6 +15,32 @@ namespace detail {
 
 }
 
+  // Selects which validation layer checks run and which messages are reported. Profiles are listed roughly from
+  // cheapest to most expensive. Features that need VK_EXT_validation_features are silently omitted when it's
+  // unavailable. benchmarks/validation_profiles measures the frame time overhead of each profile.
+  enum class validation_profile {
+    // Core validation without thread safety, object lifetime, or shader checks. Only warnings and errors are
+    // reported. Intended for performance testing.
+    minimal,
+    // Every check the validation layer runs by default.
+    standard,
+    // Standard checks plus synchronization validation for finding hazards between commands.
+    synchronization,
+    // Standard checks plus best practices warnings, including performance warnings.
+    best_practices,
+    // Standard checks plus GPU assisted validation of shader resource accesses. This is the most expensive profile.
+    gpu_assisted
+  };
+
+  struct validation_message_statistics final {
+    std::string name{ };
+    i32 id{ };
+    // The handle of the first object named by the message. 0 if the message named no objects.
+    u64 object_handle{ };
+    log_severity severity{ };
+    u64 count{ };
+  };
+
   class debug_context final : public context {
   private:
     void v_dispose() noexcept override;
@@ -24,8 +52,33 @@ namespace detail {
       const u16 application_version_patch,
       const std::unordered_set<std::string>& requested_layers
     );
+    debug_context(
+      const std::string& application_name,
+      const u16 application_version_major,
+      const u16 application_version_minor,
+      const u16 application_version_patch,
+      const std::unordered_set<std::string>& requested_layers,
+      const u32 flags
+    );
+    debug_context(
+      const std::string& application_name,
+      const u16 application_version_major,
+      const u16 application_version_minor,
+      const u16 application_version_patch,
+      const std::unordered_set<std::string>& requested_layers,
+      const u32 flags,
+      const validation_profile profile
+    );
 
     ~debug_context() noexcept;
+
+    validation_profile current_validation_profile() const;
+
+    // Every distinct validation message received so far. Counters are also logged when the context is disposed.
+    std::vector<validation_message_statistics> query_validation_messages() const;
+    debug_context& reset_validation_messages();
+    // Set how many times each validation message is logged in full before it is only summarized periodically.
+    debug_context& set_validation_message_limit(const u32 limit);
   };
 
 }
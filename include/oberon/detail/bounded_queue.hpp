@@ -0,0 +1,92 @@
+#ifndef OBERON_DETAIL_BOUNDED_QUEUE_HPP
+#define OBERON_DETAIL_BOUNDED_QUEUE_HPP
+
+#include <array>
+#include <mutex>
+#include <condition_variable>
+
+#include "../types.hpp"
+
+namespace oberon {
+namespace detail {
+
+  // A fixed capacity blocking FIFO used to hand work between threads.
+  // Storage is inline so that pushing and popping never allocates.
+  template <typename Type, usize Capacity>
+  class bounded_queue final {
+  private:
+    std::mutex m_mutex{ };
+    std::condition_variable m_not_empty{ };
+    std::condition_variable m_not_full{ };
+    std::array<Type, Capacity> m_values{ };
+    usize m_head{ };
+    usize m_size{ };
+    bool m_is_closed{ };
+  public:
+    /**
+     * Push a value onto the back of the queue. This blocks while the queue is full.
+     *
+     * @param value The value to push.
+     *
+     * @return true if the value was pushed. false if the queue was closed.
+     */
+    bool push(const Type& value) {
+      auto lock = std::unique_lock{ m_mutex };
+      m_not_full.wait(lock, [this]() { return m_is_closed || m_size < Capacity; });
+      if (m_is_closed)
+      {
+        return false;
+      }
+      m_values[(m_head + m_size) % Capacity] = value;
+      ++m_size;
+      lock.unlock();
+      m_not_empty.notify_one();
+      return true;
+    }
+
+    /**
+     * Pop a value from the front of the queue. This blocks while the queue is empty.
+     *
+     * @param value A reference to store the popped value into.
+     *
+     * @return true if a value was popped. false if the queue was closed and no values remained.
+     */
+    bool pop(Type& value) {
+      auto lock = std::unique_lock{ m_mutex };
+      m_not_empty.wait(lock, [this]() { return m_is_closed || m_size > 0; });
+      if (!m_size)
+      {
+        return false;
+      }
+      value = m_values[m_head];
+      m_head = (m_head + 1) % Capacity;
+      --m_size;
+      lock.unlock();
+      m_not_full.notify_one();
+      return true;
+    }
+
+    // Wake every waiting thread. Subsequent pushes fail and pops fail once the queue is empty.
+    void close() {
+      {
+        auto lock = std::lock_guard{ m_mutex };
+        m_is_closed = true;
+      }
+      m_not_empty.notify_all();
+      m_not_full.notify_all();
+    }
+
+    void reopen() {
+      auto lock = std::lock_guard{ m_mutex };
+      m_is_closed = false;
+    }
+
+    constexpr usize capacity() const noexcept {
+      return Capacity;
+    }
+  };
+
+}
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef OBERON_DETAIL_BUILTIN_SHADERS_HPP
 #define OBERON_DETAIL_BUILTIN_SHADERS_HPP
 
+#include <array>
+#include <span>
+
 #include "../types.hpp"
 #include "../memory.hpp"
 #include "../debug.hpp"
@@ -35,11 +38,26 @@
   OBERON_GET_SHADER_STAGE_BINARY(name, COMPUTE, code, size)
 
 #define OBERON_BUILTIN_SHADERS \
-  OBERON_BUILTIN_SHADER(test_frame, 0)
+  OBERON_BUILTIN_SHADER(test_frame, 0) \
+  OBERON_BUILTIN_SHADER(cull_instances, 1) \
+  OBERON_BUILTIN_SHADER(culled_mesh, 2)
+
+// Variants of builtin shaders built by overriding specialization constants. Every shader also has a default variant
+// using the constant values declared in its GLSL which isn't listed here. Each override is written as
+// OBERON_SPECIALIZE(constant_id, value) where value is the u32 bit pattern of the constant (use std::bit_cast for
+// floats and 0/1 for booleans).
+#define OBERON_BUILTIN_SHADER_VARIANTS \
+  OBERON_BUILTIN_SHADER_VARIANT(test_frame, grayscale, OBERON_SPECIALIZE(0, 1))
+
+#define OBERON_SPECIALIZE(constant_id, value) \
+  oberon::detail::builtin_specialization_value{ (constant_id), (value) }
 
 #define OBERON_BUILTIN_SHADER(name, value) \
   name = (value),
 
+#define OBERON_BUILTIN_SHADER_VARIANT(shader, name, ...) \
+  shader##_##name,
+
 namespace oberon {
 namespace detail {
   enum class builtin_shader_name {
@@ -49,11 +67,137 @@ namespace detail {
 
   const usize BUILTIN_SHADER_COUNT{ static_cast<usize>(builtin_shader_name::max_value) };
 
+  // Named <shader>_<variant>.
+  enum class builtin_shader_variant {
+    OBERON_BUILTIN_SHADER_VARIANTS
+    max_value
+  };
+
+  const usize BUILTIN_SHADER_VARIANT_COUNT{ static_cast<usize>(builtin_shader_variant::max_value) };
+
+  // Builtin pipelines are indexed by a compact ID. The default variant of each shader is indexed by its
+  // builtin_shader_name. Declared variants follow.
+  const usize BUILTIN_PIPELINE_COUNT{ BUILTIN_SHADER_COUNT + BUILTIN_SHADER_VARIANT_COUNT };
+
+  constexpr usize builtin_pipeline_index(const builtin_shader_name name) noexcept {
+    return static_cast<usize>(name);
+  }
+
+  constexpr usize builtin_pipeline_index(const builtin_shader_variant variant) noexcept {
+    return BUILTIN_SHADER_COUNT + static_cast<usize>(variant);
+  }
+
+  struct builtin_specialization_value final {
+    u32 constant_id{ };
+    u32 value{ };
+  };
+
+  struct builtin_shader_variant_info final {
+    builtin_shader_name shader{ };
+    std::span<const builtin_specialization_value> values{ };
+    // Refers to values directly. Shared by every stage. Stages ignore entries for constants they don't declare.
+    VkSpecializationInfo specialization_info{ };
+  };
+
+  // The shader and constant overrides of a declared variant.
+  const builtin_shader_variant_info& get_builtin_shader_variant_info(const builtin_shader_variant variant) noexcept;
+
+  // Embedded SPIR-V is stored as u32 words so code can be passed to vkCreateShaderModule directly.
+  struct builtin_shader_stage final {
+    VkShaderStageFlagBits stage{ };
+    std::span<const u32> code{ };
+  };
+
+  // The tables below are generated from SPIR-V reflection when the shaders are built.
+
+  // Vertex attributes are tightly packed into a single per-vertex binding in location order.
+  struct builtin_vertex_attribute final {
+    u32 location{ };
+    VkFormat format{ };
+    u32 offset{ };
+  };
+
+  struct builtin_descriptor_binding final {
+    u32 binding{ };
+    VkDescriptorType type{ };
+    u32 count{ };
+    VkShaderStageFlags stages{ };
+  };
+
+  struct builtin_descriptor_set final {
+    std::span<const builtin_descriptor_binding> bindings{ };
+    // Equal for every set with identical bindings.
+    u64 key{ };
+  };
+
+  // A specialization constant declared by any stage of a shader.
+  struct builtin_specialization_constant final {
+    u32 constant_id{ };
+    u32 size{ };
+    VkShaderStageFlags stages{ };
+  };
+
+  struct builtin_shader_layout final {
+    std::span<const builtin_vertex_attribute> vertex_attributes{ };
+    u32 vertex_stride{ };
+    // Indexed by set number. Unused set numbers have no bindings.
+    std::span<const builtin_descriptor_set> descriptor_sets{ };
+    std::span<const VkPushConstantRange> push_constant_ranges{ };
+    // Equal for every shader with a compatible pipeline layout.
+    u64 key{ };
+    std::span<const builtin_specialization_constant> specialization_constants{ };
+    // The local workgroup size of a compute shader. Zero for every other shader.
+    std::array<u32, 3> workgroup_size{ };
+  };
+
+  // Fixed function state generated from the pipeline description (<shader>.pipeline.json) of a builtin shader. Null
+  // states are left out of the pipeline. Viewport and scissor state is always dynamic so that nothing here depends on
+  // the swapchain. Vertex input is built from reflection rather than the description.
+  struct builtin_pipeline_description final {
+    readonly_ptr<VkPipelineVertexInputStateCreateInfo> vertex_input_state{ };
+    readonly_ptr<VkPipelineInputAssemblyStateCreateInfo> input_assembly_state{ };
+    readonly_ptr<VkPipelineTessellationStateCreateInfo> tessellation_state{ };
+    readonly_ptr<VkPipelineViewportStateCreateInfo> viewport_state{ };
+    readonly_ptr<VkPipelineRasterizationStateCreateInfo> rasterization_state{ };
+    readonly_ptr<VkPipelineMultisampleStateCreateInfo> multisample_state{ };
+    readonly_ptr<VkPipelineDepthStencilStateCreateInfo> depth_stencil_state{ };
+    readonly_ptr<VkPipelineColorBlendStateCreateInfo> color_blend_state{ };
+    readonly_ptr<VkPipelineDynamicStateCreateInfo> dynamic_state{ };
+  };
+
+  // size is in bytes as expected by VkShaderModuleCreateInfo::codeSize.
   template <builtin_shader_name Name, VkShaderStageFlagBits Stage>
   iresult get_builtin_shader_binary(readonly_ptr<u32>& code, usize& size) noexcept;
+
+  // Every stage of a builtin shader in the order the stages were compiled.
+  template <builtin_shader_name Name>
+  std::span<const builtin_shader_stage> get_builtin_shader_stages() noexcept;
+
+  // Every stage of any builtin shader. Returns an empty span if name isn't a builtin shader.
+  std::span<const builtin_shader_stage> get_builtin_shader_stages(const builtin_shader_name name) noexcept;
+
+  // The vertex input and resource layout of every stage of a builtin shader.
+  template <builtin_shader_name Name>
+  const builtin_shader_layout& get_builtin_shader_layout() noexcept;
+
+  // The layout of any builtin shader. Returns an empty layout if name isn't a builtin shader.
+  const builtin_shader_layout& get_builtin_shader_layout(const builtin_shader_name name) noexcept;
+
+  // The fixed function state of a builtin shader's pipeline. Every builtin graphics shader *must* have a pipeline
+  // description. Compute shaders have an empty description.
+  template <builtin_shader_name Name>
+  const builtin_pipeline_description& get_builtin_pipeline_description() noexcept;
+
+  // The fixed function state of any builtin shader's pipeline. Returns an empty description if name isn't a builtin
+  // shader.
+  const builtin_pipeline_description& get_builtin_pipeline_description(const builtin_shader_name name) noexcept;
+
+  // True if name is a builtin shader made of a single compute stage. Compute shaders have no graphics pipeline.
+  bool is_builtin_compute_shader(const builtin_shader_name name) noexcept;
 }
 }
 
 #undef OBERON_BUILTIN_SHADER
+#undef OBERON_BUILTIN_SHADER_VARIANT
 
 #endif
@@ -6,12 +6,16 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <string>
+#include <vector>
+#include <array>
+#include <mutex>
 
 #include "object_impl.hpp"
 
 #include "x11.hpp"
 #include "vulkan.hpp"
 #include "vulkan_function_table.hpp"
+#include "host_allocator.hpp"
 
 namespace oberon {
 
@@ -27,19 +31,47 @@ namespace detail {
 
     ptr<xcb_connection_t> x11_connection{ };
     ptr<xcb_screen_t> x11_screen{ };
+    std::array<xcb_atom_t, X11_ATOM_COUNT> x11_atoms{ };
+    bool has_x11_randr{ };
+    u8 x11_randr_event_base{ };
+    xcb_randr_output_t x11_primary_output{ };
+    std::vector<x11_monitor> x11_monitors{ };
+    // Set by RandR notifications. The cache is refreshed once the event queue has been emptied so that bursts of
+    // notifications only cost one refresh.
+    bool should_refresh_x11_monitors{ };
 
     vulkan_function_table vkft{ };
+    // Passed to every Vulkan create and destroy call. Null unless host allocation tracking is enabled.
+    readonly_ptr<VkAllocationCallbacks> host_allocator{ };
+    host_allocation_tracker host_allocations{ };
     std::unordered_set<std::string> instance_extensions{ };
     std::unordered_set<std::string> device_extensions{ };
 
     VkInstance instance{ };
     VkPhysicalDevice physical_device{ };
     VkPhysicalDeviceProperties physical_device_properties{ };
+    VkPhysicalDeviceMemoryProperties physical_device_memory_properties{ };
     u32 graphics_transfer_queue_family{  };
     u32 presentation_queue_family{ };
     VkDevice device{ };
+    // VK_KHR_present_id and VK_KHR_present_wait are only usable when both the extension and feature are enabled.
+    bool has_present_id{ };
+    bool has_present_wait{ };
+    bool has_incremental_present{ };
+    // The Vulkan 1.2 drawIndirectCount feature. Required by GPU culling.
+    bool has_draw_indirect_count{ };
+    // The drawIndirectFirstInstance feature. GPU culling writes the instance index to firstInstance.
+    bool has_draw_indirect_first_instance{ };
+    // VK_EXT_calibrated_timestamps is only usable when it can correlate the device clock with CLOCK_MONOTONIC.
+    bool has_calibrated_timestamps{ };
+    // Only a debug_context enables VK_EXT_debug_utils.
+    bool has_debug_utils{ };
+    bool is_tracing_vulkan_calls{ };
     VkQueue graphics_transfer_queue{ };
     VkQueue presentation_queue{ };
+    // Vulkan queues require external synchronization. Pipelined renderers submit and present from separate threads.
+    mutable std::mutex graphics_transfer_queue_mutex{ };
+    mutable std::mutex presentation_queue_mutex{ };
 
     mutable std::unordered_map<umax, ptr<window>> windows{ };
 
@@ -66,6 +98,43 @@ namespace detail {
    */
   iresult connect_to_x11(context_impl& ctx, const cstring displayname) noexcept;
 
+  /**
+   * Intern every atom in OBERON_X11_ATOMS and cache the current RandR monitor configuration in ctx.
+   *
+   * All requests are issued before any reply is waited on. After this returns windows can be created without any
+   * round trips to the X11 server. If RandR 1.3 is available the context will also be subscribed to RandR change
+   * notifications so that the monitor cache can be refreshed by poll_x11_event().
+   *
+   * @param ctx A context connected to an X11 server.
+   *
+   * @return 0 on success. -1 if any atom failed to intern.
+   */
+  iresult cache_x11_server_info(context_impl& ctx) noexcept;
+
+  /**
+   * Refresh the monitor cache stored in ctx.
+   *
+   * This requires two round trips to the X11 server. The first retrieves the screen resources and the primary
+   * output. The second retrieves information for every CRTC in parallel.
+   *
+   * @param ctx A context connected to an X11 server that supports RandR 1.3.
+   *
+   * @return 0 on success. -1 if the screen resources could not be retrieved.
+   */
+  iresult refresh_x11_monitors(context_impl& ctx) noexcept;
+
+  /**
+   * Find the cached monitor that should be used for a fullscreen window.
+   *
+   * @param ctx A context with a prepared monitor cache.
+   *
+   * @return A pointer to the monitor driving the primary output if there is one. Otherwise the first cached monitor.
+   *         If no monitors are cached this returns nullptr.
+   */
+  readonly_ptr<x11_monitor> select_x11_monitor(const context_impl& ctx) noexcept;
+
+  xcb_atom_t get_x11_atom(const context_impl& ctx, const x11_atom atom) noexcept;
+
   /**
    * Stores the intersection of required_extensions, optional_extensions, and the set of available Vulkan instance
    * extensions in ctx.
@@ -3,14 +3,57 @@
 
 #include "../debug_context.hpp"
 
+#include <unordered_map>
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
 #include "context_impl.hpp"
 #include "../debug.hpp"
+#include "../log.hpp"
 
 namespace oberon {
 namespace detail {
 
+  // How many times each validation message is logged in full before it is only summarized.
+  constexpr u32 DEFAULT_VALIDATION_MESSAGE_LIMIT{ 3 };
+  // The minimum time between summaries of a repeating validation message.
+  constexpr std::chrono::seconds VALIDATION_SUMMARY_PERIOD{ 5 };
+
+  // Validation messages are aggregated by message ID and the first object they name.
+  struct validation_message_key final {
+    i32 id{ };
+    u64 object_handle{ };
+
+    bool operator==(const validation_message_key& rhs) const noexcept = default;
+  };
+
+  struct validation_message_key_hash final {
+    usize operator()(const validation_message_key& key) const noexcept;
+  };
+
+  struct validation_message_counter final {
+    std::string name{ };
+    log_severity severity{ };
+    u64 count{ };
+    // Occurrences since the message was last logged or summarized.
+    u64 unreported_count{ };
+    std::chrono::steady_clock::time_point last_report{ };
+  };
+
+  struct validation_message_table final {
+    // Messages arrive on whichever threads make Vulkan calls.
+    mutable std::mutex mutex{ };
+    std::unordered_map<validation_message_key, validation_message_counter, validation_message_key_hash> counters{ };
+    std::atomic<u32> report_limit{ DEFAULT_VALIDATION_MESSAGE_LIMIT };
+  };
+
   struct debug_context_impl final : public context_impl {
     VkDebugUtilsMessengerEXT debug_messenger{ };
+    // Passed to the debug messenger as user data.
+    validation_message_table validation_messages{ };
+    validation_profile profile{ validation_profile::standard };
   };
 
   /**
@@ -36,12 +79,13 @@ namespace detail {
    * VkValidationFeaturesEXT -> VkDebugUtilsMessengerCreateInfoEXT
    *
    * @param ctx A context for use in preparing debugging information. This *must* contain a set of valid instance
-   *            extensions.
+   *            extensions. Its validation message table is used as the messenger's user data so it *must* outlive
+   *            the Vulkan instance. ctx.profile selects the validation features and message filters.
    *
    * @return 0 in all valid cases.
    */
   iresult preload_debugging_context(
-    const debug_context_impl& ctx,
+    debug_context_impl& ctx,
     VkDebugUtilsMessengerCreateInfoEXT& debug_info,
     VkValidationFeaturesEXT& validation_features
   ) noexcept;
@@ -66,6 +110,38 @@ namespace detail {
     const std::string& message
   ) noexcept;
 
+  /**
+   * Count a message received by the debug messenger and decide whether to log it.
+   *
+   * General messages are always logged. Validation and performance messages are logged in full for their first
+   * table.report_limit occurrences per message ID and object. After that a summary of the occurrences is logged at
+   * most once every VALIDATION_SUMMARY_PERIOD. If the message can't be counted because memory is exhausted it's
+   * logged in full without being aggregated.
+   *
+   * @param table The table to count the message in.
+   * @param severity The severity reported by the messenger.
+   * @param types The message types reported by the messenger.
+   * @param data The callback data reported by the messenger.
+   *
+   * @return 1 if anything was logged. 0 otherwise.
+   */
+  iresult record_validation_message(
+    validation_message_table& table,
+    const VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    const VkDebugUtilsMessageTypeFlagsEXT types,
+    const VkDebugUtilsMessengerCallbackDataEXT& data
+  ) noexcept;
+
+  // Copy every counter in table into statistics ordered by descending count. Throws std::bad_alloc if statistics
+  // can't hold every counter.
+  iresult read_validation_message_statistics(
+    const validation_message_table& table,
+    std::vector<validation_message_statistics>& statistics
+  );
+
+  // Log every counter in table ordered by descending count. Returns -1 if there's no memory to collect them.
+  iresult dump_validation_messages(const validation_message_table& table) noexcept;
+
   /**
    * Destroy a VkDebugUtilsMessengerEXT stored in ctx.
    *
@@ -0,0 +1,78 @@
+#ifndef OBERON_DETAIL_DEBUG_LABELS_HPP
+#define OBERON_DETAIL_DEBUG_LABELS_HPP
+
+#include <type_traits>
+
+#include "../types.hpp"
+#include "../memory.hpp"
+
+#include "vulkan.hpp"
+
+// Object names and command buffer labels are only visible to debugging tools when VK_EXT_debug_utils is enabled, which
+// only a debug_context does. When OBERON_ENABLE_DEBUG_LABELS isn't defined every macro below expands to nothing and
+// the format arguments aren't evaluated.
+#if defined(OBERON_ENABLE_DEBUG_LABELS)
+  #define OBERON_NAME_VK_OBJECT(ctx, type, handle, format, ...) \
+    oberon::detail::name_vulkan_object( \
+      (ctx), VK_OBJECT_TYPE_##type, oberon::detail::vulkan_object_handle((handle)), (format) __VA_OPT__(,) __VA_ARGS__ \
+    )
+
+  #define OBERON_BEGIN_VK_LABEL(ctx, command_buffer, name) \
+    oberon::detail::begin_vulkan_label((ctx), (command_buffer), (name))
+
+  #define OBERON_END_VK_LABEL(ctx, command_buffer) \
+    oberon::detail::end_vulkan_label((ctx), (command_buffer))
+#else
+  #define OBERON_NAME_VK_OBJECT(ctx, type, handle, format, ...) ((void) 0)
+
+  #define OBERON_BEGIN_VK_LABEL(ctx, command_buffer, name) ((void) 0)
+
+  #define OBERON_END_VK_LABEL(ctx, command_buffer) ((void) 0)
+#endif
+
+namespace oberon {
+namespace detail {
+
+  struct context_impl;
+
+  // Dispatchable handles are always pointers. Non-dispatchable handles are pointers on 64 bit platforms and u64
+  // otherwise.
+  template <typename Handle>
+  u64 vulkan_object_handle(const Handle handle) noexcept {
+    if constexpr (std::is_pointer_v<Handle>)
+    {
+      return reinterpret_cast<uptr>(handle);
+    }
+    else
+    {
+      return handle;
+    }
+  }
+
+  /**
+   * Attach a printf style name to a Vulkan object.
+   *
+   * @param ctx A context prepared with a valid Vulkan device. If VK_EXT_debug_utils isn't enabled this does nothing.
+   * @param type The type of the object.
+   * @param handle The handle of the object as returned by vulkan_object_handle().
+   * @param format A printf style format string. Names longer than 127 characters are truncated.
+   *
+   * @return 0 in all valid cases.
+   */
+  iresult name_vulkan_object(
+    const context_impl& ctx,
+    const VkObjectType type,
+    const u64 handle,
+    const cstring format,
+    ...
+  ) noexcept;
+
+  // Open a labelled region in command_buffer. Regions nest and must be closed with end_vulkan_label() in the same
+  // command buffer. If VK_EXT_debug_utils isn't enabled this does nothing.
+  iresult begin_vulkan_label(const context_impl& ctx, const VkCommandBuffer command_buffer, const cstring name) noexcept;
+  iresult end_vulkan_label(const context_impl& ctx, const VkCommandBuffer command_buffer) noexcept;
+
+}
+}
+
+#endif
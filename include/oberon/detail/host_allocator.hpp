@@ -0,0 +1,58 @@
+#ifndef OBERON_DETAIL_HOST_ALLOCATOR_HPP
+#define OBERON_DETAIL_HOST_ALLOCATOR_HPP
+
+#include <array>
+#include <atomic>
+
+#include "../types.hpp"
+#include "../context.hpp"
+
+#include "vulkan.hpp"
+
+namespace oberon {
+namespace detail {
+
+  constexpr usize HOST_ALLOCATION_SCOPE_COUNT{ VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1 };
+  // Pooled blocks are aligned to this. Requests with stricter alignment bypass the pools.
+  constexpr usize HOST_ALLOCATION_MIN_ALIGNMENT{ 16 };
+  // Payload sizes of the thread local pools. Larger requests bypass the pools.
+  constexpr std::array<usize, 6> HOST_ALLOCATION_SIZE_CLASSES{ 32, 64, 128, 256, 512, 1024 };
+
+  struct host_allocation_counters final {
+    std::atomic<u64> allocation_count{ };
+    std::atomic<u64> reallocation_count{ };
+    std::atomic<u64> free_count{ };
+    std::atomic<u64> pooled_count{ };
+    std::atomic<usize> current_bytes{ };
+    std::atomic<usize> peak_bytes{ };
+    std::atomic<usize> internal_bytes{ };
+  };
+
+  // Routes driver host allocations made on behalf of one context and counts them by VkSystemAllocationScope.
+  struct host_allocation_tracker final {
+    VkAllocationCallbacks callbacks{ };
+    std::array<host_allocation_counters, HOST_ALLOCATION_SCOPE_COUNT> counters{ };
+  };
+
+  /**
+   * Prepare the allocation callbacks of allocator.
+   *
+   * Command and object scope allocations are served from thread local size class pools. Pooled blocks freed on another
+   * thread join that thread's pool. Other scopes are long lived and are served by the system allocator. Every
+   * allocation is preceded by a header recording its size, scope, and origin so that frees and reallocations never
+   * search.
+   *
+   * @param allocator The allocator to prepare. This *must* not move while any Vulkan object created with it exists.
+   *
+   * @return 0 in all valid cases.
+   */
+  iresult initialize_host_allocator(host_allocation_tracker& allocator) noexcept;
+  iresult read_host_allocation_statistics(const host_allocation_tracker& allocator,
+                                          host_allocation_statistics& statistics) noexcept;
+  // Reset the event counters of allocator. Byte counts describe live memory and are kept.
+  iresult reset_host_allocation_counters(host_allocation_tracker& allocator) noexcept;
+
+}
+}
+
+#endif
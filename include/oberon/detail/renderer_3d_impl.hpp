@@ -2,44 +2,122 @@
 #define OBERON_DETAIL_RENDERER_3D_IMPL_HPP
 
 #include <vector>
+#include <array>
 #include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <chrono>
 
 #include "../renderer_3d.hpp"
 #include "../types.hpp"
+#include "../memory.hpp"
+#include "../math.hpp"
+#include "../culling.hpp"
 
 #include "object_impl.hpp"
 #include "vulkan.hpp"
 #include "builtin_shaders.hpp"
+#include "bounded_queue.hpp"
+#include "resource_registry.hpp"
+#include "shader_hot_reload.hpp"
 
 namespace oberon {
 namespace detail {
 
   constexpr usize MAX_FRAMES_IN_FLIGHT{ 2 }; // should be power of 2.
+  // How long an occluded renderer sleeps per frame.
+  constexpr std::chrono::milliseconds OCCLUDED_FRAME_PERIOD{ 100 };
+  constexpr usize MAX_DAMAGE_RECTS{ 16 };
+  // Used to rate limit skipped frames when the monitor refresh rate is unknown.
+  constexpr f64 DEFAULT_REFRESH_RATE{ 60.0 };
+  // Initial block size of the per-frame scratch arena.
+  constexpr usize FRAME_ARENA_SIZE{ 64 * 1024 };
+  // Each batch culled on the GPU allocates one descriptor set for culling and one for drawing from its frame slot's
+  // descriptor pool.
+  constexpr usize MAX_CULLED_BATCHES{ 256 };
+  // How long the present thread waits for a swapchain image before failing the pipeline instead of hanging.
+  constexpr std::chrono::seconds PIPELINED_ACQUIRE_TIMEOUT{ 1 };
 
   struct context_impl;
   struct window_impl;
 
+  // Vertex, tessellation control, tessellation evaluation, geometry and fragment.
+  constexpr usize MAX_GRAPHICS_PIPELINE_STAGES{ 5 };
+
+  // The runtime part of a builtin pipeline. Fixed function state points into the constant tables of the shader's
+  // builtin_pipeline_description so only shader modules, the layout and the render pass are filled in here.
   struct graphics_pipeline_config final {
-    VkPipelineLayoutCreateInfo pipeline_layout_info{ };
+    std::array<VkPipelineShaderStageCreateInfo, MAX_GRAPHICS_PIPELINE_STAGES> pipeline_stages{ };
     VkGraphicsPipelineCreateInfo graphics_pipeline_info{ };
-    std::vector<VkPipelineShaderStageCreateInfo> pipeline_stages{ };
-    std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions{ };
-    std::vector<VkVertexInputBindingDescription> vertex_binding_descriptions{ };
-    VkPipelineVertexInputStateCreateInfo vertex_input_state_info{ };
-    VkPipelineInputAssemblyStateCreateInfo input_assembly_state_info{ };
-    VkPipelineTessellationStateCreateInfo tessellation_state_info{ };
-    std::vector<VkViewport> viewports{ };
-    std::vector<VkRect2D> scissors{ };
-    VkPipelineViewportStateCreateInfo viewport_state_info{ };
-    VkPipelineRasterizationStateCreateInfo rasterization_state_info{ };
-    VkPipelineMultisampleStateCreateInfo multisample_state_info{ };
-    VkPipelineDepthStencilStateCreateInfo depth_stencil_state_info{ };
-    std::vector<VkPipelineColorBlendAttachmentState> color_blend_attachments{ };
-    VkPipelineColorBlendStateCreateInfo color_blend_state_info{ };
-    std::vector<VkDynamicState> dynamic_states{ };
-    VkPipelineDynamicStateCreateInfo dynamic_state_info{ };
-    std::vector<VkDescriptorSetLayout> descriptor_sets{ };
-    std::vector<VkPushConstantRange> push_constant_ranges{ };
+  };
+
+  // Builtin compute pipelines are indexed by builtin_shader_name. Both handles are null for graphics shaders.
+  struct compute_pipeline final {
+    VkPipeline pipeline{ };
+    VkPipelineLayout layout{ };
+  };
+
+  // Instances of a mesh culled on the GPU during the current frame.
+  struct culled_batch final {
+    VkBuffer vertices{ };
+    VkBuffer indices{ };
+    // The batch's region of the frame's indirect buffer. It holds the u32 draw count followed by one
+    // VkDrawIndexedIndirectCommand per instance.
+    VkBuffer draws{ };
+    VkDeviceSize draws_offset{ };
+    u32 max_draw_count{ };
+    // Binds the instance transforms for drawing.
+    VkDescriptorSet transforms{ };
+  };
+
+  // A frame travelling between the stages of a pipelined renderer. Free slots carry the image acquired for them.
+  struct frame_submission final {
+    usize frame_index{ };
+    u32 image_index{ -1U };
+    // The serial of the frame recorded into the slot.
+    u64 frame_serial{ };
+    VkCommandBuffer command_buffer{ };
+    // Set by the render thread when the commands couldn't be submitted. Discarded frames aren't presented.
+    bool is_discarded{ };
+  };
+
+  // The frame that most recently rendered to a swapchain image.
+  struct swapchain_image_owner final {
+    usize frame_index{ };
+    // 0 if the image hasn't been rendered to.
+    u64 frame_serial{ };
+  };
+
+  enum class bundle_command_type {
+    draw_test_frame
+  };
+
+  // A draw call captured between begin_bundle() and end_bundle().
+  struct bundle_command final {
+    bundle_command_type type{ };
+  };
+
+  // A frame recorded once per swapchain image and then resubmitted unchanged.
+  struct command_bundle final {
+    std::vector<bundle_command> commands{ };
+    // Indexed by swapchain image. VK_NULL_HANDLE until the bundle is recorded against the current swapchain.
+    std::vector<VkCommandBuffer> command_buffers{ };
+    // The renderer's pipeline_generation when each command buffer was recorded.
+    std::vector<u64> pipeline_generations{ };
+  };
+
+  // Regions of a frame that changed since the previous frame.
+  struct frame_damage final {
+    std::array<VkRectLayerKHR, MAX_DAMAGE_RECTS> rects{ };
+    usize size{ };
+    // Set when too many regions were reported. The whole frame is presented in that case.
+    bool is_overflowed{ };
+  };
+
+  enum class frame_pacing {
+    none,
+    refresh_rate,
+    fixed_rate
   };
 
   struct renderer_3d_impl : public object_impl {
@@ -50,6 +128,7 @@ namespace detail {
     std::vector<VkPresentModeKHR> presentation_modes{ };
     // FIFO is always available if presentation is available.
     VkPresentModeKHR current_presentation_mode{ VK_PRESENT_MODE_FIFO_KHR };
+    VkPresentModeKHR requested_presentation_mode{ VK_PRESENT_MODE_FIFO_KHR };
     // Treating VK_FORMAT_UNDEFINED as meaning "unset".
     VkSurfaceFormatKHR current_surface_format{ VK_FORMAT_UNDEFINED, VK_COLOR_SPACE_MAX_ENUM_KHR };
     VkSwapchainKHR swapchain{ };
@@ -62,20 +141,92 @@ namespace detail {
     std::vector<VkFramebuffer> framebuffers{ };
     VkCommandPool graphics_transfer_command_pool{ };
     std::vector<VkCommandBuffer> graphics_transfer_command_buffers{ };
+    // Bundles are recorded once and reused so they can't live in the transient pool.
+    VkCommandPool bundle_command_pool{ };
+    std::vector<command_bundle> bundles{ };
+    bool is_recording_bundle{ };
+    // Scratch memory for transient containers. Reset at the start of every frame.
+    linear_arena frame_arena{ FRAME_ARENA_SIZE };
     // Can't initialize these vectors to the correct size inline because of Most Vexing Parse nonsense.
     std::vector<graphics_pipeline_config> graphics_pipeline_configs{ };
+    // Layouts created from reflected shader tables keyed by their build time keys. Compatible shaders share them.
+    std::unordered_map<u64, VkDescriptorSetLayout> descriptor_set_layouts{ };
+    std::unordered_map<u64, VkPipelineLayout> pipeline_layouts{ };
     VkPipelineCache pipeline_cache{ };
     std::vector<VkPipeline> graphics_pipelines{ };
+    // Compute pipelines don't depend on the swapchain so they're created once and kept across rebuilds.
+    std::vector<compute_pipeline> compute_pipelines{ };
+    // Incremented whenever graphics_pipelines are replaced without rebuilding the renderer.
+    u64 pipeline_generation{ };
+    shader_hot_reload hot_reload{ };
     std::vector<VkSemaphore> render_complete_semaphores{ };
     std::vector<VkSemaphore> image_available_semaphores{ };
     std::vector<VkFence> in_flight_fences{ };
-    std::vector<VkFence> in_flight_images{ };
+    // Only touched by the thread that acquires images. That's the present thread when the renderer is pipelined.
+    std::vector<swapchain_image_owner> in_flight_images{ };
+    // The newest frame that the acquiring thread has seen finish executing.
+    u64 acquire_completed_serial{ };
     usize frame_index{ };
     u32 acquired_image_index{ -1U };
-    bool should_rebuild{ };
+    std::atomic<bool> should_rebuild{ };
+    // Pipelined execution.
+    // Frame slots cycle application -> submit_queue -> render_thread -> present_queue -> present_thread -> free_frames.
+    // The present thread owns the swapchain. Once a frame has been queued for presentation it waits for the slot's
+    // fence and acquires the slot's next image so the application thread never blocks on either.
+    // What the application asked for. The renderer falls back to serial execution when the swapchain has too few images
+    // for the present thread to acquire one per slot.
+    frame_execution requested_execution{ frame_execution::serial };
+    bool is_pipelined{ };
+    bounded_queue<frame_submission, MAX_FRAMES_IN_FLIGHT> free_frames{ };
+    bounded_queue<frame_submission, MAX_FRAMES_IN_FLIGHT> submit_queue{ };
+    bounded_queue<frame_submission, MAX_FRAMES_IN_FLIGHT> present_queue{ };
+    std::thread render_thread{ };
+    std::thread present_thread{ };
+    std::atomic<iresult> pipeline_result{ };
+    // Frame pacing.
+    frame_pacing pacing{ frame_pacing::none };
+    std::chrono::nanoseconds frame_period{ };
+    std::chrono::steady_clock::time_point frame_deadline{ };
+    // The last VK_KHR_present_id value used. Values are never reused so this is also valid across swapchains.
+    std::atomic<u64> present_id{ };
+    u64 swapchain_present_id_base{ };
+    // Occlusion handling.
+    occlusion_policy occlusion{ occlusion_policy::suspend };
+    bool is_frame_skipped{ };
+    // Static frame handling.
+    bool is_frame_unchanged{ };
+    // The window content generation of the last drawn frame. -1 forces the next frame to be drawn.
+    u64 drawn_content_generation{ -1ULL };
+    frame_damage pending_damage{ };
+    // Damage is moved into the slot of the frame being ended so that it travels with the frame through the pipeline.
+    std::array<frame_damage, MAX_FRAMES_IN_FLIGHT> frame_damages{ };
+    // Resources created through the public API.
+    resource_registry resources{ };
+    // The serial of the frame most recently recorded in each slot.
+    std::array<u64, MAX_FRAMES_IN_FLIGHT> frame_serials{ };
+    // Host buffers of per-instance data written by the application. Each frame slot has its own so that writing the
+    // current frame never races with the GPU reading an earlier one.
+    std::array<buffer_handle, MAX_FRAMES_IN_FLIGHT> instance_buffers{ };
+    // GPU culling. Each frame slot has its own descriptor pool and device buffer of indirect draws. Both are reset
+    // when the slot is acquired.
+    std::array<VkDescriptorPool, MAX_FRAMES_IN_FLIGHT> descriptor_pools{ };
+    std::array<buffer_handle, MAX_FRAMES_IN_FLIGHT> indirect_buffers{ };
+    // The first unused byte of the current frame's indirect buffer.
+    VkDeviceSize indirect_buffer_offset{ };
+    std::vector<culled_batch> culled_batches{ };
+    // The main render pass is begun by the first draw of a frame so that culling can be recorded ahead of it.
+    bool is_main_render_pass_open{ };
+    // Two timestamps per frame slot bracketing the frame's commands. Null unless tracing is compiled in and the device
+    // supports calibrated timestamps.
+    VkQueryPool timestamp_query_pool{ };
+    // Timestamps of the graphics queue wrap around after this many bits.
+    u32 timestamp_valid_bits{ };
+    // Whether the frame most recently recorded in each slot wrote timestamps.
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> has_frame_timestamps{ };
   };
 
   iresult retrieve_vulkan_surface_info(const context_impl& ctx, const window_impl& win, renderer_3d_impl& rnd) noexcept;
+  // Pipelined renderers request enough images for every slot to hold one while another is being presented.
   iresult create_vulkan_swapchain(const context_impl& ctx, const window_impl& win, renderer_3d_impl& rnd) noexcept;
   //TODO implmentation
   iresult create_vulkan_depth_stencil(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
@@ -86,18 +237,289 @@ namespace detail {
   iresult create_vulkan_pipeline_cache(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult create_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
 
-  iresult configure_test_frame_pipeline(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  /**
+   * Find or create the pipeline layout of a reflected shader layout.
+   *
+   * Descriptor set and pipeline layouts are created on first use and then reused by every shader with a matching key.
+   * They are destroyed by release_graphics_pipeline_configurations().
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd The renderer that owns the layouts.
+   * @param layout The reflected layout of every stage of the shader.
+   * @param pipeline_layout A reference to store the pipeline layout into.
+   *
+   * @return 0 on success. Otherwise the corresponding VkResult.
+   */
+  iresult acquire_reflected_pipeline_layout(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const builtin_shader_layout& layout,
+    VkPipelineLayout& pipeline_layout
+  ) noexcept;
+
+  /**
+   * Configure one builtin pipeline from the generated tables of its shader.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd The renderer that owns the pipeline.
+   * @param pipeline_index The builtin_pipeline_index() of the pipeline.
+   * @param shader The shader the pipeline is built from.
+   * @param specialization The specialization of every stage or null to use the defaults declared by the shader.
+   *
+   * @return 0 on success. Otherwise the corresponding VkResult.
+   */
+  iresult configure_builtin_pipeline(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize pipeline_index,
+    const builtin_shader_name shader,
+    const readonly_ptr<VkSpecializationInfo> specialization
+  ) noexcept;
+
+  // Configure the default pipeline of every builtin graphics shader and every declared variant. The configurations of
+  // compute shaders are left empty.
+  iresult configure_builtin_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult create_vulkan_graphics_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Create the pipeline of every builtin compute shader.
+   *
+   * Shader modules are destroyed as soon as their pipelines exist since compute shaders aren't hot reloaded. Layouts
+   * are shared with the graphics pipelines and destroyed by release_graphics_pipeline_configurations().
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd A renderer with a prepared pipeline cache.
+   *
+   * @return 0 on success. Otherwise the corresponding VkResult.
+   */
+  iresult create_vulkan_compute_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult destroy_vulkan_compute_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult create_vulkan_descriptor_pools(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult destroy_vulkan_descriptor_pools(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult destroy_vulkan_graphics_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult release_graphics_pipeline_configurations(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
 
+  /**
+   * Create the query pool used to time frames on the GPU.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd The renderer to store the query pool into.
+   *
+   * @return 0 on success, including when the device can't provide calibrated timestamps and no pool is created.
+   *         Otherwise the corresponding VkResult.
+   */
+  iresult create_vulkan_timestamp_queries(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  // Write the first or last timestamp of the current frame slot into its command buffer. Timestamps are only written
+  // while a trace is active. These must be recorded outside of a render pass.
+  iresult write_frame_begin_timestamp(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult write_frame_end_timestamp(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Convert the timestamps of the previous frame recorded in the current slot to the trace clock and record them as
+   * a GPU trace event. The frame *must* have finished executing.
+   *
+   * @return 0 on success or if the frame has no timestamps. Otherwise the corresponding VkResult.
+   */
+  iresult collect_frame_timestamps(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult destroy_vulkan_timestamp_queries(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Make sure the instance buffer of the current frame slot holds at least size bytes.
+   *
+   * A buffer that's too small is replaced by a host buffer at least twice its size. The old buffer is retired so the
+   * frame that last used the slot is unaffected. The frame slot *must* have been acquired.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd The renderer that owns the instance buffers.
+   * @param size The number of bytes required. Must be greater than 0.
+   *
+   * @return 0 on success. -1 if no host visible memory type exists. Otherwise the corresponding VkResult.
+   */
+  iresult reserve_frame_instance_buffer(const context_impl& ctx, renderer_3d_impl& rnd, const usize size) noexcept;
+
+  // Forget the culled batches of the frame that last used the current slot and reset its descriptor pool. The frame
+  // slot *must* have been acquired.
+  iresult reset_frame_culling(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Record a dispatch that tests the bounding sphere of every instance of a mesh against a frustum and appends an
+   * indexed draw of the mesh for every visible instance to the frame's indirect buffer.
+   *
+   * The frame slot *must* have been acquired and the main render pass *must not* have begun.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd The renderer recording the frame.
+   * @param mesh The mesh to draw. Its vertices are tightly packed vec3 positions and its indices are u32.
+   * @param bounds A storage buffer of instance_count world space spheres stored as { center, radius }.
+   * @param transforms A storage buffer of instance_count model matrices.
+   * @param instance_count The number of instances to cull. This *must* be greater than 0.
+   * @param f The frustum to test against.
+   * @param batch A reference to store the index of the new batch in rnd.culled_batches into.
+   *
+   * @return 0 on success. -1 if a handle is stale, the instance count is 0 or exceeds the dispatch or storage buffer
+   *         range limits, or the frame has culled MAX_CULLED_BATCHES batches already. Otherwise the corresponding
+   *         VkResult.
+   */
+  iresult cull_mesh_instances(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const mesh_handle mesh,
+    const buffer_handle bounds,
+    const buffer_handle transforms,
+    const u32 instance_count,
+    const frustum& f,
+    usize& batch
+  ) noexcept;
+
+  // Draw every visible instance of a culled batch with a single vkCmdDrawIndexedIndirectCount.
+  iresult draw_culled_batch(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize batch,
+    const mat4& view_projection
+  ) noexcept;
+
   iresult reset_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult begin_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  // Begin the main render pass unless it's already open. Draws written by culling earlier in the frame are made
+  // visible to it first.
   iresult begin_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  // End the main render pass. It's begun first if nothing was drawn so that the frame is still cleared.
   iresult end_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult draw_test_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  /**
+   * Sleep until the next frame deadline of rnd.
+   *
+   * If VK_KHR_present_wait is available and the renderer isn't pipelined this will first wait for the most recently
+   * presented frame to be displayed. This bounds latency when using MAILBOX or IMMEDIATE presentation. Deadlines that
+   * have been missed by more than one period are resynchronized rather than caught up on.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param win The window that rnd presents to.
+   * @param rnd The renderer to pace.
+   *
+   * @return 0 in all valid cases.
+   */
+  iresult pace_frame(const context_impl& ctx, const window_impl& win, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Apply the occlusion policy of rnd. If win is invisible this sleeps for OCCLUDED_FRAME_PERIOD unless the policy is
+   * occlusion_policy::none.
+   *
+   * @param win The window that rnd presents to.
+   * @param rnd The renderer to throttle.
+   *
+   * @return 1 if the next frame should be skipped. 0 otherwise.
+   */
+  iresult throttle_occluded_frame(const window_impl& win, renderer_3d_impl& rnd) noexcept;
+  /**
+   * Determine whether the next frame of rnd can be skipped because it was marked unchanged.
+   *
+   * If the frame is skipped and the renderer isn't paced this sleeps for one refresh period of the monitor displaying
+   * win. That prevents loops drawing only unchanged frames from spinning.
+   *
+   * @param win The window that rnd presents to.
+   * @param rnd The renderer.
+   *
+   * @return 1 if the next frame should be skipped. 0 otherwise.
+   */
+  iresult skip_unchanged_frame(const window_impl& win, renderer_3d_impl& rnd) noexcept;
+  iresult add_frame_damage(renderer_3d_impl& rnd, const bounding_rect& rect) noexcept;
+  /**
+   * Wait for the previous frame in a slot to finish executing and then acquire a swapchain image for the slot.
+   *
+   * If the image is still in use by a frame from another slot this waits for that frame too. That frame is always the
+   * newest in its slot so its fence can't be reset by another thread during the wait. Only the thread that owns the
+   * swapchain may call this.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd A renderer with a prepared swapchain and synchronization objects.
+   * @param frame_index The slot to acquire an image for.
+   * @param previous_serial The serial of the frame most recently recorded into the slot.
+   * @param timeout The maximum time in nanoseconds to wait for an image.
+   * @param image_index A reference to store the index of the acquired image into. -1U if no image was acquired.
+   *
+   * @return 0 on success. Otherwise the corresponding VkResult.
+   */
+  iresult acquire_frame_image(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize frame_index,
+    const u64 previous_serial,
+    const u64 timeout,
+    u32& image_index
+  ) noexcept;
   iresult acquire_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
-  iresult submit_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult submit_frame_commands(const context_impl& ctx, renderer_3d_impl& rnd, const frame_submission& frame) noexcept;
+  iresult present_frame(const context_impl& ctx, renderer_3d_impl& rnd, const frame_submission& frame) noexcept;
+  iresult submit_frame(const context_impl& ctx, renderer_3d_impl& rnd, const VkCommandBuffer commands) noexcept;
+
+  // Start capturing draw calls into a new command bundle.
+  iresult begin_command_bundle(renderer_3d_impl& rnd) noexcept;
+  // Stop capturing draw calls and return the index of the captured bundle.
+  usize end_command_bundle(renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Record the command buffer of a bundle for a swapchain image if it hasn't already been recorded.
+   *
+   * The command buffer must not be pending execution. This is guaranteed after the image has been acquired with
+   * acquire_frame_image().
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param rnd A renderer with prepared framebuffers and graphics pipelines.
+   * @param bundle The bundle to record.
+   * @param image_index The swapchain image to record for.
+   *
+   * @return 0 on success.
+   */
+  iresult record_command_bundle(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    command_bundle& bundle,
+    const u32 image_index
+  ) noexcept;
+
+  // Free every recorded bundle command buffer. They are recorded again the next time each bundle is presented.
+  iresult invalidate_command_bundles(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+  iresult destroy_command_bundle(const context_impl& ctx, renderer_3d_impl& rnd, command_bundle& bundle) noexcept;
+
+  /**
+   * Start the render and present threads of a pipelined renderer.
+   *
+   * Once started the application thread records frames while the render thread submits them to the graphics queue
+   * and the present thread queues them for presentation. At most MAX_FRAMES_IN_FLIGHT frames are in the pipeline at
+   * once. The present thread acquires an image for every slot before handing it out so the swapchain *must not* be
+   * touched by any other thread until the pipeline is stopped.
+   *
+   * @param ctx A context prepared with a valid Vulkan device. This *must* outlive the pipeline.
+   * @param rnd A renderer with prepared synchronization objects.
+   *
+   * @return 0 on success. -1 if the swapchain has too few images to acquire one per slot without presenting. The
+   *         pipeline isn't started in that case.
+   */
+  iresult start_frame_pipeline(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Acquire a free frame slot for recording. This blocks until the present thread releases a slot.
+   *
+   * The slot's image has already been acquired by the present thread. rnd.acquired_image_index is -1U if the
+   * swapchain was out of date. The slot must then be returned with release_frame_slot() until rnd is rebuilt.
+   *
+   * @return 0 on success. Otherwise the first error reported by the render or present threads.
+   */
+  iresult acquire_frame_slot(renderer_3d_impl& rnd) noexcept;
+
+  // Return a slot without an image to the present thread's free list unused.
+  iresult release_frame_slot(renderer_3d_impl& rnd) noexcept;
+
+  // Hand the recorded frame to the render thread. If the pipeline has stopped the slot is returned unused.
+  iresult queue_frame(renderer_3d_impl& rnd, const VkCommandBuffer commands) noexcept;
+
+  // Block until every in flight frame has been presented.
+  iresult drain_frame_pipeline(renderer_3d_impl& rnd) noexcept;
+
+  iresult stop_frame_pipeline(renderer_3d_impl& rnd) noexcept;
 
   iresult destroy_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
   iresult destroy_vulkan_graphics_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
@@ -0,0 +1,209 @@
+#ifndef OBERON_DETAIL_RESOURCE_REGISTRY_HPP
+#define OBERON_DETAIL_RESOURCE_REGISTRY_HPP
+
+#include <cstddef>
+
+#include <vector>
+#include <span>
+#include <mutex>
+
+#include "../types.hpp"
+#include "../bounds.hpp"
+#include "../memory.hpp"
+#include "../resources.hpp"
+
+#include "vulkan.hpp"
+#include "slot_map.hpp"
+
+namespace oberon {
+namespace detail {
+
+  struct context_impl;
+
+  // Column indices of resource_registry::buffers.
+  enum buffer_column : usize {
+    BUFFER_COLUMN_HANDLE,
+    BUFFER_COLUMN_MEMORY,
+    BUFFER_COLUMN_SIZE,
+    BUFFER_COLUMN_USAGE,
+    BUFFER_COLUMN_MAPPED
+  };
+
+  // Column indices of resource_registry::images.
+  enum image_column : usize {
+    IMAGE_COLUMN_HANDLE,
+    IMAGE_COLUMN_VIEW,
+    IMAGE_COLUMN_MEMORY,
+    IMAGE_COLUMN_EXTENT,
+    IMAGE_COLUMN_FORMAT
+  };
+
+  // Column indices of resource_registry::pipelines.
+  enum pipeline_column : usize {
+    PIPELINE_COLUMN_HANDLE,
+    PIPELINE_COLUMN_LAYOUT,
+    PIPELINE_COLUMN_BIND_POINT
+  };
+
+  // Column indices of resource_registry::meshes.
+  enum mesh_column : usize {
+    MESH_COLUMN_VERTICES,
+    MESH_COLUMN_INDICES,
+    MESH_COLUMN_INDEX_COUNT,
+    MESH_COLUMN_VERTEX_OFFSET
+  };
+
+  // Vulkan objects removed from the registry that may still be referenced by frames in flight.
+  struct retired_resource final {
+    // The serial of the last frame that could have used the objects.
+    u64 frame_serial{ };
+    VkBuffer buffer{ };
+    VkImage image{ };
+    VkImageView image_view{ };
+    VkSampler sampler{ };
+    VkPipeline pipeline{ };
+    VkPipelineLayout pipeline_layout{ };
+    VkDeviceMemory memory{ };
+  };
+
+  struct resource_registry final {
+    // Guards every member. Handles may be created, destroyed, and resolved from any thread.
+    mutable std::mutex mutex{ };
+    // Host buffers are mapped for their entire lifetime. The mapping of device buffers is null.
+    slot_map<VkBuffer, VkDeviceMemory, VkDeviceSize, VkBufferUsageFlags, ptr<void>> buffers{ };
+    slot_map<VkImage, VkImageView, VkDeviceMemory, VkExtent3D, VkFormat> images{ };
+    slot_map<VkSampler> samplers{ };
+    slot_map<VkPipeline, VkPipelineLayout, VkPipelineBindPoint> pipelines{ };
+    slot_map<buffer_handle, buffer_handle, u32, i32> meshes{ };
+    std::vector<retired_resource> retired{ };
+    // Every frame recorded by the owning renderer receives a serial one greater than the previous frame.
+    u64 current_frame_serial{ };
+    // Every frame with a serial less than or equal to this has finished executing on the GPU.
+    u64 completed_frame_serial{ };
+  };
+
+  /**
+   * Create a buffer backed by a dedicated memory allocation and store it in reg. Host buffers are mapped until they're
+   * destroyed.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param reg The registry to store the buffer in.
+   * @param size The size of the buffer in bytes. This *must* be greater than 0.
+   * @param usage A combination of buffer_usage_bits.
+   * @param location Where the buffer memory should live.
+   * @param buffer A reference to store the handle of the new buffer into.
+   *
+   * @return 0 on success. -1 if no suitable memory type exists. Otherwise the corresponding VkResult.
+   */
+  iresult create_registry_buffer(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const usize size,
+    const u32 usage,
+    const memory_location location,
+    buffer_handle& buffer
+  ) noexcept;
+
+  /**
+   * Retrieve the mapped memory of a host buffer.
+   *
+   * @param reg The registry containing the buffer.
+   * @param buffer The buffer to retrieve the memory of.
+   * @param memory A reference to store the memory of the buffer into. The span remains valid until the buffer is
+   *               destroyed.
+   *
+   * @return 0 on success. -1 if the handle is stale or the buffer wasn't created in host memory.
+   */
+  iresult map_registry_buffer(
+    const resource_registry& reg,
+    const buffer_handle buffer,
+    std::span<std::byte>& memory
+  ) noexcept;
+
+  /**
+   * Create a 2D image and a view covering it backed by a dedicated device memory allocation and store it in reg.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param reg The registry to store the image in.
+   * @param extent The size of the image in texels. Both dimensions *must* be greater than 0.
+   * @param format The format of the image.
+   * @param usage A combination of image_usage_bits.
+   * @param image A reference to store the handle of the new image into.
+   *
+   * @return 0 on success. -1 if no suitable memory type exists. Otherwise the corresponding VkResult.
+   */
+  iresult create_registry_image(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const extent_2d& extent,
+    const image_format format,
+    const u32 usage,
+    image_handle& image
+  ) noexcept;
+
+  iresult create_registry_sampler(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const sampler_filter filter,
+    const sampler_address_mode address_mode,
+    sampler_handle& sampler
+  ) noexcept;
+
+  // Take ownership of a pipeline and its layout. They are destroyed with the registry or by destroy_registry_pipeline.
+  iresult register_pipeline(
+    resource_registry& reg,
+    const VkPipeline pipeline,
+    const VkPipelineLayout layout,
+    const VkPipelineBindPoint bind_point,
+    pipeline_handle& handle
+  ) noexcept;
+
+  /**
+   * Store a mesh made from existing buffers in reg. Meshes don't own their buffers.
+   *
+   * @return 0 on success. -1 if either buffer handle is stale or the index buffer wasn't created with
+   *         BUFFER_USAGE_INDEX_BIT.
+   */
+  iresult create_registry_mesh(
+    resource_registry& reg,
+    const buffer_handle vertices,
+    const buffer_handle indices,
+    const u32 index_count,
+    const i32 vertex_offset,
+    mesh_handle& mesh
+  ) noexcept;
+
+  // Remove a resource from reg. The underlying Vulkan objects are retired until the GPU finishes the current frame.
+  // Each returns -1 if the handle is stale.
+  iresult destroy_registry_buffer(resource_registry& reg, const buffer_handle buffer) noexcept;
+  iresult destroy_registry_image(resource_registry& reg, const image_handle image) noexcept;
+  iresult destroy_registry_sampler(resource_registry& reg, const sampler_handle sampler) noexcept;
+  iresult destroy_registry_pipeline(resource_registry& reg, const pipeline_handle pipeline) noexcept;
+  iresult destroy_registry_mesh(resource_registry& reg, const mesh_handle mesh) noexcept;
+
+  // Retire a pipeline the registry doesn't own. It's destroyed once the GPU finishes the current frame.
+  iresult retire_vulkan_pipeline(resource_registry& reg, const VkPipeline pipeline) noexcept;
+
+  /**
+   * Record that a new frame has started and destroy every retired resource the GPU has finished with.
+   *
+   * @param ctx A context prepared with a valid Vulkan device.
+   * @param reg The registry of the renderer starting the frame.
+   * @param completed_frame_serial The serial of a frame known to have finished executing. Frames execute in order
+   *                               so every earlier frame has also finished.
+   *
+   * @return The serial of the new frame.
+   */
+  u64 advance_registry_frame(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const u64 completed_frame_serial
+  ) noexcept;
+
+  // Destroy every resource in reg including retired resources. The device *must* be idle.
+  iresult destroy_resource_registry(const context_impl& ctx, resource_registry& reg) noexcept;
+
+}
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef OBERON_DETAIL_SHADER_HOT_RELOAD_HPP
+#define OBERON_DETAIL_SHADER_HOT_RELOAD_HPP
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <thread>
+
+#include "../types.hpp"
+#include "../memory.hpp"
+
+#include "vulkan.hpp"
+
+namespace oberon {
+namespace detail {
+
+  struct context_impl;
+  struct renderer_3d_impl;
+
+  // A pipeline rebuilt from a changed shader stage that hasn't replaced the pipeline in use yet. pipeline is
+  // VK_NULL_HANDLE if a later reload of another stage of the same pipeline superseded it.
+  struct reloaded_pipeline final {
+    usize pipeline_index{ };
+    usize stage_index{ };
+    VkShaderModule module{ };
+    VkPipeline pipeline{ };
+  };
+
+  struct shader_hot_reload final {
+    std::thread watcher{ };
+    int inotify_fd{ -1 };
+    // Signalled to stop the watcher.
+    int wake_fd{ -1 };
+    std::string directory{ };
+    // Guards pending. While the watcher runs it also guards renderer_3d_impl::graphics_pipeline_configs and the
+    // render pass the pipelines are built against.
+    std::mutex mutex{ };
+    std::vector<reloaded_pipeline> pending{ };
+  };
+
+  /**
+   * Start watching a directory for SPIR-V files named <shader>.<stage>.spv (e.g. test_frame.frag.spv).
+   *
+   * Whenever one is written every pipeline built from that shader is rebuilt on the watcher thread using the
+   * renderer's pipeline cache. The results are swapped in by apply_reloaded_pipelines().
+   *
+   * @param ctx A context prepared with a valid Vulkan device. This *must* outlive the watcher.
+   * @param rnd A renderer with prepared graphics pipelines that isn't already watching a directory.
+   * @param directory The directory to watch.
+   *
+   * @return 0 on success. -1 if the directory can't be watched.
+   */
+  iresult start_shader_hot_reload(const context_impl& ctx, renderer_3d_impl& rnd, const cstring directory) noexcept;
+
+  // Stop the watcher and destroy every pipeline that hasn't been swapped in yet.
+  iresult stop_shader_hot_reload(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  /**
+   * Replace pipelines with their reloaded versions. Must be called at a frame boundary after the frame's serial has
+   * been advanced. Replaced pipelines are retired rather than destroyed so frames in flight are unaffected.
+   *
+   * This never blocks. If the watcher is building a pipeline the swap is deferred to the next frame.
+   *
+   * @return 0 in all valid cases.
+   */
+  iresult apply_reloaded_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+  // Move the shader modules of every pending pipeline into the pipeline configurations and destroy the pending
+  // pipelines. Used when every pipeline is about to be rebuilt anyway. The caller *must* hold rnd.hot_reload.mutex
+  // and the device *must* be idle.
+  iresult merge_reloaded_shader_modules(const context_impl& ctx, renderer_3d_impl& rnd) noexcept;
+
+}
+}
+
+#endif
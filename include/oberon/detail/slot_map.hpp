@@ -0,0 +1,146 @@
+#ifndef OBERON_DETAIL_SLOT_MAP_HPP
+#define OBERON_DETAIL_SLOT_MAP_HPP
+
+#include <vector>
+#include <tuple>
+#include <utility>
+
+#include "../types.hpp"
+
+namespace oberon {
+namespace detail {
+
+  /**
+   * A dense structure-of-arrays container addressed by generational handles.
+   *
+   * Each element is stored as one entry in every column. Columns are kept packed so iterating any one of them touches
+   * only live values. Handles pack a 32 bit slot index with the 32 bit generation of the slot. Erasing an element
+   * bumps the generation of its slot so that stale handles fail validation instead of aliasing a newer element.
+   * Generation 0 is never issued so a zero handle is always invalid.
+   *
+   * Insertion, erasure, validation, and lookup are all O(1).
+   */
+  template <typename... Columns>
+  class slot_map final {
+  private:
+    static constexpr u32 NO_SLOT{ -1U };
+
+    struct slot final {
+      // The index of the element in the columns. For free slots this is the next free slot instead.
+      u32 index{ NO_SLOT };
+      u32 generation{ 1 };
+    };
+
+    std::vector<slot> m_slots{ };
+    // Maps column indices back to slots so that erasure can patch the slot of the element moved into the gap.
+    std::vector<u32> m_owners{ };
+    std::tuple<std::vector<Columns>...> m_columns{ };
+    u32 m_free_slots{ NO_SLOT };
+
+    static constexpr u32 slot_index(const u64 handle) noexcept {
+      return handle & 0xff'ff'ff'ff;
+    }
+
+    static constexpr u32 slot_generation(const u64 handle) noexcept {
+      return handle >> 32;
+    }
+
+    static constexpr u64 make_handle(const u32 index, const u32 generation) noexcept {
+      return (static_cast<u64>(generation) << 32) | index;
+    }
+
+    // Returns the column index of the element referred to by handle or NO_SLOT if the handle is stale.
+    u32 resolve(const u64 handle) const noexcept {
+      auto index = slot_index(handle);
+      if (index >= std::size(m_slots) || m_slots[index].generation != slot_generation(handle))
+      {
+        return NO_SLOT;
+      }
+      return m_slots[index].index;
+    }
+  public:
+    u64 insert(const Columns&... values) {
+      auto index = m_free_slots;
+      if (index == NO_SLOT)
+      {
+        index = std::size(m_slots);
+        m_slots.push_back({ });
+      }
+      else
+      {
+        m_free_slots = m_slots[index].index;
+      }
+      auto& current = m_slots[index];
+      current.index = std::size(m_owners);
+      m_owners.push_back(index);
+      std::apply([&](auto&... columns) { (columns.push_back(values), ...); }, m_columns);
+      return make_handle(index, current.generation);
+    }
+
+    // Remove the element referred to by handle. Returns false if the handle is stale.
+    bool erase(const u64 handle) noexcept {
+      auto position = resolve(handle);
+      if (position == NO_SLOT)
+      {
+        return false;
+      }
+      auto last = std::size(m_owners) - 1;
+      if (position != last)
+      {
+        std::apply([&](auto&... columns) { ((columns[position] = std::move(columns[last])), ...); }, m_columns);
+        m_owners[position] = m_owners[last];
+        m_slots[m_owners[position]].index = position;
+      }
+      std::apply([](auto&... columns) { (columns.pop_back(), ...); }, m_columns);
+      m_owners.pop_back();
+      auto& current = m_slots[slot_index(handle)];
+      // Never hand out generation 0 after wrapping around.
+      current.generation = current.generation + 1 ? current.generation + 1 : 1;
+      current.index = m_free_slots;
+      m_free_slots = slot_index(handle);
+      return true;
+    }
+
+    bool contains(const u64 handle) const noexcept {
+      return resolve(handle) != NO_SLOT;
+    }
+
+    // Returns a pointer to the value of handle in Column or nullptr if the handle is stale.
+    template <usize Column>
+    auto find(const u64 handle) noexcept {
+      auto position = resolve(handle);
+      auto& column = std::get<Column>(m_columns);
+      return position != NO_SLOT ? &column[position] : nullptr;
+    }
+
+    template <usize Column>
+    auto find(const u64 handle) const noexcept {
+      auto position = resolve(handle);
+      const auto& column = std::get<Column>(m_columns);
+      return position != NO_SLOT ? &column[position] : nullptr;
+    }
+
+    // Packed values of Column in no particular order. Invalidated by insert() and erase().
+    template <usize Column>
+    const auto& column() const noexcept {
+      return std::get<Column>(m_columns);
+    }
+
+    usize size() const noexcept {
+      return std::size(m_owners);
+    }
+
+    // Remove every element. Every outstanding handle becomes stale.
+    void clear() noexcept {
+      while (!std::empty(m_owners))
+      {
+        auto index = m_owners.back();
+        erase(make_handle(index, m_slots[index].generation));
+      }
+    }
+  };
+
+}
+}
+
+#endif
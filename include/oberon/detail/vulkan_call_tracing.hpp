@@ -0,0 +1,131 @@
+#ifndef OBERON_DETAIL_VULKAN_CALL_TRACING_HPP
+#define OBERON_DETAIL_VULKAN_CALL_TRACING_HPP
+
+#include <vector>
+
+#include "../types.hpp"
+#include "../context.hpp"
+
+#include "vulkan_function_table.hpp"
+
+// Device level entry points that are wrapped when call tracing is enabled.
+#define OBERON_TRACED_VULKAN_CALLS \
+  OBERON_TRACED_VULKAN_CALL(vkGetDeviceQueue) \
+  OBERON_TRACED_VULKAN_CALL(vkDeviceWaitIdle) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateImageView) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateRenderPass) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateFramebuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyFramebuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyRenderPass) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyImageView) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateShaderModule) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyShaderModule) \
+  OBERON_TRACED_VULKAN_CALL(vkCreatePipelineCache) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyPipelineCache) \
+  OBERON_TRACED_VULKAN_CALL(vkGetPipelineCacheData) \
+  OBERON_TRACED_VULKAN_CALL(vkMergePipelineCaches) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateDescriptorSetLayout) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyDescriptorSetLayout) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateDescriptorPool) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyDescriptorPool) \
+  OBERON_TRACED_VULKAN_CALL(vkResetDescriptorPool) \
+  OBERON_TRACED_VULKAN_CALL(vkAllocateDescriptorSets) \
+  OBERON_TRACED_VULKAN_CALL(vkUpdateDescriptorSets) \
+  OBERON_TRACED_VULKAN_CALL(vkCreatePipelineLayout) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyPipelineLayout) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateGraphicsPipelines) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateComputePipelines) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyPipeline) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateCommandPool) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyCommandPool) \
+  OBERON_TRACED_VULKAN_CALL(vkResetCommandPool) \
+  OBERON_TRACED_VULKAN_CALL(vkAllocateCommandBuffers) \
+  OBERON_TRACED_VULKAN_CALL(vkFreeCommandBuffers) \
+  OBERON_TRACED_VULKAN_CALL(vkBeginCommandBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkEndCommandBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkResetCommandBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdBeginRenderPass) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdEndRenderPass) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdBindPipeline) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdDraw) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdBindDescriptorSets) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdPushConstants) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdBindVertexBuffers) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdBindIndexBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdFillBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdPipelineBarrier) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdDispatch) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdDrawIndexedIndirectCount) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdSetViewport) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdSetScissor) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateSemaphore) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroySemaphore) \
+  OBERON_TRACED_VULKAN_CALL(vkQueueSubmit) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateFence) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyFence) \
+  OBERON_TRACED_VULKAN_CALL(vkWaitForFences) \
+  OBERON_TRACED_VULKAN_CALL(vkResetFences) \
+  OBERON_TRACED_VULKAN_CALL(vkAllocateMemory) \
+  OBERON_TRACED_VULKAN_CALL(vkFreeMemory) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyBuffer) \
+  OBERON_TRACED_VULKAN_CALL(vkGetBufferMemoryRequirements) \
+  OBERON_TRACED_VULKAN_CALL(vkBindBufferMemory) \
+  OBERON_TRACED_VULKAN_CALL(vkMapMemory) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateImage) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyImage) \
+  OBERON_TRACED_VULKAN_CALL(vkGetImageMemoryRequirements) \
+  OBERON_TRACED_VULKAN_CALL(vkBindImageMemory) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateSampler) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroySampler) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateQueryPool) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroyQueryPool) \
+  OBERON_TRACED_VULKAN_CALL(vkGetQueryPoolResults) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdResetQueryPool) \
+  OBERON_TRACED_VULKAN_CALL(vkCmdWriteTimestamp) \
+  OBERON_TRACED_VULKAN_CALL(vkCreateSwapchainKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkGetSwapchainImagesKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkDestroySwapchainKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkAcquireNextImageKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkQueuePresentKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkWaitForPresentKHR) \
+  OBERON_TRACED_VULKAN_CALL(vkGetCalibratedTimestampsEXT)
+
+#define OBERON_TRACED_VULKAN_CALL(name) \
+  name,
+
+namespace oberon {
+namespace detail {
+
+  enum class vulkan_call {
+    OBERON_TRACED_VULKAN_CALLS
+    max_value
+  };
+
+  constexpr usize VULKAN_CALL_COUNT{ static_cast<usize>(vulkan_call::max_value) };
+
+  cstring vulkan_call_name(const vulkan_call call) noexcept;
+
+  /**
+   * Replace the device level function pointers in vkft with thunks that count calls and accumulate wall time.
+   *
+   * The thunks forward to the original pointers which are stored globally. Only one function table can be traced at
+   * a time. Tables that aren't traced are left untouched and pay no cost.
+   *
+   * @param vkft A vulkan_function_table with loaded device level function pointers.
+   *
+   * @return 0 on success. -1 if another function table is already being traced.
+   */
+  iresult install_vulkan_call_tracing(vulkan_function_table& vkft) noexcept;
+
+  // Release tracing so that another function table can be traced. The statistics are reset.
+  iresult uninstall_vulkan_call_tracing() noexcept;
+  iresult read_vulkan_call_statistics(std::vector<vulkan_call_statistics>& statistics) noexcept;
+  iresult reset_vulkan_call_statistics() noexcept;
+
+}
+}
+
+#undef OBERON_TRACED_VULKAN_CALL
+
+#endif
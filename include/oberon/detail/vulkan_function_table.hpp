@@ -27,13 +27,20 @@ namespace detail {
     PFN_vkEnumerateDeviceExtensionProperties vkEnumerateDeviceExtensionProperties{ };
     PFN_vkGetPhysicalDeviceProperties vkGetPhysicalDeviceProperties{ };
     PFN_vkGetPhysicalDeviceFeatures vkGetPhysicalDeviceFeatures{ };
+    PFN_vkGetPhysicalDeviceFeatures2 vkGetPhysicalDeviceFeatures2{ };
     PFN_vkGetPhysicalDeviceQueueFamilyProperties vkGetPhysicalDeviceQueueFamilyProperties{ };
+    PFN_vkGetPhysicalDeviceMemoryProperties vkGetPhysicalDeviceMemoryProperties{ };
     PFN_vkCreateDevice vkCreateDevice{ };
     PFN_vkDestroyInstance vkDestroyInstance{ };
+    // VK_EXT_calibrated_timestamps
+    PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT vkGetPhysicalDeviceCalibrateableTimeDomainsEXT{ };
     // VK_EXT_debug_utils
     PFN_vkCreateDebugUtilsMessengerEXT vkCreateDebugUtilsMessengerEXT{ };
     PFN_vkSubmitDebugUtilsMessageEXT vkSubmitDebugUtilsMessageEXT{ };
     PFN_vkDestroyDebugUtilsMessengerEXT vkDestroyDebugUtilsMessengerEXT{ };
+    PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectNameEXT{ };
+    PFN_vkCmdBeginDebugUtilsLabelEXT vkCmdBeginDebugUtilsLabelEXT{ };
+    PFN_vkCmdEndDebugUtilsLabelEXT vkCmdEndDebugUtilsLabelEXT{ };
     // VK_KHR_xcb_surface
     PFN_vkGetPhysicalDeviceXcbPresentationSupportKHR vkGetPhysicalDeviceXcbPresentationSupportKHR{ };
     PFN_vkCreateXcbSurfaceKHR vkCreateXcbSurfaceKHR{ };
@@ -60,9 +67,17 @@ namespace detail {
     PFN_vkDestroyPipelineCache vkDestroyPipelineCache{ };
     PFN_vkGetPipelineCacheData vkGetPipelineCacheData{ };
     PFN_vkMergePipelineCaches vkMergePipelineCaches{ };
+    PFN_vkCreateDescriptorSetLayout vkCreateDescriptorSetLayout{ };
+    PFN_vkDestroyDescriptorSetLayout vkDestroyDescriptorSetLayout{ };
+    PFN_vkCreateDescriptorPool vkCreateDescriptorPool{ };
+    PFN_vkDestroyDescriptorPool vkDestroyDescriptorPool{ };
+    PFN_vkResetDescriptorPool vkResetDescriptorPool{ };
+    PFN_vkAllocateDescriptorSets vkAllocateDescriptorSets{ };
+    PFN_vkUpdateDescriptorSets vkUpdateDescriptorSets{ };
     PFN_vkCreatePipelineLayout vkCreatePipelineLayout{ };
     PFN_vkDestroyPipelineLayout vkDestroyPipelineLayout{ };
     PFN_vkCreateGraphicsPipelines vkCreateGraphicsPipelines{ };
+    PFN_vkCreateComputePipelines vkCreateComputePipelines{ };
     PFN_vkDestroyPipeline vkDestroyPipeline{ };
     PFN_vkCreateCommandPool vkCreateCommandPool{ };
     PFN_vkDestroyCommandPool vkDestroyCommandPool{ };
@@ -75,6 +90,16 @@ namespace detail {
     PFN_vkCmdEndRenderPass vkCmdEndRenderPass{ };
     PFN_vkCmdBindPipeline vkCmdBindPipeline{ };
     PFN_vkCmdDraw vkCmdDraw{ };
+    PFN_vkCmdBindDescriptorSets vkCmdBindDescriptorSets{ };
+    PFN_vkCmdPushConstants vkCmdPushConstants{ };
+    PFN_vkCmdBindVertexBuffers vkCmdBindVertexBuffers{ };
+    PFN_vkCmdBindIndexBuffer vkCmdBindIndexBuffer{ };
+    PFN_vkCmdFillBuffer vkCmdFillBuffer{ };
+    PFN_vkCmdPipelineBarrier vkCmdPipelineBarrier{ };
+    PFN_vkCmdDispatch vkCmdDispatch{ };
+    PFN_vkCmdDrawIndexedIndirectCount vkCmdDrawIndexedIndirectCount{ };
+    PFN_vkCmdSetViewport vkCmdSetViewport{ };
+    PFN_vkCmdSetScissor vkCmdSetScissor{ };
     PFN_vkCreateSemaphore vkCreateSemaphore{ };
     PFN_vkDestroySemaphore vkDestroySemaphore{ };
     PFN_vkQueueSubmit vkQueueSubmit{ };
@@ -83,12 +108,34 @@ namespace detail {
     PFN_vkWaitForFences vkWaitForFences{ };
     PFN_vkResetFences vkResetFences{ };
     PFN_vkResetCommandBuffer vkResetCommandBuffer{ };
+    PFN_vkAllocateMemory vkAllocateMemory{ };
+    PFN_vkFreeMemory vkFreeMemory{ };
+    PFN_vkCreateBuffer vkCreateBuffer{ };
+    PFN_vkDestroyBuffer vkDestroyBuffer{ };
+    PFN_vkGetBufferMemoryRequirements vkGetBufferMemoryRequirements{ };
+    PFN_vkBindBufferMemory vkBindBufferMemory{ };
+    PFN_vkMapMemory vkMapMemory{ };
+    PFN_vkCreateImage vkCreateImage{ };
+    PFN_vkDestroyImage vkDestroyImage{ };
+    PFN_vkGetImageMemoryRequirements vkGetImageMemoryRequirements{ };
+    PFN_vkBindImageMemory vkBindImageMemory{ };
+    PFN_vkCreateSampler vkCreateSampler{ };
+    PFN_vkDestroySampler vkDestroySampler{ };
+    PFN_vkCreateQueryPool vkCreateQueryPool{ };
+    PFN_vkDestroyQueryPool vkDestroyQueryPool{ };
+    PFN_vkGetQueryPoolResults vkGetQueryPoolResults{ };
+    PFN_vkCmdResetQueryPool vkCmdResetQueryPool{ };
+    PFN_vkCmdWriteTimestamp vkCmdWriteTimestamp{ };
     // VK_KHR_swapchain
     PFN_vkCreateSwapchainKHR vkCreateSwapchainKHR{ };
     PFN_vkGetSwapchainImagesKHR vkGetSwapchainImagesKHR{ };
     PFN_vkDestroySwapchainKHR vkDestroySwapchainKHR{ };
     PFN_vkAcquireNextImageKHR vkAcquireNextImageKHR{ };
     PFN_vkQueuePresentKHR vkQueuePresentKHR{ };
+    // VK_KHR_present_wait
+    PFN_vkWaitForPresentKHR vkWaitForPresentKHR{ };
+    // VK_EXT_calibrated_timestamps
+    PFN_vkGetCalibratedTimestampsEXT vkGetCalibratedTimestampsEXT{ };
   };
 
   /**
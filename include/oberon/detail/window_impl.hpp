@@ -27,24 +27,70 @@ namespace detail {
 
   struct window_impl : public object_impl {
     bool is_hidden{ true };
+    // Set when the X server reports that every pixel of the window is covered. Compositing window managers redirect
+    // windows offscreen and so normally never report this.
+    bool is_obscured{ };
+    // Incremented whenever the window contents are lost. Renderers compare this against the generation that they last
+    // drew to decide whether an unchanged frame can be skipped.
+    u64 content_generation{ };
 
     xcb_window_t x11_window{ };
     xcb_atom_t x11_wm_protocols_atom{ };
     xcb_atom_t x11_delete_atom{ };
 
     bounding_rect bounds{ };
+    // The monitor that the window is mostly on.
+    xcb_randr_crtc_t x11_crtc{ };
+    f64 refresh_rate{ };
 
     VkSurfaceKHR surface{ };
 
     virtual ~window_impl() noexcept = default;
   };
 
+  /**
+   * Create a window covering the primary monitor and request that the window manager make it fullscreen.
+   *
+   * The monitor is selected from the monitor cache in ctx. No round trips to the X11 server are made.
+   *
+   * @param ctx A context with prepared X11 atom and monitor caches.
+   * @param window The window to create.
+   * @param bounds A reference to store the bounds of the selected monitor in.
+   *
+   * @return 0 in all valid cases.
+   */
   iresult create_fullscreen_x11_window(const context_impl& ctx, window_impl& window, bounding_rect& bounds) noexcept;
-  iresult create_x11_window(const context_impl& ctx, window_impl& window) noexcept;
+  iresult create_x11_window(const context_impl& ctx, window_impl& window, const bounding_rect& bounds) noexcept;
   iresult create_vulkan_surface(const context_impl& ctx, window_impl& window) noexcept;
   iresult display_x11_window(const context_impl& ctx, window_impl& window) noexcept;
+
+  /**
+   * Select the cached monitor containing the center of the window and store its refresh rate in window.
+   *
+   * Window positions are reported relative to the parent window. Under reparenting window managers this is only an
+   * approximation of the position on the root window.
+   *
+   * @param ctx A context with a prepared monitor cache.
+   * @param window The window to update.
+   *
+   * @return 0 if a monitor was found. -1 if the window isn't on any cached monitor.
+   */
+  iresult update_x11_window_monitor(const context_impl& ctx, window_impl& window) noexcept;
   iresult handle_x11_configure(window_impl& window, const ptr<xcb_configure_notify_event_t> ev) noexcept;
   iresult handle_x11_message(window_impl& window, const ptr<xcb_client_message_event_t> ev) noexcept;
+
+  /**
+   * Update the visibility of a window in response to a MapNotify, UnmapNotify, or VisibilityNotify event.
+   *
+   * Window managers unmap windows when they are minimized so this also tracks iconification.
+   *
+   * @param window The window that the event was reported for.
+   * @param ev The event.
+   *
+   * @return 1 if the window is now visible. 0 if the window is now invisible. -1 if ev isn't a visibility event.
+   */
+  iresult handle_x11_visibility(window_impl& window, const ptr<xcb_generic_event_t> ev) noexcept;
+  bool is_window_visible(const window_impl& window) noexcept;
   iresult hide_x11_window(const context_impl& ctx, window_impl& window) noexcept;
   iresult destroy_vulkan_surface(const context_impl& ctx, window_impl& window) noexcept;
   iresult destroy_x11_window(const context_impl& ctx, window_impl& window) noexcept;
@@ -0,0 +1,103 @@
+#ifndef OBERON_DETAIL_WORKER_POOL_HPP
+#define OBERON_DETAIL_WORKER_POOL_HPP
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "../types.hpp"
+#include "../memory.hpp"
+
+namespace oberon {
+namespace detail {
+
+  /**
+   * A fixed set of threads that execute data parallel loops.
+   *
+   * Loops are split into chunks that workers claim from a shared counter so that uneven chunks balance themselves.
+   * The calling thread claims chunks as well and only returns once every chunk has finished. Loops submitted from
+   * different threads run one at a time. Loops started from inside a chunk of another loop run their chunks in order
+   * on the calling thread since waiting for the pool there would deadlock.
+   */
+  class worker_pool final {
+  private:
+    struct job final {
+      void (*invoke)(const ptr<void> function, const usize begin, const usize end){ };
+      ptr<void> function{ };
+      usize count{ };
+      usize chunk_size{ };
+      std::atomic<usize> next_chunk{ };
+    };
+
+    std::vector<std::thread> m_workers{ };
+    // Serializes parallel_for() calls.
+    std::mutex m_submit_mutex{ };
+    // Guards every member below.
+    std::mutex m_mutex{ };
+    std::condition_variable m_job_ready{ };
+    std::condition_variable m_job_finished{ };
+    ptr<job> m_job{ };
+    u64 m_job_generation{ };
+    usize m_busy_workers{ };
+    bool m_is_stopping{ };
+
+    // Whether the calling thread is executing a chunk of any pool.
+    static bool is_running_chunk() noexcept;
+    static void run_chunks(job& current) noexcept;
+    void run_worker() noexcept;
+    void run(job& current);
+  public:
+    // Start worker_count threads. A pool with no workers runs every loop on the calling thread.
+    explicit worker_pool(const usize worker_count);
+    worker_pool(const worker_pool& other) = delete;
+    worker_pool(worker_pool&& other) = delete;
+
+    ~worker_pool() noexcept;
+
+    worker_pool& operator=(const worker_pool& other) = delete;
+    worker_pool& operator=(worker_pool&& other) = delete;
+
+    usize worker_count() const noexcept;
+
+    /**
+     * Call function(begin, end) for consecutive ranges of at most chunk_size indices covering [0, count).
+     *
+     * Chunks may run concurrently and in any order. Loops with a single chunk run on the calling thread without waking
+     * any workers.
+     *
+     * @param count The number of indices.
+     * @param chunk_size The maximum number of indices passed to a single call. Must be greater than 0.
+     * @param function A callable accepting (usize begin, usize end). It must not throw.
+     */
+    template <typename Function>
+    void parallel_for(const usize count, const usize chunk_size, Function&& function) {
+      if (count <= chunk_size || std::empty(m_workers) || is_running_chunk())
+      {
+        for (auto begin = usize{ 0 }; begin < count; begin += chunk_size)
+        {
+          function(begin, std::min(begin + chunk_size, count));
+        }
+        return;
+      }
+      auto current = job{ };
+      current.invoke = [](const ptr<void> fn, const usize begin, const usize end) {
+        (*static_cast<ptr<std::remove_reference_t<Function>>>(fn))(begin, end);
+      };
+      current.function = const_cast<ptr<void>>(static_cast<readonly_ptr<void>>(&function));
+      current.count = count;
+      current.chunk_size = chunk_size;
+      run(current);
+    }
+  };
+
+  // A process wide pool with one worker per hardware thread other than the caller's. Started on first use.
+  worker_pool& default_worker_pool();
+
+}
+}
+
+#endif
@@ -1,15 +1,62 @@
 #ifndef OBERON_DETAIL_X11_HPP
 #define OBERON_DETAIL_X11_HPP
 
+#include <array>
+
 #include <xcb/xcb.h>
 #include <xcb/randr.h>
 
+#include "../types.hpp"
+#include "../memory.hpp"
+#include "../bounds.hpp"
+
+// Every X11 atom the library needs. These are interned once when a context is created.
+#define OBERON_X11_ATOMS \
+  OBERON_X11_ATOM(WM_PROTOCOLS) \
+  OBERON_X11_ATOM(WM_DELETE_WINDOW) \
+  OBERON_X11_ATOM(_NET_WM_STATE) \
+  OBERON_X11_ATOM(_NET_WM_STATE_FULLSCREEN) \
+  OBERON_X11_ATOM(_NET_WM_BYPASS_COMPOSITOR)
+
+#define OBERON_X11_ATOM(name) \
+  name,
+
 namespace oberon {
 namespace detail {
 
+  enum class x11_atom {
+    OBERON_X11_ATOMS
+    max_value
+  };
+
+  constexpr usize X11_ATOM_COUNT{ static_cast<usize>(x11_atom::max_value) };
+
+  // A cached description of an active RandR output.
+  struct x11_monitor final {
+    xcb_randr_output_t output{ };
+    xcb_randr_crtc_t crtc{ };
+    xcb_randr_mode_t mode{ };
+    // The vertical refresh rate of the current mode in Hz. 0 if it couldn't be determined.
+    f64 refresh_rate{ };
+    bounding_rect bounds{ };
+  };
+
   xcb_screen_t* screen_of_display(xcb_connection_t *const connection, int screen);
 
+  cstring x11_atom_name(const x11_atom atom) noexcept;
+
+  /**
+   * Compute the vertical refresh rate of a RandR mode.
+   *
+   * @param mode The mode to compute the refresh rate of.
+   *
+   * @return The refresh rate in Hz. 0 if the mode timings are empty.
+   */
+  f64 x11_mode_refresh_rate(const xcb_randr_mode_info_t& mode) noexcept;
+
 }
 }
 
+#undef OBERON_X11_ATOM
+
 #endif
@@ -24,12 +24,17 @@ namespace events {
   struct window_hide_data final {
   };
 
+  struct window_visibility_data final {
+    bool is_visible{ false };
+  };
+
 }
 
   enum class event_type {
     empty,
     window_hide,
-    window_configure
+    window_configure,
+    window_visibility
   };
 
   struct event final {
@@ -39,6 +44,7 @@ namespace events {
       events::empty_data empty;
       events::window_hide_data window_hide;
       events::window_configure_data window_configure;
+      events::window_visibility_data window_visibility;
     } data;
   };
 
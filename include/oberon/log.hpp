@@ -0,0 +1,72 @@
+#ifndef OBERON_LOG_HPP
+#define OBERON_LOG_HPP
+
+#include "types.hpp"
+#include "memory.hpp"
+
+// Messages less severe than this are removed at compile time. Defaults to debug in debug builds and info otherwise.
+#if !defined(OBERON_LOG_MIN_SEVERITY)
+  #if !defined(NDEBUG)
+    #define OBERON_LOG_MIN_SEVERITY 1
+  #else
+    #define OBERON_LOG_MIN_SEVERITY 2
+  #endif
+#endif
+
+// Log a printf style message. severity is the name of a log_severity enumerator (e.g. OBERON_LOG(warning, ...)).
+// The arguments aren't evaluated unless the message passes both the compile time and runtime severity filters.
+#define OBERON_LOG(severity, format, ...) \
+  do { \
+    if constexpr (static_cast<int>(oberon::log_severity::severity) >= OBERON_LOG_MIN_SEVERITY) \
+    { \
+      if (oberon::is_log_enabled(oberon::log_severity::severity)) \
+      { \
+        oberon::log_message(oberon::log_severity::severity, (format) __VA_OPT__(,) __VA_ARGS__); \
+      } \
+    } \
+  } while (0)
+
+namespace oberon {
+
+  enum class log_severity {
+    trace,
+    debug,
+    info,
+    warning,
+    error,
+    fatal
+  };
+
+  enum log_sink_bits : u32 {
+    LOG_SINK_NONE_BIT = 0,
+    LOG_SINK_STDERR_BIT = 0x01,
+    // Requires a file opened with open_log_file().
+    LOG_SINK_FILE_BIT = 0x02,
+    LOG_SINK_SYSLOG_BIT = 0x04
+  };
+
+  // Messages are formatted on the calling thread into a fixed size lock free ring and written to the enabled sinks by
+  // a background thread. Logging never blocks. If the ring is full the message is dropped and counted instead.
+
+  bool is_log_enabled(const log_severity severity) noexcept;
+  void set_log_severity(const log_severity severity) noexcept;
+  log_severity current_log_severity() noexcept;
+
+  // Select sinks with a combination of log_sink_bits. Defaults to LOG_SINK_STDERR_BIT.
+  void set_log_sinks(const u32 sinks) noexcept;
+  u32 current_log_sinks() noexcept;
+  // Open (or replace) the file used by LOG_SINK_FILE_BIT. Messages are appended. Returns false if the file can't be
+  // opened.
+  bool open_log_file(const cstring path) noexcept;
+  void close_log_file() noexcept;
+
+  // Queue a message. This doesn't check the severity filter. Prefer OBERON_LOG.
+  void log_message(const log_severity severity, const cstring format, ...) noexcept;
+  // Block until every message queued before the call has been written to the sinks.
+  void flush_log() noexcept;
+  // The number of messages dropped because the ring was full.
+  u64 dropped_log_messages() noexcept;
+
+}
+
+#endif
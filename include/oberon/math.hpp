@@ -0,0 +1,332 @@
+#ifndef OBERON_MATH_HPP
+#define OBERON_MATH_HPP
+
+#include <cmath>
+
+#include <array>
+#include <span>
+
+#include "types.hpp"
+
+namespace oberon {
+
+  // Matrices are column major and vectors are column vectors to match GLSL. Clip space follows Vulkan (y down, depth
+  // in [0, 1]).
+
+  constexpr f32 PI{ 3.14159265358979323846f };
+
+  struct vec2 final {
+    f32 x{ };
+    f32 y{ };
+  };
+
+  struct vec3 final {
+    f32 x{ };
+    f32 y{ };
+    f32 z{ };
+  };
+
+  struct alignas(16) vec4 final {
+    f32 x{ };
+    f32 y{ };
+    f32 z{ };
+    f32 w{ };
+  };
+
+  struct mat3 final {
+    std::array<vec3, 3> columns{ };
+  };
+
+  struct alignas(16) mat4 final {
+    std::array<vec4, 4> columns{ };
+  };
+
+  // A rotation. w is the scalar part.
+  struct alignas(16) quat final {
+    f32 x{ };
+    f32 y{ };
+    f32 z{ };
+    f32 w{ 1.0f };
+  };
+
+  constexpr vec2 operator+(const vec2& lhs, const vec2& rhs) noexcept {
+    return { lhs.x + rhs.x, lhs.y + rhs.y };
+  }
+
+  constexpr vec2 operator-(const vec2& lhs, const vec2& rhs) noexcept {
+    return { lhs.x - rhs.x, lhs.y - rhs.y };
+  }
+
+  constexpr vec2 operator*(const vec2& lhs, const vec2& rhs) noexcept {
+    return { lhs.x * rhs.x, lhs.y * rhs.y };
+  }
+
+  constexpr vec2 operator*(const vec2& lhs, const f32 rhs) noexcept {
+    return { lhs.x * rhs, lhs.y * rhs };
+  }
+
+  constexpr vec2 operator-(const vec2& v) noexcept {
+    return { -v.x, -v.y };
+  }
+
+  constexpr f32 dot(const vec2& lhs, const vec2& rhs) noexcept {
+    return lhs.x * rhs.x + lhs.y * rhs.y;
+  }
+
+  constexpr vec3 operator+(const vec3& lhs, const vec3& rhs) noexcept {
+    return { lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z };
+  }
+
+  constexpr vec3 operator-(const vec3& lhs, const vec3& rhs) noexcept {
+    return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z };
+  }
+
+  constexpr vec3 operator*(const vec3& lhs, const vec3& rhs) noexcept {
+    return { lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z };
+  }
+
+  constexpr vec3 operator*(const vec3& lhs, const f32 rhs) noexcept {
+    return { lhs.x * rhs, lhs.y * rhs, lhs.z * rhs };
+  }
+
+  constexpr vec3 operator-(const vec3& v) noexcept {
+    return { -v.x, -v.y, -v.z };
+  }
+
+  constexpr f32 dot(const vec3& lhs, const vec3& rhs) noexcept {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
+  }
+
+  constexpr vec3 cross(const vec3& lhs, const vec3& rhs) noexcept {
+    return { lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x };
+  }
+
+  constexpr vec4 operator+(const vec4& lhs, const vec4& rhs) noexcept {
+    return { lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w };
+  }
+
+  constexpr vec4 operator-(const vec4& lhs, const vec4& rhs) noexcept {
+    return { lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w };
+  }
+
+  constexpr vec4 operator*(const vec4& lhs, const vec4& rhs) noexcept {
+    return { lhs.x * rhs.x, lhs.y * rhs.y, lhs.z * rhs.z, lhs.w * rhs.w };
+  }
+
+  constexpr vec4 operator*(const vec4& lhs, const f32 rhs) noexcept {
+    return { lhs.x * rhs, lhs.y * rhs, lhs.z * rhs, lhs.w * rhs };
+  }
+
+  constexpr vec4 operator-(const vec4& v) noexcept {
+    return { -v.x, -v.y, -v.z, -v.w };
+  }
+
+  constexpr f32 dot(const vec4& lhs, const vec4& rhs) noexcept {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+  }
+
+  inline f32 length(const vec2& v) noexcept {
+    return std::sqrt(dot(v, v));
+  }
+
+  inline f32 length(const vec3& v) noexcept {
+    return std::sqrt(dot(v, v));
+  }
+
+  inline f32 length(const vec4& v) noexcept {
+    return std::sqrt(dot(v, v));
+  }
+
+  // The result is undefined for zero length vectors.
+  inline vec2 normalize(const vec2& v) noexcept {
+    return v * (1.0f / length(v));
+  }
+
+  inline vec3 normalize(const vec3& v) noexcept {
+    return v * (1.0f / length(v));
+  }
+
+  inline vec4 normalize(const vec4& v) noexcept {
+    return v * (1.0f / length(v));
+  }
+
+  constexpr mat3 identity_mat3() noexcept {
+    return { { { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f } } } };
+  }
+
+  constexpr vec3 operator*(const mat3& lhs, const vec3& rhs) noexcept {
+    return lhs.columns[0] * rhs.x + lhs.columns[1] * rhs.y + lhs.columns[2] * rhs.z;
+  }
+
+  constexpr mat3 operator*(const mat3& lhs, const mat3& rhs) noexcept {
+    return { { { lhs * rhs.columns[0], lhs * rhs.columns[1], lhs * rhs.columns[2] } } };
+  }
+
+  constexpr mat3 transpose(const mat3& m) noexcept {
+    const auto& [c0, c1, c2] = m.columns;
+    return { { { { c0.x, c1.x, c2.x }, { c0.y, c1.y, c2.y }, { c0.z, c1.z, c2.z } } } };
+  }
+
+  constexpr mat4 identity_mat4() noexcept {
+    return { { { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f },
+                 { 0.0f, 0.0f, 0.0f, 1.0f } } } };
+  }
+
+  constexpr vec4 operator*(const mat4& lhs, const vec4& rhs) noexcept {
+    return lhs.columns[0] * rhs.x + lhs.columns[1] * rhs.y + lhs.columns[2] * rhs.z + lhs.columns[3] * rhs.w;
+  }
+
+  constexpr mat4 operator*(const mat4& lhs, const mat4& rhs) noexcept {
+    return { { { lhs * rhs.columns[0], lhs * rhs.columns[1], lhs * rhs.columns[2], lhs * rhs.columns[3] } } };
+  }
+
+  constexpr mat4 transpose(const mat4& m) noexcept {
+    const auto& [c0, c1, c2, c3] = m.columns;
+    return { { { { c0.x, c1.x, c2.x, c3.x }, { c0.y, c1.y, c2.y, c3.y }, { c0.z, c1.z, c2.z, c3.z },
+                 { c0.w, c1.w, c2.w, c3.w } } } };
+  }
+
+  // Transform a point (w = 1) by an affine matrix.
+  constexpr vec3 transform_point(const mat4& m, const vec3& p) noexcept {
+    auto result = m * vec4{ p.x, p.y, p.z, 1.0f };
+    return { result.x, result.y, result.z };
+  }
+
+  // Transform a direction (w = 0).
+  constexpr vec3 transform_direction(const mat4& m, const vec3& d) noexcept {
+    auto result = m * vec4{ d.x, d.y, d.z, 0.0f };
+    return { result.x, result.y, result.z };
+  }
+
+  // The upper left 3x3 of m.
+  constexpr mat3 to_mat3(const mat4& m) noexcept {
+    const auto& [c0, c1, c2, c3] = m.columns;
+    return { { { { c0.x, c0.y, c0.z }, { c1.x, c1.y, c1.z }, { c2.x, c2.y, c2.z } } } };
+  }
+
+  constexpr mat4 translation(const vec3& t) noexcept {
+    auto result = identity_mat4();
+    result.columns[3] = { t.x, t.y, t.z, 1.0f };
+    return result;
+  }
+
+  constexpr mat4 scaling(const vec3& s) noexcept {
+    return { { { { s.x, 0.0f, 0.0f, 0.0f }, { 0.0f, s.y, 0.0f, 0.0f }, { 0.0f, 0.0f, s.z, 0.0f },
+                 { 0.0f, 0.0f, 0.0f, 1.0f } } } };
+  }
+
+  // The inverse of m. The result is undefined if m is singular.
+  mat4 inverse(const mat4& m) noexcept;
+
+  // A right handed view matrix looking down -z.
+  mat4 look_at(const vec3& eye, const vec3& target, const vec3& up) noexcept;
+
+  // A right handed perspective projection onto Vulkan clip space. fov_y is in radians.
+  mat4 perspective(const f32 fov_y, const f32 aspect, const f32 near_plane, const f32 far_plane) noexcept;
+
+  constexpr quat operator*(const quat& lhs, const quat& rhs) noexcept {
+    return {
+      lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+      lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+      lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+      lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z
+    };
+  }
+
+  constexpr quat conjugate(const quat& q) noexcept {
+    return { -q.x, -q.y, -q.z, q.w };
+  }
+
+  constexpr f32 dot(const quat& lhs, const quat& rhs) noexcept {
+    return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+  }
+
+  inline quat normalize(const quat& q) noexcept {
+    auto scale = 1.0f / std::sqrt(dot(q, q));
+    return { q.x * scale, q.y * scale, q.z * scale, q.w * scale };
+  }
+
+  // axis *must* be normalized. angle is in radians.
+  inline quat axis_angle(const vec3& axis, const f32 angle) noexcept {
+    auto s = std::sin(angle * 0.5f);
+    return { axis.x * s, axis.y * s, axis.z * s, std::cos(angle * 0.5f) };
+  }
+
+  // Rotate v by a unit quaternion.
+  constexpr vec3 rotate(const quat& q, const vec3& v) noexcept {
+    auto u = vec3{ q.x, q.y, q.z };
+    auto t = cross(u, v) * 2.0f;
+    return v + t * q.w + cross(u, t);
+  }
+
+  // Normalized linear interpolation. Cheaper than slerp and accurate enough for small angles.
+  quat nlerp(const quat& from, const quat& to, const f32 t) noexcept;
+
+  // Spherical linear interpolation along the shortest arc.
+  quat slerp(const quat& from, const quat& to, const f32 t) noexcept;
+
+  // The rotation matrix of a unit quaternion.
+  constexpr mat3 rotation_mat3(const quat& q) noexcept {
+    auto xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    auto xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    auto wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    return { { {
+      { 1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy) },
+      { 2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx) },
+      { 2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy) }
+    } } };
+  }
+
+  constexpr mat4 rotation(const quat& q) noexcept {
+    auto r = rotation_mat3(q);
+    return { { {
+      { r.columns[0].x, r.columns[0].y, r.columns[0].z, 0.0f },
+      { r.columns[1].x, r.columns[1].y, r.columns[1].z, 0.0f },
+      { r.columns[2].x, r.columns[2].y, r.columns[2].z, 0.0f },
+      { 0.0f, 0.0f, 0.0f, 1.0f }
+    } } };
+  }
+
+  // Equivalent to translation(t) * rotation(r) * scaling(s) without the matrix products.
+  constexpr mat4 compose_transform(const vec3& t, const quat& r, const vec3& s) noexcept {
+    auto m = rotation_mat3(r);
+    return { { {
+      { m.columns[0].x * s.x, m.columns[0].y * s.x, m.columns[0].z * s.x, 0.0f },
+      { m.columns[1].x * s.y, m.columns[1].y * s.y, m.columns[1].z * s.y, 0.0f },
+      { m.columns[2].x * s.z, m.columns[2].y * s.z, m.columns[2].z * s.z, 0.0f },
+      { t.x, t.y, t.z, 1.0f }
+    } } };
+  }
+
+  // Batch kernels. Each one has a scalar, SSE4.1 and AVX2 implementation. The widest one the CPU supports is selected
+  // the first time any kernel is called. Inputs and outputs may alias only if they are identical.
+
+  enum class simd_level {
+    scalar,
+    sse4,
+    avx2
+  };
+
+  // The widest instruction set that both the CPU and the build support.
+  simd_level max_simd_level() noexcept;
+  // The instruction set the batch kernels currently use.
+  simd_level current_simd_level() noexcept;
+  // Use the kernels of a narrower instruction set. Levels wider than max_simd_level() are clamped. This isn't
+  // synchronized with kernels running on other threads. Intended for benchmarks and testing.
+  void set_simd_level(const simd_level level) noexcept;
+
+  // out[i] = lhs[i] * rhs[i]. Every span *must* have the same size.
+  void multiply_mat4(const std::span<const mat4> lhs, const std::span<const mat4> rhs,
+                     const std::span<mat4> out) noexcept;
+
+  // out[i] = m * in[i]. in and out *must* have the same size.
+  void transform_vec4(const mat4& m, const std::span<const vec4> in, const std::span<vec4> out) noexcept;
+
+  // Transform points stored as separate x, y and z arrays by an affine matrix. Every span *must* have the same size.
+  void transform_points(const mat4& m, const std::span<const f32> x, const std::span<const f32> y,
+                        const std::span<const f32> z, const std::span<f32> out_x, const std::span<f32> out_y,
+                        const std::span<f32> out_z) noexcept;
+
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define OBERON_MEMORY_HPP
 
 #include <memory>
+#include <memory_resource>
+#include <vector>
 
 #include "types.hpp"
 
@@ -19,6 +21,75 @@ namespace oberon {
   using cstring = basic_cstring<char>;
   using wcstring = basic_cstring<wchar>;
 
+  // A vector allocating from a memory resource such as a linear_arena.
+  template <typename Type>
+  using arena_vector = std::pmr::vector<Type>;
+
+  // A bump allocator. Deallocation is a no-op and all memory is reclaimed at once by reset(). Blocks obtained from
+  // the upstream resource are kept across resets so that a warmed up arena never allocates again.
+  class linear_arena final : public std::pmr::memory_resource {
+  private:
+    struct block;
+
+    ptr<std::pmr::memory_resource> m_upstream{ };
+    usize m_block_size{ };
+    ptr<block> m_first{ };
+    ptr<block> m_current{ };
+    usize m_offset{ };
+
+    ptr<void> do_allocate(const usize bytes, const usize alignment) override;
+    void do_deallocate(const ptr<void> memory, const usize bytes, const usize alignment) noexcept override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+  public:
+    explicit linear_arena(const usize block_size);
+    linear_arena(const usize block_size, const ptr<std::pmr::memory_resource> upstream);
+    linear_arena(const linear_arena& other) = delete;
+    linear_arena(linear_arena&& other) = delete;
+
+    ~linear_arena() noexcept;
+
+    linear_arena& operator=(const linear_arena& rhs) = delete;
+    linear_arena& operator=(linear_arena&& rhs) = delete;
+
+    // Invalidate every allocation made from the arena.
+    void reset() noexcept;
+    // Return every block to the upstream resource.
+    void release() noexcept;
+    usize capacity() const noexcept;
+  };
+
+  // A free list of fixed size blocks carved from chunks. Requests larger than the block size are forwarded to the
+  // upstream resource.
+  class block_pool final : public std::pmr::memory_resource {
+  private:
+    struct chunk;
+    struct free_block;
+
+    ptr<std::pmr::memory_resource> m_upstream{ };
+    usize m_block_size{ };
+    usize m_blocks_per_chunk{ };
+    ptr<chunk> m_chunks{ };
+    ptr<free_block> m_free_blocks{ };
+
+    ptr<void> do_allocate(const usize bytes, const usize alignment) override;
+    void do_deallocate(const ptr<void> memory, const usize bytes, const usize alignment) noexcept override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+  public:
+    block_pool(const usize block_size, const usize blocks_per_chunk);
+    block_pool(const usize block_size, const usize blocks_per_chunk, const ptr<std::pmr::memory_resource> upstream);
+    block_pool(const block_pool& other) = delete;
+    block_pool(block_pool&& other) = delete;
+
+    ~block_pool() noexcept;
+
+    block_pool& operator=(const block_pool& rhs) = delete;
+    block_pool& operator=(block_pool&& rhs) = delete;
+
+    // Return every chunk to the upstream resource. Every block must have been deallocated.
+    void release() noexcept;
+    usize block_size() const noexcept;
+  };
+
 }
 
 #endif
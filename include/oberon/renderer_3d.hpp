@@ -1,7 +1,15 @@
 #ifndef OBERON_RENDERER_3D_HPP
 #define OBERON_RENDERER_3D_HPP
 
+#include <cstddef>
+
+#include <span>
+
 #include "object.hpp"
+#include "math.hpp"
+#include "bounds.hpp"
+#include "culling.hpp"
+#include "resources.hpp"
 
 namespace oberon {
 namespace detail {
@@ -12,6 +20,32 @@ namespace detail {
 
   class window;
 
+  // How a renderer distributes the work of a frame across threads.
+  enum class frame_execution {
+    // Recording, submission, and presentation all happen on the calling thread.
+    serial,
+    // The calling thread records frames while dedicated threads submit and present previously recorded frames.
+    pipelined
+  };
+
+  // Corresponds to VkPresentModeKHR. FIFO is always available. Other modes fall back to FIFO when unavailable.
+  enum class presentation_mode {
+    fifo,
+    fifo_relaxed,
+    mailbox,
+    immediate
+  };
+
+  // What a renderer does while its window is unmapped or fully obscured.
+  enum class occlusion_policy {
+    // Render normally.
+    none,
+    // Render at a greatly reduced rate.
+    throttle,
+    // Skip frames entirely. begin_frame() sleeps briefly so that loops calling it don't spin.
+    suspend
+  };
+
   class renderer_3d : public object {
   private:
     virtual void v_dispose() noexcept override;
@@ -19,15 +53,114 @@ namespace detail {
     renderer_3d(const window& win, const ptr<detail::renderer_3d_impl> impl);
   public:
     renderer_3d(const window& win);
+    // Pipelined execution falls back to serial when the window's swapchain can't hold an image for every frame in
+    // flight. is_pipelined() reports which one is in effect, which may change when the renderer is rebuilt.
+    renderer_3d(const window& win, const frame_execution execution);
 
     virtual ~renderer_3d() noexcept;
 
+    bool is_pipelined() const;
     bool should_rebuild() const;
     renderer_3d& rebuild();
 
+    // Request a new presentation mode. This takes effect when the renderer is next rebuilt.
+    renderer_3d& request_presentation_mode(const presentation_mode mode);
+    presentation_mode current_presentation_mode() const;
+
+    // Delay begin_frame() until the next frame deadline. Deadlines are spaced by the refresh rate of the monitor
+    // displaying the window or by a fixed rate in Hz.
+    renderer_3d& pace_to_refresh_rate();
+    renderer_3d& pace_to_frame_rate(const f64 frames_per_second);
+    renderer_3d& disable_frame_pacing();
+
+    renderer_3d& set_occlusion_policy(const occlusion_policy policy);
+
+    // Development only. Watch a directory for SPIR-V files named <shader>.<stage>.spv (e.g. test_frame.frag.spv) and
+    // replace the builtin shader with the file's contents whenever it's written. Affected pipelines are compiled on a
+    // background thread and swapped in at the start of a later frame. Frames in flight keep their old pipelines.
+    renderer_3d& watch_shader_directory(const cstring directory);
+    renderer_3d& stop_watching_shaders();
+
+    // Skip the next frame because it would be identical to the last. The previously presented image remains on
+    // screen. The frame is still drawn if the window contents were lost or the renderer was rebuilt.
+    renderer_3d& mark_frame_unchanged();
+    // Report a region of the next frame that differs from the previous frame. When VK_KHR_incremental_present is
+    // available only damaged regions are presented. If no damage is reported then the whole frame is presented.
+    renderer_3d& add_damage(const bounding_rect& rect);
+
     renderer_3d& begin_frame();
     renderer_3d& end_frame();
     renderer_3d& draw_test_frame();
+
+    // Test instance_count bounding spheres against f on the GPU and write a draw command for each visible instance.
+    // bounds holds a { x, y, z, radius } vec4 per instance and transforms holds a model matrix per instance. Both must
+    // have been created with BUFFER_USAGE_STORAGE_BIT. The mesh must have tightly packed vec3 positions and 32-bit
+    // indices. Instances must be culled before anything else is drawn in the frame. instance_count must be greater
+    // than 0 and small enough that every per-instance range fits in maxStorageBufferRange. Requires the Vulkan 1.2
+    // drawIndirectCount feature and the drawIndirectFirstInstance feature. Returns a batch that's valid until
+    // end_frame(). Neither call is captured by bundles.
+    usize cull_instances(const mesh_handle mesh, const buffer_handle bounds, const buffer_handle transforms,
+                         const u32 instance_count, const frustum& f);
+    // Draw the visible instances of a batch with a single indirect draw. The CPU cost doesn't depend on the number of
+    // instances.
+    renderer_3d& draw_culled_instances(const usize batch, const mat4& view_projection);
+
+    // Open and close a named region of the current frame for GPU debuggers and profilers. Regions nest and must be
+    // closed in the frame they were opened in. These do nothing unless the renderer belongs to a debug_context and
+    // debug labels were enabled at build time. They're also ignored while recording a bundle.
+    renderer_3d& begin_label(const cstring name);
+    renderer_3d& end_label();
+
+    // Bundles are whole frames recorded once per swapchain image and then resubmitted without any recording work.
+    // Draw calls made between begin_bundle() and end_bundle() are captured into the bundle instead of being recorded.
+    // Bundles are recorded lazily and are recorded again after the renderer is rebuilt.
+    renderer_3d& begin_bundle();
+    usize end_bundle();
+    // Draw, submit, and present a bundle in place of begin_frame(), draw calls, and end_frame().
+    renderer_3d& present_bundle(const usize bundle);
+    renderer_3d& discard_bundle(const usize bundle);
+
+    // Resources are owned by the renderer and referred to by handle. Destroying a resource invalidates its handle
+    // immediately but the underlying objects are kept alive until every frame that could have used them has finished
+    // executing.
+    buffer_handle create_buffer(const usize size, const u32 usage, const memory_location location);
+    image_handle create_image(const extent_2d& extent, const image_format format, const u32 usage);
+    sampler_handle create_sampler(const sampler_filter filter, const sampler_address_mode address_mode);
+    // Meshes refer to buffers without owning them. The index buffer must have been created with
+    // BUFFER_USAGE_INDEX_BIT.
+    mesh_handle create_mesh(const buffer_handle vertices, const buffer_handle indices, const u32 index_count);
+    renderer_3d& destroy_buffer(const buffer_handle buffer);
+    renderer_3d& destroy_image(const image_handle image);
+    renderer_3d& destroy_sampler(const sampler_handle sampler);
+    renderer_3d& destroy_mesh(const mesh_handle mesh);
+    bool is_valid(const buffer_handle buffer) const;
+    bool is_valid(const image_handle image) const;
+    bool is_valid(const sampler_handle sampler) const;
+    bool is_valid(const mesh_handle mesh) const;
+
+    // Buffers in host memory are mapped for their entire lifetime. The span is invalidated by destroy_buffer().
+    std::span<std::byte> map_buffer(const buffer_handle buffer);
+    // Host memory for at least size bytes of per-instance data belonging to the current frame. The GPU has finished
+    // with anything previously written there so it may be overwritten freely. It must be written between
+    // begin_frame() and end_frame() and isn't captured by bundles. The span is empty while the frame is skipped.
+    std::span<std::byte> frame_instance_memory(const usize size);
+    // The buffer behind frame_instance_memory(). Usable as a vertex or storage buffer by the current frame.
+    buffer_handle frame_instance_buffer() const;
+  };
+
+  // Opens a label on construction and closes it on destruction.
+  class scoped_label final {
+  private:
+    ptr<renderer_3d> m_renderer{ };
+  public:
+    scoped_label(renderer_3d& renderer, const cstring name);
+    scoped_label(const scoped_label& other) = delete;
+    scoped_label(scoped_label&& other) = delete;
+
+    ~scoped_label() noexcept;
+
+    scoped_label& operator=(const scoped_label& rhs) = delete;
+    scoped_label& operator=(scoped_label&& rhs) = delete;
   };
 
 }
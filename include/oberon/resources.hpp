@@ -0,0 +1,95 @@
+#ifndef OBERON_RESOURCES_HPP
+#define OBERON_RESOURCES_HPP
+
+#include "types.hpp"
+
+namespace oberon {
+
+  // A reference to a resource owned by a renderer. Handles are plain values so they can be stored and passed between
+  // threads freely. A handle to a destroyed resource is detected and rejected rather than aliasing a newer resource.
+  template <typename Tag>
+  class resource_handle final {
+  private:
+    u64 m_value{ };
+  public:
+    constexpr resource_handle() noexcept = default;
+    constexpr explicit resource_handle(const u64 value) noexcept : m_value{ value } { }
+
+    constexpr u64 value() const noexcept {
+      return m_value;
+    }
+
+    // False for default constructed handles. This doesn't imply that the resource still exists.
+    constexpr explicit operator bool() const noexcept {
+      return m_value;
+    }
+
+    constexpr bool operator==(const resource_handle& rhs) const noexcept = default;
+  };
+
+  struct buffer_tag;
+  struct image_tag;
+  struct sampler_tag;
+  struct pipeline_tag;
+  struct mesh_tag;
+
+  using buffer_handle = resource_handle<buffer_tag>;
+  using image_handle = resource_handle<image_tag>;
+  using sampler_handle = resource_handle<sampler_tag>;
+  using pipeline_handle = resource_handle<pipeline_tag>;
+  using mesh_handle = resource_handle<mesh_tag>;
+
+  enum buffer_usage_bits : u32 {
+    BUFFER_USAGE_NONE_BIT = 0,
+    BUFFER_USAGE_VERTEX_BIT = 0x01,
+    BUFFER_USAGE_INDEX_BIT = 0x02,
+    BUFFER_USAGE_UNIFORM_BIT = 0x04,
+    BUFFER_USAGE_STORAGE_BIT = 0x08,
+    BUFFER_USAGE_INDIRECT_BIT = 0x10,
+    BUFFER_USAGE_TRANSFER_SOURCE_BIT = 0x20,
+    BUFFER_USAGE_TRANSFER_DESTINATION_BIT = 0x40
+  };
+
+  enum image_usage_bits : u32 {
+    IMAGE_USAGE_NONE_BIT = 0,
+    IMAGE_USAGE_SAMPLED_BIT = 0x01,
+    IMAGE_USAGE_STORAGE_BIT = 0x02,
+    IMAGE_USAGE_COLOR_ATTACHMENT_BIT = 0x04,
+    IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT = 0x08,
+    IMAGE_USAGE_TRANSFER_SOURCE_BIT = 0x10,
+    IMAGE_USAGE_TRANSFER_DESTINATION_BIT = 0x20
+  };
+
+  // Where the memory backing a resource lives.
+  enum class memory_location {
+    // Fastest for the GPU. Not accessible from the CPU.
+    device,
+    // Visible to and coherent with the CPU.
+    host
+  };
+
+  enum class image_format {
+    r8g8b8a8_unorm,
+    r8g8b8a8_srgb,
+    b8g8r8a8_srgb,
+    r16g16b16a16_sfloat,
+    r32_sfloat,
+    d32_sfloat,
+    d24_unorm_s8_uint
+  };
+
+  enum class sampler_filter {
+    nearest,
+    linear
+  };
+
+  enum class sampler_address_mode {
+    repeat,
+    mirrored_repeat,
+    clamp_to_edge,
+    clamp_to_border
+  };
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef OBERON_TRACE_HPP
+#define OBERON_TRACE_HPP
+
+#include "types.hpp"
+#include "memory.hpp"
+
+#define OBERON_TRACE_CONCAT_IMPL(a, b) a##b
+#define OBERON_TRACE_CONCAT(a, b) OBERON_TRACE_CONCAT_IMPL(a, b)
+
+// Zones are only recorded when OBERON_ENABLE_TRACING is defined. Otherwise every macro below expands to nothing.
+// Zone and thread names *must* have static storage duration (e.g. string literals).
+#if defined(OBERON_ENABLE_TRACING)
+  // Record the time between this statement and the end of the enclosing scope.
+  #define OBERON_TRACE_ZONE(name) \
+    const oberon::trace_zone OBERON_TRACE_CONCAT(oberon_trace_zone_, __COUNTER__){ (name) }
+
+  #define OBERON_TRACE_THREAD_NAME(name) \
+    oberon::set_trace_thread_name((name))
+#else
+  #define OBERON_TRACE_ZONE(name) ((void) 0)
+
+  #define OBERON_TRACE_THREAD_NAME(name) ((void) 0)
+#endif
+
+namespace oberon {
+
+#if defined(OBERON_ENABLE_TRACING)
+  constexpr bool IS_TRACING_ENABLED{ true };
+#else
+  constexpr bool IS_TRACING_ENABLED{ false };
+#endif
+
+  enum class trace_track {
+    // The thread that recorded the event.
+    cpu,
+    // GPU execution on the graphics queue.
+    gpu
+  };
+
+  // Each thread records into its own fixed size buffer without locking. Events recorded after a thread's buffer is
+  // full are dropped and counted instead. Buffers live until the program exits.
+
+  // Discard every recorded event and start recording. Must not be called concurrently with write_trace().
+  void start_trace() noexcept;
+  // Stop recording. Zones that are still open when this is called aren't recorded.
+  void stop_trace() noexcept;
+  bool is_trace_active() noexcept;
+  // Write every recorded event as Chrome trace event JSON. The file can be opened with Perfetto or chrome://tracing.
+  // Returns false if the file can't be written.
+  bool write_trace(const cstring path) noexcept;
+  // The number of events dropped because a thread's buffer was full.
+  u64 dropped_trace_events() noexcept;
+
+  // Name the calling thread in written traces.
+  void set_trace_thread_name(const cstring name) noexcept;
+  // Nanoseconds on the trace clock (std::chrono::steady_clock).
+  i64 trace_time() noexcept;
+  // Record a completed event. Times are in nanoseconds on the trace clock. Ignored while the trace isn't active.
+  void record_trace_event(const cstring name, const trace_track track, const i64 begin, const i64 end) noexcept;
+
+  class trace_zone final {
+  private:
+    cstring m_name{ };
+    i64 m_begin{ };
+  public:
+    trace_zone(const cstring name) noexcept;
+    trace_zone(const trace_zone& other) = delete;
+    trace_zone(trace_zone&& other) = delete;
+
+    ~trace_zone() noexcept;
+
+    trace_zone& operator=(const trace_zone& rhs) = delete;
+    trace_zone& operator=(trace_zone&& rhs) = delete;
+  };
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+#ifndef OBERON_TRANSFORM_HIERARCHY_HPP
+#define OBERON_TRANSFORM_HIERARCHY_HPP
+
+#include <vector>
+#include <span>
+
+#include "types.hpp"
+#include "math.hpp"
+
+namespace oberon {
+
+  // Identifies a node of a transform_hierarchy. Nodes are numbered from 0 in creation order.
+  using transform_node = u32;
+
+  constexpr transform_node NO_TRANSFORM_NODE{ -1U };
+
+  // A decomposed affine transform. The rotation must be a unit quaternion.
+  struct transform final {
+    vec3 translation{ };
+    quat rotation{ };
+    vec3 scale{ 1.0f, 1.0f, 1.0f };
+  };
+
+  /**
+   * A forest of transforms stored as parallel arrays in breadth first order.
+   *
+   * Every array is indexed by position rather than by node. Nodes are sorted by depth so that every parent precedes
+   * its children and all nodes of one depth are contiguous. An update walks the depths in order and splits each depth
+   * into chunks that are processed in parallel without ever following a pointer.
+   *
+   * Changing a local transform marks only that node. Updates recompute the world matrices of marked nodes and their
+   * descendants and leave every other matrix untouched.
+   *
+   * Nodes live as long as the hierarchy. Positions are stable except when update() re-sorts the hierarchy after nodes
+   * were created out of breadth first order.
+   */
+  class transform_hierarchy final {
+  private:
+    static constexpr u32 NO_POSITION{ -1U };
+
+    // Indexed by node.
+    std::vector<u32> m_positions{ };
+    // Indexed by position.
+    std::vector<transform_node> m_nodes{ };
+    std::vector<u32> m_parents{ };
+    std::vector<u32> m_depths{ };
+    std::vector<vec3> m_translations{ };
+    std::vector<quat> m_rotations{ };
+    std::vector<vec3> m_scales{ };
+    std::vector<mat4> m_local_matrices{ };
+    std::vector<mat4> m_world_matrices{ };
+    // Set when the local transform changed since the last update.
+    std::vector<u8> m_local_dirty{ };
+    // Set when the world matrix changed in the last update.
+    std::vector<u8> m_world_changed{ };
+    // The first position of each depth followed by the total number of nodes.
+    std::vector<usize> m_depth_offsets{ 0 };
+    usize m_dirty_count{ };
+    bool m_has_changed_worlds{ };
+    bool m_is_order_stale{ };
+
+    u32 position_of(const transform_node node) const;
+    void mark_dirty(const u32 position) noexcept;
+    void sort_breadth_first();
+    void update_range(const usize begin, const usize end) noexcept;
+  public:
+    /**
+     * Add a node to the hierarchy.
+     *
+     * @param parent The parent of the new node or NO_TRANSFORM_NODE to create a root.
+     * @param local The transform of the node relative to its parent.
+     *
+     * @return The new node.
+     */
+    transform_node create_node(const transform_node parent, const transform& local);
+    transform_node create_node(const transform_node parent);
+    // Remove every node.
+    void clear() noexcept;
+    // Preallocate storage for node_count nodes.
+    void reserve(const usize node_count);
+
+    transform_hierarchy& set_local(const transform_node node, const transform& local);
+    transform_hierarchy& set_translation(const transform_node node, const vec3& translation);
+    transform_hierarchy& set_rotation(const transform_node node, const quat& rotation);
+    transform_hierarchy& set_scale(const transform_node node, const vec3& scale);
+
+    transform local(const transform_node node) const;
+    transform_node parent(const transform_node node) const;
+    // The world matrix of node as of the last update.
+    const mat4& world_matrix(const transform_node node) const;
+    // Whether the world matrix of node changed in the last update.
+    bool has_changed(const transform_node node) const;
+
+    // The index of node in world_matrices() and in instance buffers written by update().
+    usize instance_index(const transform_node node) const;
+    // World matrices in position order.
+    std::span<const mat4> world_matrices() const noexcept;
+    usize size() const noexcept;
+    usize depth_count() const noexcept;
+
+    /**
+     * Recompute the world matrix of every node whose local transform changed and of every descendant of such a node.
+     *
+     * This re-sorts the hierarchy first if nodes were created out of breadth first order.
+     */
+    void update();
+
+    /**
+     * Update the hierarchy and write every world matrix into an instance buffer.
+     *
+     * Each chunk is copied right after it's updated while it's still in cache. Every matrix is written, not only the
+     * ones that changed, so the destination may hold the contents of any earlier frame (e.g., a per-frame buffer
+     * from renderer_3d::frame_instance_memory()). Writes are sequential which suits write combined memory.
+     *
+     * @param instances Storage for at least size() matrices. Node n is written to instances[instance_index(n)].
+     */
+    void update(const std::span<mat4> instances);
+  };
+
+}
+
+#endif
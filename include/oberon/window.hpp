@@ -36,12 +36,17 @@ namespace events {
     imax id() const;
 
     bool is_hidden() const;
+    // Whether the window is mapped and not fully obscured by other windows.
+    bool is_visible() const;
     window& show();
     window& hide();
 
     const extent_2d& size() const;
     usize width() const;
     usize height() const;
+
+    // The refresh rate, in Hz, of the monitor displaying the window. 0 if the rate is unknown.
+    f64 refresh_rate() const;
 /*
     window& notify(const event& ev);
     window& notify(const events::window_expose_data& expose);
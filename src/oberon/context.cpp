@@ -9,8 +9,10 @@
 #include "oberon/debug.hpp"
 #include "oberon/errors.hpp"
 #include "oberon/events.hpp"
+#include "oberon/trace.hpp"
 
 #include "oberon/detail/window_impl.hpp"
+#include "oberon/detail/vulkan_call_tracing.hpp"
 
 namespace oberon {
 namespace detail {
@@ -42,6 +44,176 @@ namespace detail {
     return 0;
   }
 
+namespace {
+
+  void store_x11_monitors(
+    context_impl& ctx,
+    const ptr<xcb_randr_get_screen_resources_current_reply_t> resources
+  ) {
+    auto crtcs = xcb_randr_get_screen_resources_current_crtcs(resources);
+    auto crtc_count = xcb_randr_get_screen_resources_current_crtcs_length(resources);
+    auto modes = xcb_randr_get_screen_resources_current_modes(resources);
+    auto mode_count = xcb_randr_get_screen_resources_current_modes_length(resources);
+    auto crtc_cookies = std::vector<xcb_randr_get_crtc_info_cookie_t>(crtc_count);
+    for (auto cur = crtcs; auto& crtc_cookie : crtc_cookies)
+    {
+      crtc_cookie = xcb_randr_get_crtc_info(ctx.x11_connection, *(cur++), resources->config_timestamp);
+    }
+    ctx.x11_monitors.clear();
+    for (auto cur = crtcs; const auto& crtc_cookie : crtc_cookies)
+    {
+      auto crtc = *(cur++);
+      auto crtc_info = xcb_randr_get_crtc_info_reply(ctx.x11_connection, crtc_cookie, nullptr);
+      if (!crtc_info)
+      {
+        continue;
+      }
+      // CRTCs without a mode or without outputs are disabled.
+      if (crtc_info->mode != XCB_NONE && crtc_info->num_outputs > 0)
+      {
+        auto monitor = x11_monitor{ };
+        auto outputs = xcb_randr_get_crtc_info_outputs(crtc_info);
+        monitor.output = *outputs;
+        for (auto i = 0; i < crtc_info->num_outputs; ++i)
+        {
+          if (outputs[i] == ctx.x11_primary_output)
+          {
+            monitor.output = outputs[i];
+          }
+        }
+        monitor.crtc = crtc;
+        monitor.mode = crtc_info->mode;
+        for (auto i = 0; i < mode_count; ++i)
+        {
+          if (modes[i].id == monitor.mode)
+          {
+            monitor.refresh_rate = x11_mode_refresh_rate(modes[i]);
+            break;
+          }
+        }
+        monitor.bounds = { { crtc_info->x, crtc_info->y }, { crtc_info->width, crtc_info->height } };
+        ctx.x11_monitors.push_back(monitor);
+      }
+      std::free(crtc_info);
+    }
+  }
+
+}
+
+  iresult cache_x11_server_info(context_impl& ctx) noexcept {
+    OBERON_PRECONDITION(ctx.x11_connection);
+    OBERON_PRECONDITION(!xcb_connection_has_error(ctx.x11_connection));
+    OBERON_PRECONDITION(ctx.x11_screen);
+    auto connection = ctx.x11_connection;
+    // Issue every request before waiting on any reply.
+    xcb_prefetch_extension_data(connection, &xcb_randr_id);
+    auto atom_cookies = std::array<xcb_intern_atom_cookie_t, X11_ATOM_COUNT>{ };
+    for (auto i = usize{ 0 }; auto& atom_cookie : atom_cookies)
+    {
+      auto name = x11_atom_name(static_cast<x11_atom>(i++));
+      atom_cookie = xcb_intern_atom(connection, false, std::strlen(name), name);
+    }
+    auto randr_data = xcb_get_extension_data(connection, &xcb_randr_id);
+    ctx.has_x11_randr = randr_data && randr_data->present;
+    auto version_cookie = xcb_randr_query_version_cookie_t{ };
+    auto resources_cookie = xcb_randr_get_screen_resources_current_cookie_t{ };
+    auto primary_cookie = xcb_randr_get_output_primary_cookie_t{ };
+    if (ctx.has_x11_randr)
+    {
+      ctx.x11_randr_event_base = randr_data->first_event;
+      version_cookie = xcb_randr_query_version(connection, 1, 3);
+      resources_cookie = xcb_randr_get_screen_resources_current(connection, ctx.x11_screen->root);
+      primary_cookie = xcb_randr_get_output_primary(connection, ctx.x11_screen->root);
+    }
+    // Resolve replies.
+    auto result = iresult{ 0 };
+    for (auto cur = std::begin(ctx.x11_atoms); const auto& atom_cookie : atom_cookies)
+    {
+      auto& atom = *(cur++);
+      auto atom_reply = xcb_intern_atom_reply(connection, atom_cookie, nullptr);
+      if (!atom_reply)
+      {
+        atom = XCB_ATOM_NONE;
+        result = -1;
+        continue;
+      }
+      atom = atom_reply->atom;
+      std::free(atom_reply);
+    }
+    if (ctx.has_x11_randr)
+    {
+      auto version_reply = xcb_randr_query_version_reply(connection, version_cookie, nullptr);
+      ctx.has_x11_randr = version_reply &&
+                          (version_reply->major_version > 1 || version_reply->minor_version >= 3);
+      std::free(version_reply);
+      auto resources_reply = xcb_randr_get_screen_resources_current_reply(connection, resources_cookie, nullptr);
+      auto primary_reply = xcb_randr_get_output_primary_reply(connection, primary_cookie, nullptr);
+      if (ctx.has_x11_randr)
+      {
+        auto notify_mask = XCB_RANDR_NOTIFY_MASK_SCREEN_CHANGE |
+                           XCB_RANDR_NOTIFY_MASK_CRTC_CHANGE |
+                           XCB_RANDR_NOTIFY_MASK_OUTPUT_CHANGE;
+        xcb_randr_select_input(connection, ctx.x11_screen->root, notify_mask);
+        xcb_flush(connection);
+        ctx.x11_primary_output = primary_reply ? primary_reply->output : XCB_NONE;
+        if (resources_reply)
+        {
+          store_x11_monitors(ctx, resources_reply);
+        }
+      }
+      std::free(primary_reply);
+      std::free(resources_reply);
+    }
+    OBERON_POSTCONDITION(OBERON_IS_IERROR(result) || ctx.x11_atoms[0] != XCB_ATOM_NONE);
+    return result;
+  }
+
+  iresult refresh_x11_monitors(context_impl& ctx) noexcept {
+    OBERON_PRECONDITION(ctx.x11_connection);
+    OBERON_PRECONDITION(!xcb_connection_has_error(ctx.x11_connection));
+    OBERON_PRECONDITION(ctx.has_x11_randr);
+    OBERON_TRACE_ZONE("refresh monitors");
+    auto connection = ctx.x11_connection;
+    auto resources_cookie = xcb_randr_get_screen_resources_current(connection, ctx.x11_screen->root);
+    auto primary_cookie = xcb_randr_get_output_primary(connection, ctx.x11_screen->root);
+    auto resources_reply = xcb_randr_get_screen_resources_current_reply(connection, resources_cookie, nullptr);
+    auto primary_reply = xcb_randr_get_output_primary_reply(connection, primary_cookie, nullptr);
+    ctx.should_refresh_x11_monitors = false;
+    ctx.x11_primary_output = primary_reply ? primary_reply->output : XCB_NONE;
+    std::free(primary_reply);
+    if (!resources_reply)
+    {
+      return -1;
+    }
+    store_x11_monitors(ctx, resources_reply);
+    std::free(resources_reply);
+    for (auto& [ id, win ] : ctx.windows)
+    {
+      update_x11_window_monitor(ctx, reference_cast<window_impl>(win->implementation()));
+    }
+    return 0;
+  }
+
+  readonly_ptr<x11_monitor> select_x11_monitor(const context_impl& ctx) noexcept {
+    if (!std::size(ctx.x11_monitors))
+    {
+      return nullptr;
+    }
+    for (const auto& monitor : ctx.x11_monitors)
+    {
+      if (monitor.output == ctx.x11_primary_output)
+      {
+        return &monitor;
+      }
+    }
+    return &ctx.x11_monitors.front();
+  }
+
+  xcb_atom_t get_x11_atom(const context_impl& ctx, const x11_atom atom) noexcept {
+    OBERON_PRECONDITION(atom < x11_atom::max_value);
+    return ctx.x11_atoms[static_cast<usize>(atom)];
+  }
+
   iresult get_instance_extensions(
     context_impl& ctx,
     const std::unordered_set<std::string>& layers,
@@ -121,7 +293,7 @@ namespace detail {
     instance_info.ppEnabledExtensionNames = std::data(exts);
     instance_info.enabledExtensionCount = std::size(exts);
 
-    if (auto result = vkCreateInstance(&instance_info, nullptr, &ctx.instance); result != VK_SUCCESS)
+    if (auto result = vkCreateInstance(&instance_info, ctx.host_allocator, &ctx.instance); result != VK_SUCCESS)
     {
       return result;
     }
@@ -201,7 +373,9 @@ namespace {
     OBERON_PRECONDITION(ctx.instance);
     OBERON_PRECONDITION(ctx.vkft.vkEnumeratePhysicalDevices);
     OBERON_PRECONDITION(ctx.vkft.vkGetPhysicalDeviceXcbPresentationSupportKHR);
+    OBERON_PRECONDITION(ctx.vkft.vkGetPhysicalDeviceMemoryProperties);
     auto vkEnumeratePhysicalDevices = ctx.vkft.vkEnumeratePhysicalDevices;
+    auto vkGetPhysicalDeviceMemoryProperties = ctx.vkft.vkGetPhysicalDeviceMemoryProperties;
     auto vkGetPhysicalDeviceXcbPresentationSupportKHR = ctx.vkft.vkGetPhysicalDeviceXcbPresentationSupportKHR;
     auto pdev_infos = std::vector<physical_device_info>{ };
     {
@@ -251,6 +425,7 @@ namespace {
     ctx.physical_device = std::begin(filtered_pdev_infos)->handle;
     ctx.physical_device_properties = std::begin(filtered_pdev_infos)->properties;
     ctx.device_extensions = std::begin(filtered_pdev_infos)->extensions;
+    vkGetPhysicalDeviceMemoryProperties(ctx.physical_device, &ctx.physical_device_memory_properties);
     OBERON_POSTCONDITION(ctx.physical_device);
     OBERON_POSTCONDITION(std::size(ctx.device_extensions) >= std::size(required_extensions));
     return 0;
@@ -315,9 +490,63 @@ namespace {
     auto device_info = VkDeviceCreateInfo{ };
     OBERON_INIT_VK_STRUCT(device_info, DEVICE_CREATE_INFO);
     device_info.pNext = next;
-    auto features = VkPhysicalDeviceFeatures{ };
-    vkGetPhysicalDeviceFeatures(ctx.physical_device, &features);
-    device_info.pEnabledFeatures = &features;
+    auto features = VkPhysicalDeviceFeatures2{ };
+    OBERON_INIT_VK_STRUCT(features, PHYSICAL_DEVICE_FEATURES_2);
+    auto present_id_features = VkPhysicalDevicePresentIdFeaturesKHR{ };
+    OBERON_INIT_VK_STRUCT(present_id_features, PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR);
+    auto present_wait_features = VkPhysicalDevicePresentWaitFeaturesKHR{ };
+    OBERON_INIT_VK_STRUCT(present_wait_features, PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR);
+    auto vulkan_12_features = VkPhysicalDeviceVulkan12Features{ };
+    OBERON_INIT_VK_STRUCT(vulkan_12_features, PHYSICAL_DEVICE_VULKAN_1_2_FEATURES);
+    if (auto vkGetPhysicalDeviceFeatures2 = ctx.vkft.vkGetPhysicalDeviceFeatures2; vkGetPhysicalDeviceFeatures2)
+    {
+      // Extension feature structures may only be chained when the extension is available.
+      auto tail = &features.pNext;
+      // Likewise the Vulkan 1.2 feature structure may only be chained when the device supports Vulkan 1.2.
+      if (ctx.physical_device_properties.apiVersion >= VK_API_VERSION_1_2)
+      {
+        *tail = &vulkan_12_features;
+        tail = &vulkan_12_features.pNext;
+      }
+      if (ctx.device_extensions.contains(VK_KHR_PRESENT_ID_EXTENSION_NAME))
+      {
+        *tail = &present_id_features;
+        tail = &present_id_features.pNext;
+      }
+      if (ctx.device_extensions.contains(VK_KHR_PRESENT_WAIT_EXTENSION_NAME))
+      {
+        *tail = &present_wait_features;
+        tail = &present_wait_features.pNext;
+      }
+      vkGetPhysicalDeviceFeatures2(ctx.physical_device, &features);
+      *tail = const_cast<ptr<void>>(next);
+      device_info.pNext = &features;
+    }
+    else
+    {
+      vkGetPhysicalDeviceFeatures(ctx.physical_device, &features.features);
+      device_info.pEnabledFeatures = &features.features;
+    }
+    ctx.has_present_id = present_id_features.presentId;
+    ctx.has_present_wait = ctx.has_present_id && present_wait_features.presentWait;
+    ctx.has_incremental_present = ctx.device_extensions.contains(VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+    ctx.has_draw_indirect_count = vulkan_12_features.drawIndirectCount;
+    ctx.has_draw_indirect_first_instance = features.features.drawIndirectFirstInstance;
+    ctx.has_calibrated_timestamps = false;
+    if (auto vkGetPhysicalDeviceCalibrateableTimeDomainsEXT = ctx.vkft.vkGetPhysicalDeviceCalibrateableTimeDomainsEXT;
+        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT &&
+        ctx.device_extensions.contains(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+    {
+      auto sz = u32{ 0 };
+      vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(ctx.physical_device, &sz, nullptr);
+      auto time_domains = std::vector<VkTimeDomainEXT>(sz);
+      vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(ctx.physical_device, &sz, std::data(time_domains));
+      auto has_time_domain = [&time_domains](const VkTimeDomainEXT domain) {
+        return std::find(std::begin(time_domains), std::end(time_domains), domain) != std::end(time_domains);
+      };
+      ctx.has_calibrated_timestamps = has_time_domain(VK_TIME_DOMAIN_DEVICE_EXT) &&
+                                      has_time_domain(VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT);
+    }
 
     auto exts = std::vector<cstring>(std::size(ctx.device_extensions));
     for (auto cur = std::begin(exts); const auto& device_extension : ctx.device_extensions)
@@ -355,7 +584,8 @@ namespace {
       presentation_queue_info.queueCount = 1;
     }
 
-    if (auto result = vkCreateDevice(ctx.physical_device, &device_info, nullptr, &ctx.device); result != VK_SUCCESS)
+    if (auto result = vkCreateDevice(ctx.physical_device, &device_info, ctx.host_allocator, &ctx.device);
+        result != VK_SUCCESS)
     {
       return result;
     }
@@ -390,10 +620,15 @@ namespace {
     auto x11_ev = xcb_poll_for_event(ctx.x11_connection);
     if (!x11_ev)
     {
+      if (ctx.should_refresh_x11_monitors)
+      {
+        refresh_x11_monitors(ctx);
+      }
       ev.type = event_type::empty;
       return 0;
     }
-    switch (x11_ev->response_type & 0x7f) // ~0x80
+    auto response_type = x11_ev->response_type & 0x7f; // ~0x80
+    switch (response_type)
     {
     case XCB_CLIENT_MESSAGE:
       {
@@ -421,12 +656,65 @@ namespace {
         {
           goto err;
         }
+        if (result)
+        {
+          detail::update_x11_window_monitor(ctx, win_impl);
+        }
         ev.data.window_configure.bounds = win_impl.bounds;
         ev.data.window_configure.was_repositioned = result & WINDOW_CONFIGURE_REPOSITION_BIT;
         ev.data.window_configure.was_resized = result & WINDOW_CONFIGURE_RESIZE_BIT;
       }
       break;
+    case XCB_EXPOSE:
+      {
+        // The window contents were lost. The next frame must be redrawn even if it was marked unchanged.
+        auto expose_ev = reinterpret_cast<ptr<xcb_expose_event_t>>(x11_ev);
+        if (auto window_pos = ctx.windows.find(expose_ev->window); window_pos != std::end(ctx.windows))
+        {
+          ++reference_cast<detail::window_impl>(window_pos->second->implementation()).content_generation;
+        }
+      }
+      break;
+    case XCB_MAP_NOTIFY:
+    case XCB_UNMAP_NOTIFY:
+    case XCB_VISIBILITY_NOTIFY:
+      {
+        // Unmap notifications can arrive after a window has been removed from the context.
+        auto id = xcb_window_t{ };
+        switch (response_type)
+        {
+        case XCB_MAP_NOTIFY:
+          id = reinterpret_cast<ptr<xcb_map_notify_event_t>>(x11_ev)->window;
+          break;
+        case XCB_UNMAP_NOTIFY:
+          id = reinterpret_cast<ptr<xcb_unmap_notify_event_t>>(x11_ev)->window;
+          break;
+        default:
+          id = reinterpret_cast<ptr<xcb_visibility_notify_event_t>>(x11_ev)->window;
+          break;
+        }
+        auto window_pos = ctx.windows.find(id);
+        if (window_pos == std::end(ctx.windows))
+        {
+          goto err;
+        }
+        ev.type = event_type::window_visibility;
+        ev.window_ptr = window_pos->second;
+        auto& win_impl = reference_cast<detail::window_impl>(ev.window_ptr->implementation());
+        auto result = detail::handle_x11_visibility(win_impl, x11_ev);
+        if (OBERON_IS_IERROR(result))
+        {
+          goto err;
+        }
+        ev.data.window_visibility.is_visible = result;
+      }
+      break;
     default:
+      if (ctx.has_x11_randr && (response_type == ctx.x11_randr_event_base + XCB_RANDR_SCREEN_CHANGE_NOTIFY ||
+                                response_type == ctx.x11_randr_event_base + XCB_RANDR_NOTIFY))
+      {
+        ctx.should_refresh_x11_monitors = true;
+      }
       break;
     }
     std::free(x11_ev);
@@ -444,7 +732,7 @@ namespace {
     OBERON_ASSERT(ctx.instance);
     OBERON_ASSERT(ctx.vkft.vkDestroyDevice);
     auto vkDestroyDevice = ctx.vkft.vkDestroyDevice;
-    vkDestroyDevice(ctx.device, nullptr);
+    vkDestroyDevice(ctx.device, ctx.host_allocator);
     ctx.device = nullptr;
     OBERON_POSTCONDITION(!ctx.device);
     return 0;
@@ -457,7 +745,7 @@ namespace {
     }
     OBERON_ASSERT(ctx.vkft.vkDestroyInstance);
     auto vkDestroyInstance = ctx.vkft.vkDestroyInstance;
-    vkDestroyInstance(ctx.instance, nullptr);
+    vkDestroyInstance(ctx.instance, ctx.host_allocator);
     ctx.instance = nullptr;
     OBERON_POSTCONDITION(!ctx.instance);
     return 0;
@@ -486,6 +774,7 @@ namespace {
     OBERON_PRECONDITION(ctx.device);
     OBERON_PRECONDITION(ctx.vkft.vkDeviceWaitIdle);
     auto vkDeviceWaitIdle = ctx.vkft.vkDeviceWaitIdle;
+    OBERON_TRACE_ZONE("wait for device idle");
     auto result = vkDeviceWaitIdle(ctx.device);
     if (result != VK_SUCCESS)
     {
@@ -503,6 +792,18 @@ namespace {
     const u16 application_version_major,
     const u16 application_version_minor,
     const u16 application_version_patch
+  ) : context{
+    application_name,
+    application_version_major, application_version_minor, application_version_patch,
+    CONTEXT_NONE_BIT
+  } { }
+
+  context::context(
+    const std::string& application_name,
+    const u16 application_version_major,
+    const u16 application_version_minor,
+    const u16 application_version_patch,
+    const u32 flags
   ) : object{ new detail::context_impl{ } } {
     auto& q = reference_cast<detail::context_impl>(implementation());
     detail::store_application_info(
@@ -510,10 +811,19 @@ namespace {
       application_name,
       application_version_major, application_version_minor, application_version_patch
     );
+    if (flags & CONTEXT_HOST_ALLOCATION_TRACKING_BIT)
+    {
+      detail::initialize_host_allocator(q.host_allocations);
+      q.host_allocator = &q.host_allocations.callbacks;
+    }
     if (OBERON_IS_IERROR(detail::connect_to_x11(q, nullptr)))
     {
       throw fatal_error{ "Failed to connect to X11 server." };
     }
+    if (OBERON_IS_IERROR(detail::cache_x11_server_info(q)))
+    {
+      throw fatal_error{ "Failed to retrieve X11 server information." };
+    }
     detail::load_vulkan_pfns(q.vkft);
     {
       auto required_extensions = std::unordered_set<std::string>{
@@ -534,7 +844,17 @@ namespace {
     detail::load_vulkan_pfns(q.vkft, q.instance);
     {
       auto required_extensions = std::unordered_set<std::string>{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-      if (OBERON_IS_IERROR(detail::select_physical_device(q, required_extensions, { })))
+      auto optional_extensions = std::unordered_set<std::string>{
+        VK_KHR_PRESENT_ID_EXTENSION_NAME,
+        VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+        VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME
+      };
+      // Only frame timestamps use calibrated timestamps.
+      if constexpr (IS_TRACING_ENABLED)
+      {
+        optional_extensions.insert(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+      }
+      if (OBERON_IS_IERROR(detail::select_physical_device(q, required_extensions, optional_extensions)))
       {
         throw fatal_error{ "None of the Vulkan physical devices available can be used." };
       }
@@ -545,6 +865,11 @@ namespace {
       }
     }
     detail::load_vulkan_pfns(q.vkft, q.device);
+    if ((flags & CONTEXT_VULKAN_CALL_TRACING_BIT) && OBERON_IS_IERROR(detail::install_vulkan_call_tracing(q.vkft)))
+    {
+      throw fatal_error{ "Vulkan call tracing is already enabled by another context." };
+    }
+    q.is_tracing_vulkan_calls = flags & CONTEXT_VULKAN_CALL_TRACING_BIT;
     detail::get_device_queues(q);
   }
 
@@ -552,6 +877,11 @@ namespace {
     auto& q = reference_cast<detail::context_impl>(implementation());
     detail::wait_for_device_idle(q);
     detail::destroy_vulkan_device(q);
+    if (q.is_tracing_vulkan_calls)
+    {
+      detail::uninstall_vulkan_call_tracing();
+      q.is_tracing_vulkan_calls = false;
+    }
     detail::destroy_vulkan_instance(q);
     detail::disconnect_from_x11(q);
   }
@@ -562,6 +892,7 @@ namespace {
 
   bool context::poll_events(event& ev) {
     auto& ctx = reference_cast<detail::context_impl>(implementation());
+    OBERON_TRACE_ZONE("poll events");
     poll_x11_event(ctx, ev);
     return ev.type != event_type::empty;
   }
@@ -571,4 +902,52 @@ namespace {
     return q.application_name;
   }
 
+  bool context::is_tracing_vulkan_calls() const {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    return q.is_tracing_vulkan_calls;
+  }
+
+  std::vector<vulkan_call_statistics> context::query_vulkan_call_statistics() const {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    auto statistics = std::vector<vulkan_call_statistics>{ };
+    if (q.is_tracing_vulkan_calls)
+    {
+      detail::read_vulkan_call_statistics(statistics);
+    }
+    return statistics;
+  }
+
+  bool context::is_tracking_host_allocations() const {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    return q.host_allocator;
+  }
+
+  host_allocation_statistics context::query_host_allocation_statistics() const {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    auto statistics = host_allocation_statistics{ };
+    if (q.host_allocator)
+    {
+      detail::read_host_allocation_statistics(q.host_allocations, statistics);
+    }
+    return statistics;
+  }
+
+  context& context::reset_host_allocation_counters() {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    if (q.host_allocator)
+    {
+      detail::reset_host_allocation_counters(q.host_allocations);
+    }
+    return *this;
+  }
+
+  context& context::reset_vulkan_call_statistics() {
+    auto& q = reference_cast<detail::context_impl>(implementation());
+    if (q.is_tracing_vulkan_calls)
+    {
+      detail::reset_vulkan_call_statistics();
+    }
+    return *this;
+  }
+
 }
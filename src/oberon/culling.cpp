@@ -0,0 +1,330 @@
+#include "oberon/culling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "oberon/memory.hpp"
+#include "oberon/debug.hpp"
+#include "oberon/trace.hpp"
+
+#include "oberon/detail/worker_pool.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define OBERON_CULLING_X86 1
+  #include <immintrin.h>
+#endif
+
+// Same scheme as the batch math kernels. SIMD kernels are only called when current_simd_level() allows them.
+#if defined(OBERON_CULLING_X86)
+  #define OBERON_TARGET_SSE4 __attribute__((target("sse4.1")))
+  #define OBERON_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace oberon {
+
+namespace {
+
+  // Each array of a chunk fits in L1 and every array of a chunk fits in L2 comfortably.
+  constexpr usize CULL_CHUNK_SIZE{ 8192 };
+  // Per-chunk counts live on the stack for up to two million objects so that culling every frame doesn't allocate.
+  constexpr usize MAX_STACK_CULL_CHUNKS{ 256 };
+
+  // Kernels cull [begin, end) and write the indices of visible objects to the start of visible.
+  struct culling_kernels final {
+    usize (*cull_spheres)(const frustum& f, const sphere_array& spheres, const usize begin, const usize end,
+                          ptr<u32> visible) noexcept{ };
+    usize (*cull_boxes)(const frustum& f, const box_array& boxes, const usize begin, const usize end,
+                        ptr<u32> visible) noexcept{ };
+  };
+
+  // Branchless compaction. Every lane is written but the count only advances past visible ones.
+  inline usize append_visible(ptr<u32> visible, usize count, const usize first, const u32 mask,
+                              const usize lanes) noexcept {
+    for (auto lane = usize{ 0 }; lane < lanes; ++lane)
+    {
+      visible[count] = static_cast<u32>(first + lane);
+      count += (mask >> lane) & 1;
+    }
+    return count;
+  }
+
+  // The corner of box furthest along the normal of plane. The box is outside the plane iff this corner is.
+  constexpr vec3 positive_vertex(const vec4& plane, const vec3& min, const vec3& max) noexcept {
+    return { plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z };
+  }
+
+  usize scalar_cull_spheres(const frustum& f, const sphere_array& spheres, const usize begin, const usize end,
+                            ptr<u32> visible) noexcept {
+    auto count = usize{ 0 };
+    for (auto i = begin; i < end; ++i)
+    {
+      auto sphere = bounding_sphere{ { spheres.center_x[i], spheres.center_y[i], spheres.center_z[i] },
+                                     spheres.radius[i] };
+      visible[count] = static_cast<u32>(i);
+      count += is_visible(f, sphere);
+    }
+    return count;
+  }
+
+  usize scalar_cull_boxes(const frustum& f, const box_array& boxes, const usize begin, const usize end,
+                          ptr<u32> visible) noexcept {
+    auto count = usize{ 0 };
+    for (auto i = begin; i < end; ++i)
+    {
+      auto box = axis_aligned_box{ { boxes.min_x[i], boxes.min_y[i], boxes.min_z[i] },
+                                   { boxes.max_x[i], boxes.max_y[i], boxes.max_z[i] } };
+      visible[count] = static_cast<u32>(i);
+      count += is_visible(f, box);
+    }
+    return count;
+  }
+
+  constexpr culling_kernels SCALAR_KERNELS{ scalar_cull_spheres, scalar_cull_boxes };
+
+#if defined(OBERON_CULLING_X86)
+  OBERON_TARGET_SSE4 usize sse4_cull_spheres(const frustum& f, const sphere_array& spheres, const usize begin,
+                                             const usize end, ptr<u32> visible) noexcept {
+    __m128 planes[6][4];
+    for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+    {
+      planes[p][0] = _mm_set1_ps(f.planes[p].x);
+      planes[p][1] = _mm_set1_ps(f.planes[p].y);
+      planes[p][2] = _mm_set1_ps(f.planes[p].z);
+      planes[p][3] = _mm_set1_ps(f.planes[p].w);
+    }
+    auto count = usize{ 0 };
+    auto i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+      const auto x = _mm_loadu_ps(std::data(spheres.center_x) + i);
+      const auto y = _mm_loadu_ps(std::data(spheres.center_y) + i);
+      const auto z = _mm_loadu_ps(std::data(spheres.center_z) + i);
+      const auto negative_radius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(std::data(spheres.radius) + i));
+      auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      for (const auto& plane : planes)
+      {
+        auto distance = _mm_add_ps(_mm_mul_ps(plane[0], x), plane[3]);
+        distance = _mm_add_ps(_mm_mul_ps(plane[1], y), distance);
+        distance = _mm_add_ps(_mm_mul_ps(plane[2], z), distance);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+      }
+      count = append_visible(visible, count, i, _mm_movemask_ps(inside), 4);
+    }
+    return count + scalar_cull_spheres(f, spheres, i, end, visible + count);
+  }
+
+  OBERON_TARGET_SSE4 usize sse4_cull_boxes(const frustum& f, const box_array& boxes, const usize begin,
+                                           const usize end, ptr<u32> visible) noexcept {
+    __m128 planes[6][4];
+    for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+    {
+      planes[p][0] = _mm_set1_ps(f.planes[p].x);
+      planes[p][1] = _mm_set1_ps(f.planes[p].y);
+      planes[p][2] = _mm_set1_ps(f.planes[p].z);
+      planes[p][3] = _mm_set1_ps(f.planes[p].w);
+    }
+    auto count = usize{ 0 };
+    auto i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+      const __m128 min[3]{ _mm_loadu_ps(std::data(boxes.min_x) + i), _mm_loadu_ps(std::data(boxes.min_y) + i),
+                           _mm_loadu_ps(std::data(boxes.min_z) + i) };
+      const __m128 max[3]{ _mm_loadu_ps(std::data(boxes.max_x) + i), _mm_loadu_ps(std::data(boxes.max_y) + i),
+                           _mm_loadu_ps(std::data(boxes.max_z) + i) };
+      auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+      for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+      {
+        const auto& plane = f.planes[p];
+        const auto x = plane.x >= 0.0f ? max[0] : min[0];
+        const auto y = plane.y >= 0.0f ? max[1] : min[1];
+        const auto z = plane.z >= 0.0f ? max[2] : min[2];
+        auto distance = _mm_add_ps(_mm_mul_ps(planes[p][0], x), planes[p][3]);
+        distance = _mm_add_ps(_mm_mul_ps(planes[p][1], y), distance);
+        distance = _mm_add_ps(_mm_mul_ps(planes[p][2], z), distance);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+      }
+      count = append_visible(visible, count, i, _mm_movemask_ps(inside), 4);
+    }
+    return count + scalar_cull_boxes(f, boxes, i, end, visible + count);
+  }
+
+  constexpr culling_kernels SSE4_KERNELS{ sse4_cull_spheres, sse4_cull_boxes };
+
+  OBERON_TARGET_AVX2 usize avx2_cull_spheres(const frustum& f, const sphere_array& spheres, const usize begin,
+                                             const usize end, ptr<u32> visible) noexcept {
+    __m256 planes[6][4];
+    for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+    {
+      planes[p][0] = _mm256_set1_ps(f.planes[p].x);
+      planes[p][1] = _mm256_set1_ps(f.planes[p].y);
+      planes[p][2] = _mm256_set1_ps(f.planes[p].z);
+      planes[p][3] = _mm256_set1_ps(f.planes[p].w);
+    }
+    auto count = usize{ 0 };
+    auto i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+      const auto x = _mm256_loadu_ps(std::data(spheres.center_x) + i);
+      const auto y = _mm256_loadu_ps(std::data(spheres.center_y) + i);
+      const auto z = _mm256_loadu_ps(std::data(spheres.center_z) + i);
+      const auto negative_radius = _mm256_sub_ps(_mm256_setzero_ps(),
+                                                 _mm256_loadu_ps(std::data(spheres.radius) + i));
+      auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+      for (const auto& plane : planes)
+      {
+        auto distance = _mm256_fmadd_ps(plane[0], x, plane[3]);
+        distance = _mm256_fmadd_ps(plane[1], y, distance);
+        distance = _mm256_fmadd_ps(plane[2], z, distance);
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+      }
+      count = append_visible(visible, count, i, _mm256_movemask_ps(inside), 8);
+    }
+    return count + scalar_cull_spheres(f, spheres, i, end, visible + count);
+  }
+
+  OBERON_TARGET_AVX2 usize avx2_cull_boxes(const frustum& f, const box_array& boxes, const usize begin,
+                                           const usize end, ptr<u32> visible) noexcept {
+    __m256 planes[6][4];
+    for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+    {
+      planes[p][0] = _mm256_set1_ps(f.planes[p].x);
+      planes[p][1] = _mm256_set1_ps(f.planes[p].y);
+      planes[p][2] = _mm256_set1_ps(f.planes[p].z);
+      planes[p][3] = _mm256_set1_ps(f.planes[p].w);
+    }
+    auto count = usize{ 0 };
+    auto i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+      const __m256 min[3]{ _mm256_loadu_ps(std::data(boxes.min_x) + i), _mm256_loadu_ps(std::data(boxes.min_y) + i),
+                           _mm256_loadu_ps(std::data(boxes.min_z) + i) };
+      const __m256 max[3]{ _mm256_loadu_ps(std::data(boxes.max_x) + i), _mm256_loadu_ps(std::data(boxes.max_y) + i),
+                           _mm256_loadu_ps(std::data(boxes.max_z) + i) };
+      auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+      for (auto p = usize{ 0 }; p < std::size(f.planes); ++p)
+      {
+        const auto& plane = f.planes[p];
+        const auto x = plane.x >= 0.0f ? max[0] : min[0];
+        const auto y = plane.y >= 0.0f ? max[1] : min[1];
+        const auto z = plane.z >= 0.0f ? max[2] : min[2];
+        auto distance = _mm256_fmadd_ps(planes[p][0], x, planes[p][3]);
+        distance = _mm256_fmadd_ps(planes[p][1], y, distance);
+        distance = _mm256_fmadd_ps(planes[p][2], z, distance);
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+      }
+      count = append_visible(visible, count, i, _mm256_movemask_ps(inside), 8);
+    }
+    return count + scalar_cull_boxes(f, boxes, i, end, visible + count);
+  }
+
+  constexpr culling_kernels AVX2_KERNELS{ avx2_cull_spheres, avx2_cull_boxes };
+#endif
+
+  const culling_kernels& kernels() noexcept {
+    switch (current_simd_level())
+    {
+#if defined(OBERON_CULLING_X86)
+    case simd_level::avx2:
+      return AVX2_KERNELS;
+    case simd_level::sse4:
+      return SSE4_KERNELS;
+#endif
+    default:
+      return SCALAR_KERNELS;
+    }
+  }
+
+  // Cull every chunk in place at the start of its own range of visible and then close the gaps between chunks.
+  template <typename Cull>
+  usize cull_in_chunks(const usize count, const std::span<u32> visible, const Cull& cull) {
+    OBERON_PRECONDITION(std::size(visible) >= count);
+    OBERON_PRECONDITION(count <= -1U);
+    auto chunk_count = (count + CULL_CHUNK_SIZE - 1) / CULL_CHUNK_SIZE;
+    auto stack_counts = std::array<usize, MAX_STACK_CULL_CHUNKS>{ };
+    auto heap_counts = std::vector<usize>{ };
+    auto visible_counts = std::span<usize>{ stack_counts }.first(std::min(chunk_count, MAX_STACK_CULL_CHUNKS));
+    if (chunk_count > MAX_STACK_CULL_CHUNKS)
+    {
+      heap_counts.resize(chunk_count);
+      visible_counts = heap_counts;
+    }
+    detail::default_worker_pool().parallel_for(count, CULL_CHUNK_SIZE, [&](const usize begin, const usize end) {
+      visible_counts[begin / CULL_CHUNK_SIZE] = cull(begin, end, std::data(visible) + begin);
+    });
+    auto total = usize{ 0 };
+    for (auto chunk = usize{ 0 }; chunk < chunk_count; ++chunk)
+    {
+      auto first = std::data(visible) + chunk * CULL_CHUNK_SIZE;
+      if (std::data(visible) + total != first)
+      {
+        std::copy(first, first + visible_counts[chunk], std::data(visible) + total);
+      }
+      total += visible_counts[chunk];
+    }
+    return total;
+  }
+
+}
+
+  frustum make_frustum(const mat4& view_projection) noexcept {
+    const auto& m = view_projection.columns;
+    auto x = vec4{ m[0].x, m[1].x, m[2].x, m[3].x };
+    auto y = vec4{ m[0].y, m[1].y, m[2].y, m[3].y };
+    auto z = vec4{ m[0].z, m[1].z, m[2].z, m[3].z };
+    auto w = vec4{ m[0].w, m[1].w, m[2].w, m[3].w };
+    // Vulkan clip space is -w <= x, y <= w and 0 <= z <= w.
+    auto result = frustum{ { { w + x, w - x, w + y, w - y, z, w - z } } };
+    for (auto& plane : result.planes)
+    {
+      plane = plane * (1.0f / length(vec3{ plane.x, plane.y, plane.z }));
+    }
+    return result;
+  }
+
+  bool is_visible(const frustum& f, const bounding_sphere& sphere) noexcept {
+    auto result = true;
+    for (const auto& plane : f.planes)
+    {
+      result &= dot(vec3{ plane.x, plane.y, plane.z }, sphere.center) + plane.w >= -sphere.radius;
+    }
+    return result;
+  }
+
+  bool is_visible(const frustum& f, const axis_aligned_box& box) noexcept {
+    auto result = true;
+    for (const auto& plane : f.planes)
+    {
+      result &= dot(vec3{ plane.x, plane.y, plane.z }, positive_vertex(plane, box.min, box.max)) + plane.w >= 0.0f;
+    }
+    return result;
+  }
+
+  usize cull_spheres(const frustum& f, const sphere_array& spheres, const std::span<u32> visible) {
+    OBERON_TRACE_ZONE("cull spheres");
+    auto count = std::size(spheres.center_x);
+    OBERON_PRECONDITION(std::size(spheres.center_y) == count && std::size(spheres.center_z) == count);
+    OBERON_PRECONDITION(std::size(spheres.radius) == count);
+    const auto& selected = kernels();
+    return cull_in_chunks(count, visible, [&](const usize begin, const usize end, const ptr<u32> chunk_visible) {
+      return selected.cull_spheres(f, spheres, begin, end, chunk_visible);
+    });
+  }
+
+  usize cull_boxes(const frustum& f, const box_array& boxes, const std::span<u32> visible) {
+    OBERON_TRACE_ZONE("cull boxes");
+    auto count = std::size(boxes.min_x);
+    OBERON_PRECONDITION(std::size(boxes.min_y) == count && std::size(boxes.min_z) == count);
+    OBERON_PRECONDITION(std::size(boxes.max_x) == count && std::size(boxes.max_y) == count);
+    OBERON_PRECONDITION(std::size(boxes.max_z) == count);
+    const auto& selected = kernels();
+    return cull_in_chunks(count, visible, [&](const usize begin, const usize end, const ptr<u32> chunk_visible) {
+      return selected.cull_boxes(f, boxes, begin, end, chunk_visible);
+    });
+  }
+
+}
+
+#undef OBERON_TARGET_SSE4
+#undef OBERON_TARGET_AVX2
+#undef OBERON_CULLING_X86
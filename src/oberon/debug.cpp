@@ -7,20 +7,30 @@
 
 #include <string>
 
+#include "oberon/log.hpp"
+
 namespace oberon {
-  void assert(const std::source_location& location, const bool condition, const std::string_view& message_format, ...) {
+  void assert(const std::source_location& location, const bool condition, const std::string_view message_format, ...) {
     if (!condition)
     {
       std::va_list args; // This is a special weirdo declaration.
+      va_start(args, message_format);
+      std::va_list size_args;
+      va_copy(size_args, args);
       // Calculate and allocate space for message.
-      auto sz = std::vsnprintf(nullptr, 0, std::data(message_format), args);
-      auto message = std::string(sz, '\0');
+      auto sz = std::vsnprintf(nullptr, 0, std::data(message_format), size_args);
+      va_end(size_args);
+      auto message = std::string(sz + 1, '\0');
       std::vsnprintf(std::data(message), std::size(message), std::data(message_format), args);
-      std::fprintf(
-        stderr,
-        "%s:%" PRIu32 ": Assertion failed \"%s\"\n",
+      va_end(args);
+      message.resize(sz);
+      log_message(
+        log_severity::fatal,
+        "%s:%" PRIu32 ": Assertion failed \"%s\"",
         location.file_name(), location.line(), std::data(message)
       );
+      // The process is about to abort so the message has to reach the sinks now.
+      flush_log();
       std::abort();
     }
   }
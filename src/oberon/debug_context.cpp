@@ -1,23 +1,34 @@
 #include "oberon/detail/debug_context_impl.hpp"
 
-#include <cstdio>
 #include <cstring>
+#include <cinttypes>
 
+#include <array>
+#include <span>
 #include <vector>
 #include <algorithm>
 #include <iterator>
+#include <new>
+#include <tuple>
 
 #include "oberon/errors.hpp"
+#include "oberon/log.hpp"
+#include "oberon/trace.hpp"
+
+#include "oberon/detail/vulkan_call_tracing.hpp"
 
 namespace {
 
+  // This is called on whichever thread made the offending Vulkan call. It only counts the message and, if it isn't
+  // being rate limited, formats it into the log ring.
   static VKAPI_ATTR VkBool32 VKAPI_CALL vkDebugLog(
-    VkDebugUtilsMessageSeverityFlagBitsEXT /* messageSeverity */,
-    VkDebugUtilsMessageTypeFlagsEXT /* messageTypes */,
+    VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
+    VkDebugUtilsMessageTypeFlagsEXT messageTypes,
     const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData,
-    void* /* pUserData */
+    void* pUserData
   ) {
-    std::printf("[%s]: %s\n", pCallbackData->pMessageIdName, pCallbackData->pMessage);
+    auto& table = *static_cast<oberon::ptr<oberon::detail::validation_message_table>>(pUserData);
+    oberon::detail::record_validation_message(table, messageSeverity, messageTypes, *pCallbackData);
     return VK_FALSE;
   }
 
@@ -56,33 +67,85 @@ namespace detail {
 
 namespace {
 
-  const auto enabled_validation_features = std::array<VkValidationFeatureEnableEXT, 3>{
-    VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT,
-    VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT,
+  constexpr VkDebugUtilsMessageSeverityFlagsEXT ALL_MESSAGE_SEVERITIES{
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT
+  };
+
+  constexpr VkDebugUtilsMessageSeverityFlagsEXT PROBLEM_MESSAGE_SEVERITIES{
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT
+  };
+
+  constexpr VkDebugUtilsMessageTypeFlagsEXT ALL_MESSAGE_TYPES{
+    VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+  };
+
+  constexpr VkDebugUtilsMessageTypeFlagsEXT CORRECTNESS_MESSAGE_TYPES{
+    VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+    VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT
+  };
+
+  const auto minimal_disabled_features = std::array<VkValidationFeatureDisableEXT, 4>{
+    VK_VALIDATION_FEATURE_DISABLE_THREAD_SAFETY_EXT,
+    VK_VALIDATION_FEATURE_DISABLE_OBJECT_LIFETIMES_EXT,
+    VK_VALIDATION_FEATURE_DISABLE_SHADERS_EXT,
+    VK_VALIDATION_FEATURE_DISABLE_UNIQUE_HANDLES_EXT
+  };
+
+  const auto synchronization_enabled_features = std::array<VkValidationFeatureEnableEXT, 1>{
     VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT
   };
 
+  const auto best_practices_enabled_features = std::array<VkValidationFeatureEnableEXT, 1>{
+    VK_VALIDATION_FEATURE_ENABLE_BEST_PRACTICES_EXT
+  };
+
+  const auto gpu_assisted_enabled_features = std::array<VkValidationFeatureEnableEXT, 2>{
+    VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_EXT,
+    VK_VALIDATION_FEATURE_ENABLE_GPU_ASSISTED_RESERVE_BINDING_SLOT_EXT
+  };
+
+  struct validation_profile_config final {
+    std::span<const VkValidationFeatureEnableEXT> enabled_features{ };
+    std::span<const VkValidationFeatureDisableEXT> disabled_features{ };
+    VkDebugUtilsMessageSeverityFlagsEXT message_severities{ };
+    VkDebugUtilsMessageTypeFlagsEXT message_types{ };
+  };
+
+  // Indexed by validation_profile.
+  const auto validation_profile_configs = std::array<validation_profile_config, 5>{
+    validation_profile_config{ { }, minimal_disabled_features, PROBLEM_MESSAGE_SEVERITIES, CORRECTNESS_MESSAGE_TYPES },
+    validation_profile_config{ { }, { }, ALL_MESSAGE_SEVERITIES, ALL_MESSAGE_TYPES },
+    validation_profile_config{ synchronization_enabled_features, { }, ALL_MESSAGE_SEVERITIES, ALL_MESSAGE_TYPES },
+    validation_profile_config{ best_practices_enabled_features, { }, ALL_MESSAGE_SEVERITIES, ALL_MESSAGE_TYPES },
+    validation_profile_config{ gpu_assisted_enabled_features, { }, ALL_MESSAGE_SEVERITIES, ALL_MESSAGE_TYPES }
+  };
+
 }
 
   iresult preload_debugging_context(
-    const debug_context_impl& ctx,
+    debug_context_impl& ctx,
     VkDebugUtilsMessengerCreateInfoEXT& debug_info,
     VkValidationFeaturesEXT& validation_features
   ) noexcept {
+    const auto& config = validation_profile_configs[static_cast<usize>(ctx.profile)];
     OBERON_INIT_VK_STRUCT(debug_info, DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT);
-    debug_info.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-                             VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT |
-                             VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
-    debug_info.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-                                 VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    debug_info.messageType = config.message_types;
+    debug_info.messageSeverity = config.message_severities;
     debug_info.pfnUserCallback = vkDebugLog;
+    debug_info.pUserData = &ctx.validation_messages;
     if (ctx.instance_extensions.contains(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME))
     {
       OBERON_INIT_VK_STRUCT(validation_features, VALIDATION_FEATURES_EXT);
-      validation_features.pEnabledValidationFeatures = std::data(enabled_validation_features);
-      validation_features.enabledValidationFeatureCount = std::size(enabled_validation_features);
+      validation_features.pEnabledValidationFeatures = std::data(config.enabled_features);
+      validation_features.enabledValidationFeatureCount = std::size(config.enabled_features);
+      validation_features.pDisabledValidationFeatures = std::data(config.disabled_features);
+      validation_features.disabledValidationFeatureCount = std::size(config.disabled_features);
       validation_features.pNext = &debug_info;
     }
     return 0;
@@ -96,7 +159,7 @@ namespace {
     OBERON_PRECONDITION(!ctx.debug_messenger);
     OBERON_PRECONDITION(ctx.vkft.vkCreateDebugUtilsMessengerEXT);
     auto vkCreateDebugUtilsMessengerEXT = ctx.vkft.vkCreateDebugUtilsMessengerEXT;
-    auto result = vkCreateDebugUtilsMessengerEXT(ctx.instance, &debug_info, nullptr, &ctx.debug_messenger);
+    auto result = vkCreateDebugUtilsMessengerEXT(ctx.instance, &debug_info, ctx.host_allocator, &ctx.debug_messenger);
     if (result != VK_SUCCESS)
     {
       return result;
@@ -120,13 +183,155 @@ namespace {
     return 0;
   }
 
+namespace {
+
+  constexpr log_severity to_log_severity(const VkDebugUtilsMessageSeverityFlagBitsEXT severity) noexcept {
+    switch (severity)
+    {
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
+      return log_severity::error;
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
+      return log_severity::warning;
+    case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
+      return log_severity::info;
+    default:
+      return log_severity::debug;
+    }
+  }
+
+}
+
+  usize validation_message_key_hash::operator()(const validation_message_key& key) const noexcept {
+    auto id_hash = std::hash<i32>{ }(key.id);
+    return id_hash ^ (std::hash<u64>{ }(key.object_handle) + 0x9e37'79b9 + (id_hash << 6) + (id_hash >> 2));
+  }
+
+  iresult record_validation_message(
+    validation_message_table& table,
+    const VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    const VkDebugUtilsMessageTypeFlagsEXT types,
+    const VkDebugUtilsMessengerCallbackDataEXT& data
+  ) noexcept {
+    auto log_level = to_log_severity(severity);
+    auto name = data.pMessageIdName ? data.pMessageIdName : "";
+    // Loader and library messages aren't repetitive so they bypass aggregation.
+    if (!(types & (VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT)))
+    {
+      if (!is_log_enabled(log_level))
+      {
+        return 0;
+      }
+      log_message(log_level, "[%s]: %s", name, data.pMessage);
+      return 1;
+    }
+    auto key = validation_message_key{ data.messageIdNumber, data.objectCount ? data.pObjects[0].objectHandle : 0 };
+    auto now = std::chrono::steady_clock::now();
+    auto limit = table.report_limit.load(std::memory_order_relaxed);
+    auto lock = std::lock_guard{ table.mutex };
+    auto cur = std::end(table.counters);
+    try
+    {
+      auto is_new = false;
+      std::tie(cur, is_new) = table.counters.try_emplace(key);
+      if (is_new)
+      {
+        cur->second.severity = log_level;
+        cur->second.last_report = now;
+        cur->second.name = name;
+      }
+    }
+    catch (const std::bad_alloc&)
+    {
+      // A counter that was inserted but never named can't be reported. Erasing it doesn't allocate.
+      if (cur != std::end(table.counters) && !cur->second.count)
+      {
+        table.counters.erase(cur);
+      }
+      // Terminating inside the messenger callback would lose the message. Log it without aggregation instead.
+      if (!is_log_enabled(log_level))
+      {
+        return 0;
+      }
+      log_message(log_level, "[%s]: %s", name, data.pMessage);
+      return 1;
+    }
+    auto& counter = cur->second;
+    ++counter.count;
+    ++counter.unreported_count;
+    if (!is_log_enabled(log_level))
+    {
+      return 0;
+    }
+    if (counter.count <= limit)
+    {
+      auto suffix = counter.count == limit ? " (further occurrences will be summarized)" : "";
+      log_message(log_level, "[%s]: %s%s", name, data.pMessage, suffix);
+      counter.unreported_count = 0;
+      counter.last_report = now;
+      return 1;
+    }
+    if (now - counter.last_report >= VALIDATION_SUMMARY_PERIOD)
+    {
+      auto seconds = std::chrono::duration_cast<std::chrono::seconds>(now - counter.last_report);
+      log_message(log_level, "[%s]: repeated %" PRIu64 " times in the last %" PRIi64 "s (%" PRIu64 " total)", name,
+                  counter.unreported_count, static_cast<i64>(seconds.count()), counter.count);
+      counter.unreported_count = 0;
+      counter.last_report = now;
+      return 1;
+    }
+    return 0;
+  }
+
+  iresult read_validation_message_statistics(
+    const validation_message_table& table,
+    std::vector<validation_message_statistics>& statistics
+  ) {
+    {
+      auto lock = std::lock_guard{ table.mutex };
+      statistics.clear();
+      statistics.reserve(std::size(table.counters));
+      for (const auto& [key, counter] : table.counters)
+      {
+        statistics.push_back({ counter.name, key.id, key.object_handle, counter.severity, counter.count });
+      }
+    }
+    std::sort(std::begin(statistics), std::end(statistics), [](const auto& lhs, const auto& rhs) {
+      return lhs.count > rhs.count;
+    });
+    return 0;
+  }
+
+  iresult dump_validation_messages(const validation_message_table& table) noexcept {
+    auto statistics = std::vector<validation_message_statistics>{ };
+    try
+    {
+      read_validation_message_statistics(table, statistics);
+    }
+    catch (const std::bad_alloc&)
+    {
+      OBERON_LOG(error, "Failed to allocate validation message statistics.");
+      return -1;
+    }
+    if (std::empty(statistics))
+    {
+      return 0;
+    }
+    OBERON_LOG(info, "%zu distinct validation messages were received:", std::size(statistics));
+    for (const auto& message : statistics)
+    {
+      OBERON_LOG(info, "  %10" PRIu64 " [%s] (0x%08" PRIx32 ") object 0x%" PRIx64, message.count,
+                 std::data(message.name), static_cast<u32>(message.id), message.object_handle);
+    }
+    return 0;
+  }
+
   iresult destroy_debug_messenger(debug_context_impl& ctx) noexcept {
     OBERON_PRECONDITION(ctx.instance);
     if (ctx.debug_messenger)
     {
       OBERON_ASSERT(ctx.vkft.vkDestroyDebugUtilsMessengerEXT);
       auto vkDestroyDebugUtilsMessengerEXT = ctx.vkft.vkDestroyDebugUtilsMessengerEXT;
-      vkDestroyDebugUtilsMessengerEXT(ctx.instance, ctx.debug_messenger, nullptr);
+      vkDestroyDebugUtilsMessengerEXT(ctx.instance, ctx.debug_messenger, ctx.host_allocator);
       ctx.debug_messenger = nullptr;
     }
     OBERON_POSTCONDITION(!ctx.debug_messenger);
@@ -140,14 +345,57 @@ namespace {
     const u16 application_version_minor,
     const u16 application_version_patch,
     const std::unordered_set<std::string>& requested_layers
+  ) : debug_context{
+    application_name,
+    application_version_major, application_version_minor, application_version_patch,
+    requested_layers,
+    CONTEXT_NONE_BIT
+  } { }
+
+  debug_context::debug_context(
+    const std::string& application_name,
+    const u16 application_version_major,
+    const u16 application_version_minor,
+    const u16 application_version_patch,
+    const std::unordered_set<std::string>& requested_layers,
+    const u32 flags
+  ) : debug_context{
+    application_name,
+    application_version_major, application_version_minor, application_version_patch,
+    requested_layers,
+    flags,
+    validation_profile::standard
+  } { }
+
+  debug_context::debug_context(
+    const std::string& application_name,
+    const u16 application_version_major,
+    const u16 application_version_minor,
+    const u16 application_version_patch,
+    const std::unordered_set<std::string>& requested_layers,
+    const u32 flags,
+    const validation_profile profile
   ) : context{ new detail::debug_context_impl{ } } {
     auto& q = reference_cast<detail::debug_context_impl>(implementation());
+    q.profile = profile;
     detail::store_application_info(
       q,
       application_name,
       application_version_major, application_version_minor, application_version_patch
     );
-    detail::connect_to_x11(q, nullptr);
+    if (flags & CONTEXT_HOST_ALLOCATION_TRACKING_BIT)
+    {
+      detail::initialize_host_allocator(q.host_allocations);
+      q.host_allocator = &q.host_allocations.callbacks;
+    }
+    if (OBERON_IS_IERROR(detail::connect_to_x11(q, nullptr)))
+    {
+      throw fatal_error{ "Failed to connect to X11 server." };
+    }
+    if (OBERON_IS_IERROR(detail::cache_x11_server_info(q)))
+    {
+      throw fatal_error{ "Failed to retrieve X11 server information." };
+    }
     detail::load_vulkan_pfns(q.vkft);
     if (OBERON_IS_IERROR(detail::validate_requested_layers(q, requested_layers)))
     {
@@ -188,13 +436,24 @@ namespace {
       }
     }
     detail::load_vulkan_pfns(q.vkft, q.instance);
+    q.has_debug_utils = q.instance_extensions.contains(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
     if (OBERON_IS_IERROR(detail::create_debug_messenger(q, debug_info)))
     {
       throw fatal_error{ "Failed to create Vulkan debug messenger." };
     }
     {
       auto required_extensions = std::unordered_set<std::string>{ VK_KHR_SWAPCHAIN_EXTENSION_NAME };
-      if (OBERON_IS_IERROR(detail::select_physical_device(q, required_extensions, { })))
+      auto optional_extensions = std::unordered_set<std::string>{
+        VK_KHR_PRESENT_ID_EXTENSION_NAME,
+        VK_KHR_PRESENT_WAIT_EXTENSION_NAME,
+        VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME
+      };
+      // Only frame timestamps use calibrated timestamps.
+      if constexpr (IS_TRACING_ENABLED)
+      {
+        optional_extensions.insert(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+      }
+      if (OBERON_IS_IERROR(detail::select_physical_device(q, required_extensions, optional_extensions)))
       {
         throw fatal_error{ "None of the Vulkan physical devices available can be used." };
       }
@@ -205,19 +464,55 @@ namespace {
       }
     }
     detail::load_vulkan_pfns(q.vkft, q.device);
+    if ((flags & CONTEXT_VULKAN_CALL_TRACING_BIT) && OBERON_IS_IERROR(detail::install_vulkan_call_tracing(q.vkft)))
+    {
+      throw fatal_error{ "Vulkan call tracing is already enabled by another context." };
+    }
+    q.is_tracing_vulkan_calls = flags & CONTEXT_VULKAN_CALL_TRACING_BIT;
     detail::get_device_queues(q);
   }
 
   void debug_context::v_dispose() noexcept {
     auto& q = reference_cast<detail::debug_context_impl>(implementation());
     detail::destroy_vulkan_device(q);
+    if (q.is_tracing_vulkan_calls)
+    {
+      detail::uninstall_vulkan_call_tracing();
+      q.is_tracing_vulkan_calls = false;
+    }
     detail::destroy_debug_messenger(q);
     detail::destroy_vulkan_instance(q);
     detail::disconnect_from_x11(q);
+    detail::dump_validation_messages(q.validation_messages);
   }
 
   debug_context::~debug_context() noexcept {
     dispose();
   }
 
+  validation_profile debug_context::current_validation_profile() const {
+    auto& q = reference_cast<detail::debug_context_impl>(implementation());
+    return q.profile;
+  }
+
+  std::vector<validation_message_statistics> debug_context::query_validation_messages() const {
+    auto& q = reference_cast<detail::debug_context_impl>(implementation());
+    auto statistics = std::vector<validation_message_statistics>{ };
+    detail::read_validation_message_statistics(q.validation_messages, statistics);
+    return statistics;
+  }
+
+  debug_context& debug_context::reset_validation_messages() {
+    auto& q = reference_cast<detail::debug_context_impl>(implementation());
+    auto lock = std::lock_guard{ q.validation_messages.mutex };
+    q.validation_messages.counters.clear();
+    return *this;
+  }
+
+  debug_context& debug_context::set_validation_message_limit(const u32 limit) {
+    auto& q = reference_cast<detail::debug_context_impl>(implementation());
+    q.validation_messages.report_limit = limit;
+    return *this;
+  }
+
 }
@@ -0,0 +1,110 @@
+#include "oberon/detail/builtin_shaders.hpp"
+
+#include <array>
+
+#define OBERON_BUILTIN_SHADER(name, value) \
+  case builtin_shader_name::name: \
+    return get_builtin_shader_stages<builtin_shader_name::name>();
+
+#define OBERON_BUILTIN_SHADER_VARIANT(shader, name, ...) \
+  constexpr builtin_specialization_value shader##_##name##_values[]{ __VA_ARGS__ }; \
+  constexpr auto shader##_##name##_map_entries = make_specialization_map_entries(shader##_##name##_values);
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  // Override values are read in place from the builtin_specialization_value array so the map entries step over the
+  // constant IDs.
+  template <usize Size>
+  constexpr std::array<VkSpecializationMapEntry, Size>
+  make_specialization_map_entries(const builtin_specialization_value (&values)[Size]) noexcept {
+    auto entries = std::array<VkSpecializationMapEntry, Size>{ };
+    for (auto i = usize{ 0 }; i < Size; ++i)
+    {
+      entries[i].constantID = values[i].constant_id;
+      entries[i].offset = i * sizeof(builtin_specialization_value) + sizeof(u32);
+      entries[i].size = sizeof(u32);
+    }
+    return entries;
+  }
+
+  static_assert(sizeof(builtin_specialization_value) == 2 * sizeof(u32));
+
+  OBERON_BUILTIN_SHADER_VARIANTS
+
+#undef OBERON_BUILTIN_SHADER_VARIANT
+#define OBERON_BUILTIN_SHADER_VARIANT(shader, name, ...) \
+  builtin_shader_variant_info{ \
+    builtin_shader_name::shader, \
+    shader##_##name##_values, \
+    VkSpecializationInfo{ \
+      static_cast<u32>(std::size(shader##_##name##_map_entries)), \
+      std::data(shader##_##name##_map_entries), \
+      sizeof(shader##_##name##_values), \
+      shader##_##name##_values \
+    } \
+  },
+
+  constexpr std::array<builtin_shader_variant_info, BUILTIN_SHADER_VARIANT_COUNT> BUILTIN_SHADER_VARIANT_INFO{
+    OBERON_BUILTIN_SHADER_VARIANTS
+  };
+
+  constexpr builtin_shader_layout EMPTY_SHADER_LAYOUT{ };
+  constexpr builtin_pipeline_description EMPTY_PIPELINE_DESCRIPTION{ };
+
+}
+
+  std::span<const builtin_shader_stage> get_builtin_shader_stages(const builtin_shader_name name) noexcept {
+    switch (name)
+    {
+    OBERON_BUILTIN_SHADERS
+    default:
+      return { };
+    }
+  }
+
+#undef OBERON_BUILTIN_SHADER
+#define OBERON_BUILTIN_SHADER(name, value) \
+  case builtin_shader_name::name: \
+    return get_builtin_shader_layout<builtin_shader_name::name>();
+
+  const builtin_shader_layout& get_builtin_shader_layout(const builtin_shader_name name) noexcept {
+    switch (name)
+    {
+    OBERON_BUILTIN_SHADERS
+    default:
+      return EMPTY_SHADER_LAYOUT;
+    }
+  }
+
+#undef OBERON_BUILTIN_SHADER
+#define OBERON_BUILTIN_SHADER(name, value) \
+  case builtin_shader_name::name: \
+    return get_builtin_pipeline_description<builtin_shader_name::name>();
+
+  const builtin_pipeline_description& get_builtin_pipeline_description(const builtin_shader_name name) noexcept {
+    switch (name)
+    {
+    OBERON_BUILTIN_SHADERS
+    default:
+      return EMPTY_PIPELINE_DESCRIPTION;
+    }
+  }
+
+  bool is_builtin_compute_shader(const builtin_shader_name name) noexcept {
+    auto stages = get_builtin_shader_stages(name);
+    return std::size(stages) == 1 && stages.front().stage == VK_SHADER_STAGE_COMPUTE_BIT;
+  }
+
+  const builtin_shader_variant_info& get_builtin_shader_variant_info(const builtin_shader_variant variant) noexcept {
+    OBERON_PRECONDITION(static_cast<usize>(variant) < BUILTIN_SHADER_VARIANT_COUNT);
+    return BUILTIN_SHADER_VARIANT_INFO[static_cast<usize>(variant)];
+  }
+
+}
+}
+
+#undef OBERON_BUILTIN_SHADER
+#undef OBERON_BUILTIN_SHADER_VARIANT
@@ -0,0 +1,69 @@
+#include "oberon/detail/debug_labels.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <cstdarg>
+
+#include <array>
+
+#include "oberon/debug.hpp"
+
+#include "oberon/detail/context_impl.hpp"
+
+namespace oberon {
+namespace detail {
+
+  iresult name_vulkan_object(
+    const context_impl& ctx,
+    const VkObjectType type,
+    const u64 handle,
+    const cstring format,
+    ...
+  ) noexcept {
+    if (!ctx.has_debug_utils || !handle)
+    {
+      return 0;
+    }
+    OBERON_PRECONDITION(ctx.vkft.vkSetDebugUtilsObjectNameEXT);
+    auto vkSetDebugUtilsObjectNameEXT = ctx.vkft.vkSetDebugUtilsObjectNameEXT;
+    auto name = std::array<char, 128>{ };
+    std::va_list args;
+    va_start(args, format);
+    std::vsnprintf(std::data(name), std::size(name), format, args);
+    va_end(args);
+    auto name_info = VkDebugUtilsObjectNameInfoEXT{ };
+    OBERON_INIT_VK_STRUCT(name_info, DEBUG_UTILS_OBJECT_NAME_INFO_EXT);
+    name_info.objectType = type;
+    name_info.objectHandle = handle;
+    name_info.pObjectName = std::data(name);
+    vkSetDebugUtilsObjectNameEXT(ctx.device, &name_info);
+    return 0;
+  }
+
+  iresult begin_vulkan_label(const context_impl& ctx, const VkCommandBuffer command_buffer, const cstring name) noexcept {
+    if (!ctx.has_debug_utils)
+    {
+      return 0;
+    }
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBeginDebugUtilsLabelEXT);
+    auto vkCmdBeginDebugUtilsLabelEXT = ctx.vkft.vkCmdBeginDebugUtilsLabelEXT;
+    auto label = VkDebugUtilsLabelEXT{ };
+    OBERON_INIT_VK_STRUCT(label, DEBUG_UTILS_LABEL_EXT);
+    label.pLabelName = name;
+    vkCmdBeginDebugUtilsLabelEXT(command_buffer, &label);
+    return 0;
+  }
+
+  iresult end_vulkan_label(const context_impl& ctx, const VkCommandBuffer command_buffer) noexcept {
+    if (!ctx.has_debug_utils)
+    {
+      return 0;
+    }
+    OBERON_PRECONDITION(ctx.vkft.vkCmdEndDebugUtilsLabelEXT);
+    auto vkCmdEndDebugUtilsLabelEXT = ctx.vkft.vkCmdEndDebugUtilsLabelEXT;
+    vkCmdEndDebugUtilsLabelEXT(command_buffer);
+    return 0;
+  }
+
+}
+}
@@ -0,0 +1,309 @@
+#include "oberon/detail/host_allocator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+#include <mutex>
+#include <algorithm>
+
+#include "oberon/debug.hpp"
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  constexpr usize POOL_CHUNK_SIZE{ 64 * 1024 };
+  constexpr u32 UNPOOLED_SIZE_CLASS{ -1U };
+
+  struct alignas(HOST_ALLOCATION_MIN_ALIGNMENT) allocation_header final {
+    // The pointer returned by the system allocator. Null for pooled blocks.
+    ptr<void> base{ };
+    usize size{ };
+    u32 size_class{ UNPOOLED_SIZE_CLASS };
+    u32 scope{ };
+  };
+
+  static_assert(sizeof(allocation_header) % HOST_ALLOCATION_MIN_ALIGNMENT == 0);
+
+  struct free_block final {
+    ptr<free_block> next{ };
+  };
+
+  using free_lists = std::array<ptr<free_block>, std::size(HOST_ALLOCATION_SIZE_CLASSES)>;
+
+  // Blocks outlive the threads that carved them because any thread may free them. Chunks are only released when the
+  // process exits and the free lists of exiting threads are handed back here.
+  struct shared_pool final {
+    std::mutex mutex{ };
+    std::vector<ptr<void>> chunks{ };
+    free_lists blocks{ };
+
+    ~shared_pool() noexcept {
+      for (auto chunk : chunks)
+      {
+        std::free(chunk);
+      }
+    }
+  };
+
+  shared_pool& get_shared_pool() noexcept {
+    static auto pool = shared_pool{ };
+    return pool;
+  }
+
+  constexpr usize block_size(const usize size_class) noexcept {
+    return sizeof(allocation_header) + HOST_ALLOCATION_SIZE_CLASSES[size_class];
+  }
+
+  class thread_pool final {
+  private:
+    free_lists m_blocks{ };
+
+    // Take the shared blocks of a size class or carve a new chunk into blocks.
+    bool refill(const usize size_class) noexcept {
+      auto& shared = get_shared_pool();
+      auto lock = std::lock_guard{ shared.mutex };
+      if (shared.blocks[size_class])
+      {
+        m_blocks[size_class] = shared.blocks[size_class];
+        shared.blocks[size_class] = nullptr;
+        return true;
+      }
+      auto chunk = static_cast<ptr<char>>(std::malloc(POOL_CHUNK_SIZE));
+      if (!chunk)
+      {
+        return false;
+      }
+      shared.chunks.push_back(chunk);
+      const auto stride = block_size(size_class);
+      for (auto offset = usize{ 0 }; offset + stride <= POOL_CHUNK_SIZE; offset += stride)
+      {
+        auto block = reinterpret_cast<ptr<free_block>>(chunk + offset);
+        block->next = m_blocks[size_class];
+        m_blocks[size_class] = block;
+      }
+      return true;
+    }
+  public:
+    ~thread_pool() noexcept {
+      auto& shared = get_shared_pool();
+      auto lock = std::lock_guard{ shared.mutex };
+      for (auto i = usize{ 0 }; i < std::size(m_blocks); ++i)
+      {
+        while (m_blocks[i])
+        {
+          auto block = m_blocks[i];
+          m_blocks[i] = block->next;
+          block->next = shared.blocks[i];
+          shared.blocks[i] = block;
+        }
+      }
+    }
+
+    ptr<void> pop(const usize size_class) noexcept {
+      if (!m_blocks[size_class] && !refill(size_class))
+      {
+        return nullptr;
+      }
+      auto block = m_blocks[size_class];
+      m_blocks[size_class] = block->next;
+      return block;
+    }
+
+    void push(const usize size_class, const ptr<void> memory) noexcept {
+      auto block = static_cast<ptr<free_block>>(memory);
+      block->next = m_blocks[size_class];
+      m_blocks[size_class] = block;
+    }
+  };
+
+  thread_pool& get_thread_pool() noexcept {
+    // Constructing the shared pool first guarantees that it's destroyed after every thread pool.
+    get_shared_pool();
+    thread_local auto pool = thread_pool{ };
+    return pool;
+  }
+
+  bool is_pooled_scope(const VkSystemAllocationScope scope) noexcept {
+    return scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND || scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+  }
+
+  ptr<allocation_header> header_of(const ptr<void> memory) noexcept {
+    return static_cast<ptr<allocation_header>>(memory) - 1;
+  }
+
+  void count_allocation(host_allocation_counters& counters, const usize size) noexcept {
+    counters.allocation_count.fetch_add(1, std::memory_order_relaxed);
+    auto current = counters.current_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    auto peak = counters.peak_bytes.load(std::memory_order_relaxed);
+    while (current > peak && !counters.peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) { }
+  }
+
+  ptr<void> allocate(
+    host_allocation_tracker& allocator,
+    const usize size,
+    const usize alignment,
+    const VkSystemAllocationScope scope
+  ) noexcept {
+    if (!size)
+    {
+      return nullptr;
+    }
+    auto memory = ptr<void>{ };
+    auto header = allocation_header{ nullptr, size, UNPOOLED_SIZE_CLASS, static_cast<u32>(scope) };
+    auto& counters = allocator.counters[scope];
+    auto size_class = std::lower_bound(std::begin(HOST_ALLOCATION_SIZE_CLASSES), std::end(HOST_ALLOCATION_SIZE_CLASSES),
+                                       size);
+    if (is_pooled_scope(scope) && alignment <= HOST_ALLOCATION_MIN_ALIGNMENT &&
+        size_class != std::end(HOST_ALLOCATION_SIZE_CLASSES))
+    {
+      header.size_class = size_class - std::begin(HOST_ALLOCATION_SIZE_CLASSES);
+      auto block = get_thread_pool().pop(header.size_class);
+      if (!block)
+      {
+        return nullptr;
+      }
+      memory = static_cast<ptr<allocation_header>>(block) + 1;
+      counters.pooled_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    else
+    {
+      // Over allocate so that the payload can be aligned with the header immediately before it.
+      auto payload_alignment = std::max(alignment, HOST_ALLOCATION_MIN_ALIGNMENT);
+      header.base = std::malloc(sizeof(allocation_header) + payload_alignment + size);
+      if (!header.base)
+      {
+        return nullptr;
+      }
+      auto address = reinterpret_cast<uptr>(header.base) + sizeof(allocation_header);
+      address = (address + payload_alignment - 1) & ~(payload_alignment - 1);
+      memory = reinterpret_cast<ptr<void>>(address);
+    }
+    *header_of(memory) = header;
+    count_allocation(counters, size);
+    return memory;
+  }
+
+  void deallocate(host_allocation_tracker& allocator, const ptr<void> memory) noexcept {
+    if (!memory)
+    {
+      return;
+    }
+    auto header = *header_of(memory);
+    auto& counters = allocator.counters[header.scope];
+    counters.free_count.fetch_add(1, std::memory_order_relaxed);
+    counters.current_bytes.fetch_sub(header.size, std::memory_order_relaxed);
+    if (header.size_class == UNPOOLED_SIZE_CLASS)
+    {
+      std::free(header.base);
+      return;
+    }
+    get_thread_pool().push(header.size_class, header_of(memory));
+  }
+
+  VKAPI_ATTR void* VKAPI_CALL allocation_callback(
+    void* pUserData,
+    size_t size,
+    size_t alignment,
+    VkSystemAllocationScope allocationScope
+  ) {
+    return allocate(*static_cast<ptr<host_allocation_tracker>>(pUserData), size, alignment, allocationScope);
+  }
+
+  VKAPI_ATTR void* VKAPI_CALL reallocation_callback(
+    void* pUserData,
+    void* pOriginal,
+    size_t size,
+    size_t alignment,
+    VkSystemAllocationScope allocationScope
+  ) {
+    auto& allocator = *static_cast<ptr<host_allocation_tracker>>(pUserData);
+    if (!pOriginal)
+    {
+      return allocate(allocator, size, alignment, allocationScope);
+    }
+    if (!size)
+    {
+      deallocate(allocator, pOriginal);
+      return nullptr;
+    }
+    auto memory = allocate(allocator, size, alignment, allocationScope);
+    if (!memory)
+    {
+      // The original allocation must remain valid when reallocation fails.
+      return nullptr;
+    }
+    std::memcpy(memory, pOriginal, std::min(size, header_of(pOriginal)->size));
+    deallocate(allocator, pOriginal);
+    allocator.counters[allocationScope].reallocation_count.fetch_add(1, std::memory_order_relaxed);
+    return memory;
+  }
+
+  VKAPI_ATTR void VKAPI_CALL free_callback(void* pUserData, void* pMemory) {
+    deallocate(*static_cast<ptr<host_allocation_tracker>>(pUserData), pMemory);
+  }
+
+  VKAPI_ATTR void VKAPI_CALL internal_allocation_callback(
+    void* pUserData,
+    size_t size,
+    VkInternalAllocationType /* allocationType */,
+    VkSystemAllocationScope allocationScope
+  ) {
+    auto& allocator = *static_cast<ptr<host_allocation_tracker>>(pUserData);
+    allocator.counters[allocationScope].internal_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+
+  VKAPI_ATTR void VKAPI_CALL internal_free_callback(
+    void* pUserData,
+    size_t size,
+    VkInternalAllocationType /* allocationType */,
+    VkSystemAllocationScope allocationScope
+  ) {
+    auto& allocator = *static_cast<ptr<host_allocation_tracker>>(pUserData);
+    allocator.counters[allocationScope].internal_bytes.fetch_sub(size, std::memory_order_relaxed);
+  }
+
+}
+
+  iresult initialize_host_allocator(host_allocation_tracker& allocator) noexcept {
+    allocator.callbacks.pUserData = &allocator;
+    allocator.callbacks.pfnAllocation = allocation_callback;
+    allocator.callbacks.pfnReallocation = reallocation_callback;
+    allocator.callbacks.pfnFree = free_callback;
+    allocator.callbacks.pfnInternalAllocation = internal_allocation_callback;
+    allocator.callbacks.pfnInternalFree = internal_free_callback;
+    return 0;
+  }
+
+  iresult read_host_allocation_statistics(const host_allocation_tracker& allocator,
+                                          host_allocation_statistics& statistics) noexcept {
+    for (auto cur = std::begin(allocator.counters); auto& scope : statistics.scopes)
+    {
+      const auto& counters = *(cur++);
+      scope.allocation_count = counters.allocation_count.load(std::memory_order_relaxed);
+      scope.reallocation_count = counters.reallocation_count.load(std::memory_order_relaxed);
+      scope.free_count = counters.free_count.load(std::memory_order_relaxed);
+      scope.pooled_count = counters.pooled_count.load(std::memory_order_relaxed);
+      scope.current_bytes = counters.current_bytes.load(std::memory_order_relaxed);
+      scope.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+      scope.internal_bytes = counters.internal_bytes.load(std::memory_order_relaxed);
+    }
+    return 0;
+  }
+
+  iresult reset_host_allocation_counters(host_allocation_tracker& allocator) noexcept {
+    for (auto& counters : allocator.counters)
+    {
+      counters.allocation_count.store(0, std::memory_order_relaxed);
+      counters.reallocation_count.store(0, std::memory_order_relaxed);
+      counters.free_count.store(0, std::memory_order_relaxed);
+      counters.pooled_count.store(0, std::memory_order_relaxed);
+      counters.peak_bytes.store(counters.current_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return 0;
+  }
+
+}
+}
@@ -0,0 +1,538 @@
+#include "oberon/detail/resource_registry.hpp"
+
+#include <cstring>
+
+#include <algorithm>
+
+#include "oberon/debug.hpp"
+
+#include "oberon/detail/context_impl.hpp"
+#include "oberon/detail/debug_labels.hpp"
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  constexpr u32 NO_MEMORY_TYPE{ -1U };
+
+  u32 select_memory_type(
+    const context_impl& ctx,
+    const u32 type_bits,
+    const VkMemoryPropertyFlags properties
+  ) noexcept {
+    const auto& memory_properties = ctx.physical_device_memory_properties;
+    for (auto i = u32{ 0 }; i < memory_properties.memoryTypeCount; ++i)
+    {
+      auto type_properties = memory_properties.memoryTypes[i].propertyFlags;
+      if ((type_bits & (1 << i)) && (type_properties & properties) == properties)
+      {
+        return i;
+      }
+    }
+    return NO_MEMORY_TYPE;
+  }
+
+  iresult allocate_memory(
+    const context_impl& ctx,
+    const VkMemoryRequirements& requirements,
+    const VkMemoryPropertyFlags properties,
+    VkDeviceMemory& memory
+  ) noexcept {
+    auto vkAllocateMemory = ctx.vkft.vkAllocateMemory;
+    auto memory_type = select_memory_type(ctx, requirements.memoryTypeBits, properties);
+    if (memory_type == NO_MEMORY_TYPE)
+    {
+      return -1;
+    }
+    auto allocate_info = VkMemoryAllocateInfo{ };
+    OBERON_INIT_VK_STRUCT(allocate_info, MEMORY_ALLOCATE_INFO);
+    allocate_info.allocationSize = requirements.size;
+    allocate_info.memoryTypeIndex = memory_type;
+    auto result = vkAllocateMemory(ctx.device, &allocate_info, ctx.host_allocator, &memory);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    return 0;
+  }
+
+  constexpr VkBufferUsageFlags to_vulkan_buffer_usage(const u32 usage) noexcept {
+    auto result = VkBufferUsageFlags{ };
+    result |= usage & BUFFER_USAGE_VERTEX_BIT ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : 0;
+    result |= usage & BUFFER_USAGE_INDEX_BIT ? VK_BUFFER_USAGE_INDEX_BUFFER_BIT : 0;
+    result |= usage & BUFFER_USAGE_UNIFORM_BIT ? VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT : 0;
+    result |= usage & BUFFER_USAGE_STORAGE_BIT ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : 0;
+    result |= usage & BUFFER_USAGE_INDIRECT_BIT ? VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT : 0;
+    result |= usage & BUFFER_USAGE_TRANSFER_SOURCE_BIT ? VK_BUFFER_USAGE_TRANSFER_SRC_BIT : 0;
+    result |= usage & BUFFER_USAGE_TRANSFER_DESTINATION_BIT ? VK_BUFFER_USAGE_TRANSFER_DST_BIT : 0;
+    return result;
+  }
+
+  constexpr VkImageUsageFlags to_vulkan_image_usage(const u32 usage) noexcept {
+    auto result = VkImageUsageFlags{ };
+    result |= usage & IMAGE_USAGE_SAMPLED_BIT ? VK_IMAGE_USAGE_SAMPLED_BIT : 0;
+    result |= usage & IMAGE_USAGE_STORAGE_BIT ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+    result |= usage & IMAGE_USAGE_COLOR_ATTACHMENT_BIT ? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT : 0;
+    result |= usage & IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : 0;
+    result |= usage & IMAGE_USAGE_TRANSFER_SOURCE_BIT ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0;
+    result |= usage & IMAGE_USAGE_TRANSFER_DESTINATION_BIT ? VK_IMAGE_USAGE_TRANSFER_DST_BIT : 0;
+    return result;
+  }
+
+  constexpr VkFormat to_vulkan_format(const image_format format) noexcept {
+    switch (format)
+    {
+    case image_format::r8g8b8a8_srgb:
+      return VK_FORMAT_R8G8B8A8_SRGB;
+    case image_format::b8g8r8a8_srgb:
+      return VK_FORMAT_B8G8R8A8_SRGB;
+    case image_format::r16g16b16a16_sfloat:
+      return VK_FORMAT_R16G16B16A16_SFLOAT;
+    case image_format::r32_sfloat:
+      return VK_FORMAT_R32_SFLOAT;
+    case image_format::d32_sfloat:
+      return VK_FORMAT_D32_SFLOAT;
+    case image_format::d24_unorm_s8_uint:
+      return VK_FORMAT_D24_UNORM_S8_UINT;
+    default:
+      return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+  }
+
+  constexpr VkImageAspectFlags select_image_aspect(const image_format format) noexcept {
+    switch (format)
+    {
+    case image_format::d32_sfloat:
+      return VK_IMAGE_ASPECT_DEPTH_BIT;
+    case image_format::d24_unorm_s8_uint:
+      return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+    default:
+      return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+  }
+
+  constexpr VkFilter to_vulkan_filter(const sampler_filter filter) noexcept {
+    return filter == sampler_filter::linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+  }
+
+  constexpr VkSamplerAddressMode to_vulkan_address_mode(const sampler_address_mode mode) noexcept {
+    switch (mode)
+    {
+    case sampler_address_mode::mirrored_repeat:
+      return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+    case sampler_address_mode::clamp_to_edge:
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    case sampler_address_mode::clamp_to_border:
+      return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+    default:
+      return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    }
+  }
+
+  void destroy_retired_resource(const context_impl& ctx, const retired_resource& resource) noexcept {
+    auto vkDestroyBuffer = ctx.vkft.vkDestroyBuffer;
+    auto vkDestroyImageView = ctx.vkft.vkDestroyImageView;
+    auto vkDestroyImage = ctx.vkft.vkDestroyImage;
+    auto vkDestroySampler = ctx.vkft.vkDestroySampler;
+    auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
+    auto vkDestroyPipelineLayout = ctx.vkft.vkDestroyPipelineLayout;
+    auto vkFreeMemory = ctx.vkft.vkFreeMemory;
+    // Destroying VK_NULL_HANDLE is always a no-op.
+    vkDestroyBuffer(ctx.device, resource.buffer, ctx.host_allocator);
+    vkDestroyImageView(ctx.device, resource.image_view, ctx.host_allocator);
+    vkDestroyImage(ctx.device, resource.image, ctx.host_allocator);
+    vkDestroySampler(ctx.device, resource.sampler, ctx.host_allocator);
+    vkDestroyPipeline(ctx.device, resource.pipeline, ctx.host_allocator);
+    vkDestroyPipelineLayout(ctx.device, resource.pipeline_layout, ctx.host_allocator);
+    vkFreeMemory(ctx.device, resource.memory, ctx.host_allocator);
+  }
+
+}
+
+  iresult create_registry_buffer(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const usize size,
+    const u32 usage,
+    const memory_location location,
+    buffer_handle& buffer
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkGetBufferMemoryRequirements);
+    OBERON_PRECONDITION(ctx.vkft.vkAllocateMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkFreeMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkBindBufferMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkMapMemory);
+    OBERON_PRECONDITION(size > 0);
+    auto vkCreateBuffer = ctx.vkft.vkCreateBuffer;
+    auto vkDestroyBuffer = ctx.vkft.vkDestroyBuffer;
+    auto vkGetBufferMemoryRequirements = ctx.vkft.vkGetBufferMemoryRequirements;
+    auto vkFreeMemory = ctx.vkft.vkFreeMemory;
+    auto vkBindBufferMemory = ctx.vkft.vkBindBufferMemory;
+    auto vkMapMemory = ctx.vkft.vkMapMemory;
+    auto buffer_info = VkBufferCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(buffer_info, BUFFER_CREATE_INFO);
+    buffer_info.size = size;
+    buffer_info.usage = to_vulkan_buffer_usage(usage);
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    auto vk_buffer = VkBuffer{ };
+    auto result = vkCreateBuffer(ctx.device, &buffer_info, ctx.host_allocator, &vk_buffer);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    auto requirements = VkMemoryRequirements{ };
+    vkGetBufferMemoryRequirements(ctx.device, vk_buffer, &requirements);
+    auto properties = location == memory_location::host ?
+                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT :
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    auto memory = VkDeviceMemory{ };
+    if (auto status = allocate_memory(ctx, requirements, properties, memory); OBERON_IS_IERROR(status))
+    {
+      vkDestroyBuffer(ctx.device, vk_buffer, ctx.host_allocator);
+      return status;
+    }
+    result = vkBindBufferMemory(ctx.device, vk_buffer, memory, 0);
+    if (result != VK_SUCCESS)
+    {
+      vkDestroyBuffer(ctx.device, vk_buffer, ctx.host_allocator);
+      vkFreeMemory(ctx.device, memory, ctx.host_allocator);
+      return result;
+    }
+    // Freeing the memory unmaps it implicitly so destruction doesn't need to know about the mapping.
+    auto mapped = ptr<void>{ };
+    if (location == memory_location::host)
+    {
+      result = vkMapMemory(ctx.device, memory, 0, VK_WHOLE_SIZE, 0, &mapped);
+      if (result != VK_SUCCESS)
+      {
+        vkDestroyBuffer(ctx.device, vk_buffer, ctx.host_allocator);
+        vkFreeMemory(ctx.device, memory, ctx.host_allocator);
+        return result;
+      }
+    }
+    {
+      auto lock = std::lock_guard{ reg.mutex };
+      buffer = buffer_handle{ reg.buffers.insert(vk_buffer, memory, size, buffer_info.usage, mapped) };
+    }
+    OBERON_NAME_VK_OBJECT(ctx, BUFFER, vk_buffer,
+                          "oberon buffer %llx", static_cast<unsigned long long>(buffer.value()));
+    return 0;
+  }
+
+  iresult map_registry_buffer(
+    const resource_registry& reg,
+    const buffer_handle buffer,
+    std::span<std::byte>& memory
+  ) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto mapped = reg.buffers.find<BUFFER_COLUMN_MAPPED>(buffer.value());
+    if (!mapped || !*mapped)
+    {
+      return -1;
+    }
+    auto size = *reg.buffers.find<BUFFER_COLUMN_SIZE>(buffer.value());
+    memory = { static_cast<ptr<std::byte>>(*mapped), static_cast<usize>(size) };
+    return 0;
+  }
+
+  iresult create_registry_image(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const extent_2d& extent,
+    const image_format format,
+    const u32 usage,
+    image_handle& image
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateImage);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyImage);
+    OBERON_PRECONDITION(ctx.vkft.vkGetImageMemoryRequirements);
+    OBERON_PRECONDITION(ctx.vkft.vkAllocateMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkFreeMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkBindImageMemory);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateImageView);
+    OBERON_PRECONDITION(extent.width > 0 && extent.height > 0);
+    auto vkCreateImage = ctx.vkft.vkCreateImage;
+    auto vkDestroyImage = ctx.vkft.vkDestroyImage;
+    auto vkGetImageMemoryRequirements = ctx.vkft.vkGetImageMemoryRequirements;
+    auto vkFreeMemory = ctx.vkft.vkFreeMemory;
+    auto vkBindImageMemory = ctx.vkft.vkBindImageMemory;
+    auto vkCreateImageView = ctx.vkft.vkCreateImageView;
+    auto image_info = VkImageCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(image_info, IMAGE_CREATE_INFO);
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = to_vulkan_format(format);
+    image_info.extent = { static_cast<u32>(extent.width), static_cast<u32>(extent.height), 1 };
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = to_vulkan_image_usage(usage);
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    auto vk_image = VkImage{ };
+    auto result = vkCreateImage(ctx.device, &image_info, ctx.host_allocator, &vk_image);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    auto requirements = VkMemoryRequirements{ };
+    vkGetImageMemoryRequirements(ctx.device, vk_image, &requirements);
+    auto memory = VkDeviceMemory{ };
+    if (auto status = allocate_memory(ctx, requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, memory);
+        OBERON_IS_IERROR(status))
+    {
+      vkDestroyImage(ctx.device, vk_image, ctx.host_allocator);
+      return status;
+    }
+    result = vkBindImageMemory(ctx.device, vk_image, memory, 0);
+    if (result != VK_SUCCESS)
+    {
+      vkDestroyImage(ctx.device, vk_image, ctx.host_allocator);
+      vkFreeMemory(ctx.device, memory, ctx.host_allocator);
+      return result;
+    }
+    auto view_info = VkImageViewCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(view_info, IMAGE_VIEW_CREATE_INFO);
+    view_info.image = vk_image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = image_info.format;
+    view_info.components = {
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+      VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY
+    };
+    view_info.subresourceRange.aspectMask = select_image_aspect(format);
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.layerCount = 1;
+    auto view = VkImageView{ };
+    result = vkCreateImageView(ctx.device, &view_info, ctx.host_allocator, &view);
+    if (result != VK_SUCCESS)
+    {
+      vkDestroyImage(ctx.device, vk_image, ctx.host_allocator);
+      vkFreeMemory(ctx.device, memory, ctx.host_allocator);
+      return result;
+    }
+    {
+      auto lock = std::lock_guard{ reg.mutex };
+      image = image_handle{ reg.images.insert(vk_image, view, memory, image_info.extent, image_info.format) };
+    }
+    OBERON_NAME_VK_OBJECT(ctx, IMAGE, vk_image, "oberon image %llx", static_cast<unsigned long long>(image.value()));
+    OBERON_NAME_VK_OBJECT(ctx, IMAGE_VIEW, view,
+                          "oberon image view %llx", static_cast<unsigned long long>(image.value()));
+    return 0;
+  }
+
+  iresult create_registry_sampler(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const sampler_filter filter,
+    const sampler_address_mode address_mode,
+    sampler_handle& sampler
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateSampler);
+    auto vkCreateSampler = ctx.vkft.vkCreateSampler;
+    auto sampler_info = VkSamplerCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(sampler_info, SAMPLER_CREATE_INFO);
+    sampler_info.magFilter = to_vulkan_filter(filter);
+    sampler_info.minFilter = to_vulkan_filter(filter);
+    sampler_info.mipmapMode = filter == sampler_filter::linear ? VK_SAMPLER_MIPMAP_MODE_LINEAR :
+                                                                 VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = to_vulkan_address_mode(address_mode);
+    sampler_info.addressModeV = sampler_info.addressModeU;
+    sampler_info.addressModeW = sampler_info.addressModeU;
+    sampler_info.borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+    sampler_info.maxLod = VK_LOD_CLAMP_NONE;
+    auto vk_sampler = VkSampler{ };
+    auto result = vkCreateSampler(ctx.device, &sampler_info, ctx.host_allocator, &vk_sampler);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    {
+      auto lock = std::lock_guard{ reg.mutex };
+      sampler = sampler_handle{ reg.samplers.insert(vk_sampler) };
+    }
+    OBERON_NAME_VK_OBJECT(ctx, SAMPLER, vk_sampler,
+                          "oberon sampler %llx", static_cast<unsigned long long>(sampler.value()));
+    return 0;
+  }
+
+  iresult register_pipeline(
+    resource_registry& reg,
+    const VkPipeline pipeline,
+    const VkPipelineLayout layout,
+    const VkPipelineBindPoint bind_point,
+    pipeline_handle& handle
+  ) noexcept {
+    OBERON_PRECONDITION(pipeline);
+    auto lock = std::lock_guard{ reg.mutex };
+    handle = pipeline_handle{ reg.pipelines.insert(pipeline, layout, bind_point) };
+    return 0;
+  }
+
+  iresult create_registry_mesh(
+    resource_registry& reg,
+    const buffer_handle vertices,
+    const buffer_handle indices,
+    const u32 index_count,
+    const i32 vertex_offset,
+    mesh_handle& mesh
+  ) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto index_usage = reg.buffers.find<BUFFER_COLUMN_USAGE>(indices.value());
+    if (!reg.buffers.contains(vertices.value()) || !index_usage || !(*index_usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT))
+    {
+      return -1;
+    }
+    mesh = mesh_handle{ reg.meshes.insert(vertices, indices, index_count, vertex_offset) };
+    return 0;
+  }
+
+  iresult destroy_registry_buffer(resource_registry& reg, const buffer_handle buffer) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto vk_buffer = reg.buffers.find<BUFFER_COLUMN_HANDLE>(buffer.value());
+    if (!vk_buffer)
+    {
+      return -1;
+    }
+    auto retired = retired_resource{ };
+    retired.frame_serial = reg.current_frame_serial;
+    retired.buffer = *vk_buffer;
+    retired.memory = *reg.buffers.find<BUFFER_COLUMN_MEMORY>(buffer.value());
+    reg.retired.push_back(retired);
+    reg.buffers.erase(buffer.value());
+    return 0;
+  }
+
+  iresult destroy_registry_image(resource_registry& reg, const image_handle image) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto vk_image = reg.images.find<IMAGE_COLUMN_HANDLE>(image.value());
+    if (!vk_image)
+    {
+      return -1;
+    }
+    auto retired = retired_resource{ };
+    retired.frame_serial = reg.current_frame_serial;
+    retired.image = *vk_image;
+    retired.image_view = *reg.images.find<IMAGE_COLUMN_VIEW>(image.value());
+    retired.memory = *reg.images.find<IMAGE_COLUMN_MEMORY>(image.value());
+    reg.retired.push_back(retired);
+    reg.images.erase(image.value());
+    return 0;
+  }
+
+  iresult destroy_registry_sampler(resource_registry& reg, const sampler_handle sampler) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto vk_sampler = reg.samplers.find<0>(sampler.value());
+    if (!vk_sampler)
+    {
+      return -1;
+    }
+    auto retired = retired_resource{ };
+    retired.frame_serial = reg.current_frame_serial;
+    retired.sampler = *vk_sampler;
+    reg.retired.push_back(retired);
+    reg.samplers.erase(sampler.value());
+    return 0;
+  }
+
+  iresult destroy_registry_pipeline(resource_registry& reg, const pipeline_handle pipeline) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto vk_pipeline = reg.pipelines.find<PIPELINE_COLUMN_HANDLE>(pipeline.value());
+    if (!vk_pipeline)
+    {
+      return -1;
+    }
+    auto retired = retired_resource{ };
+    retired.frame_serial = reg.current_frame_serial;
+    retired.pipeline = *vk_pipeline;
+    retired.pipeline_layout = *reg.pipelines.find<PIPELINE_COLUMN_LAYOUT>(pipeline.value());
+    reg.retired.push_back(retired);
+    reg.pipelines.erase(pipeline.value());
+    return 0;
+  }
+
+  iresult retire_vulkan_pipeline(resource_registry& reg, const VkPipeline pipeline) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    auto retired = retired_resource{ };
+    retired.frame_serial = reg.current_frame_serial;
+    retired.pipeline = pipeline;
+    reg.retired.push_back(retired);
+    return 0;
+  }
+
+  iresult destroy_registry_mesh(resource_registry& reg, const mesh_handle mesh) noexcept {
+    auto lock = std::lock_guard{ reg.mutex };
+    // Meshes own no Vulkan objects so nothing needs to be retired.
+    if (!reg.meshes.erase(mesh.value()))
+    {
+      return -1;
+    }
+    return 0;
+  }
+
+  u64 advance_registry_frame(
+    const context_impl& ctx,
+    resource_registry& reg,
+    const u64 completed_frame_serial
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    auto lock = std::lock_guard{ reg.mutex };
+    reg.completed_frame_serial = std::max(reg.completed_frame_serial, completed_frame_serial);
+    auto retired_end = std::partition(std::begin(reg.retired), std::end(reg.retired), [&](const auto& resource) {
+      return resource.frame_serial > reg.completed_frame_serial;
+    });
+    for (auto cur = retired_end; cur != std::end(reg.retired); ++cur)
+    {
+      destroy_retired_resource(ctx, *cur);
+    }
+    reg.retired.erase(retired_end, std::end(reg.retired));
+    return ++reg.current_frame_serial;
+  }
+
+  iresult destroy_resource_registry(const context_impl& ctx, resource_registry& reg) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    auto lock = std::lock_guard{ reg.mutex };
+    for (const auto& resource : reg.retired)
+    {
+      destroy_retired_resource(ctx, resource);
+    }
+    reg.retired.clear();
+    const auto& buffers = reg.buffers.column<BUFFER_COLUMN_HANDLE>();
+    const auto& buffer_memory = reg.buffers.column<BUFFER_COLUMN_MEMORY>();
+    for (auto i = usize{ 0 }; i < std::size(buffers); ++i)
+    {
+      destroy_retired_resource(ctx, { .buffer = buffers[i], .memory = buffer_memory[i] });
+    }
+    const auto& images = reg.images.column<IMAGE_COLUMN_HANDLE>();
+    const auto& image_views = reg.images.column<IMAGE_COLUMN_VIEW>();
+    const auto& image_memory = reg.images.column<IMAGE_COLUMN_MEMORY>();
+    for (auto i = usize{ 0 }; i < std::size(images); ++i)
+    {
+      destroy_retired_resource(ctx, { .image = images[i], .image_view = image_views[i], .memory = image_memory[i] });
+    }
+    for (const auto& sampler : reg.samplers.column<0>())
+    {
+      destroy_retired_resource(ctx, { .sampler = sampler });
+    }
+    const auto& pipelines = reg.pipelines.column<PIPELINE_COLUMN_HANDLE>();
+    const auto& pipeline_layouts = reg.pipelines.column<PIPELINE_COLUMN_LAYOUT>();
+    for (auto i = usize{ 0 }; i < std::size(pipelines); ++i)
+    {
+      destroy_retired_resource(ctx, { .pipeline = pipelines[i], .pipeline_layout = pipeline_layouts[i] });
+    }
+    reg.buffers.clear();
+    reg.images.clear();
+    reg.samplers.clear();
+    reg.pipelines.clear();
+    reg.meshes.clear();
+    return 0;
+  }
+
+}
+}
@@ -0,0 +1,376 @@
+#include "oberon/detail/shader_hot_reload.hpp"
+
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <array>
+#include <algorithm>
+#include <functional>
+
+#include "oberon/debug.hpp"
+#include "oberon/log.hpp"
+#include "oberon/trace.hpp"
+
+#include "oberon/detail/context_impl.hpp"
+#include "oberon/detail/renderer_3d_impl.hpp"
+#include "oberon/detail/builtin_shaders.hpp"
+#include "oberon/detail/debug_labels.hpp"
+
+#define OBERON_BUILTIN_SHADER(name, value) \
+  #name,
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  constexpr u32 SPIRV_MAGIC{ 0x07230203 };
+
+  const auto builtin_shader_names = std::array<cstring, BUILTIN_SHADER_COUNT>{
+    OBERON_BUILTIN_SHADERS
+  };
+
+  struct shader_stage_suffix final {
+    cstring suffix{ };
+    VkShaderStageFlagBits stage{ };
+  };
+
+  constexpr std::array<shader_stage_suffix, 6> SHADER_STAGE_SUFFIXES{ {
+    { ".vert.spv", VK_SHADER_STAGE_VERTEX_BIT },
+    { ".tesc.spv", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT },
+    { ".tese.spv", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT },
+    { ".geom.spv", VK_SHADER_STAGE_GEOMETRY_BIT },
+    { ".frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT },
+    { ".comp.spv", VK_SHADER_STAGE_COMPUTE_BIT }
+  } };
+
+  // Split <shader>.<stage>.spv. Returns false if the file isn't a stage of a builtin shader.
+  bool parse_shader_file_name(const cstring file_name, builtin_shader_name& shader, VkShaderStageFlagBits& stage) {
+    auto length = std::strlen(file_name);
+    for (const auto& suffix : SHADER_STAGE_SUFFIXES)
+    {
+      auto suffix_length = std::strlen(suffix.suffix);
+      if (length <= suffix_length || std::strcmp(file_name + length - suffix_length, suffix.suffix))
+      {
+        continue;
+      }
+      for (auto i = usize{ 0 }; i < BUILTIN_SHADER_COUNT; ++i)
+      {
+        auto name_length = std::strlen(builtin_shader_names[i]);
+        if (name_length == length - suffix_length && !std::strncmp(file_name, builtin_shader_names[i], name_length))
+        {
+          shader = static_cast<builtin_shader_name>(i);
+          stage = suffix.stage;
+          return true;
+        }
+      }
+      return false;
+    }
+    return false;
+  }
+
+  builtin_shader_name builtin_pipeline_shader(const usize pipeline_index) {
+    if (pipeline_index < BUILTIN_SHADER_COUNT)
+    {
+      return static_cast<builtin_shader_name>(pipeline_index);
+    }
+    auto variant = static_cast<builtin_shader_variant>(pipeline_index - BUILTIN_SHADER_COUNT);
+    return get_builtin_shader_variant_info(variant).shader;
+  }
+
+  bool read_spirv_file(const std::string& path, std::vector<u32>& code) {
+    auto file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+      return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    auto size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    auto is_valid = size >= 20 && !(size % sizeof(u32));
+    if (is_valid)
+    {
+      code.resize(size / sizeof(u32));
+      is_valid = std::fread(std::data(code), sizeof(u32), std::size(code), file) == std::size(code);
+    }
+    std::fclose(file);
+    return is_valid && code[0] == SPIRV_MAGIC;
+  }
+
+  // Build a replacement for one pipeline with a new module for one of its stages. Other stages use their pending
+  // modules if they have any. The caller must hold the hot reload mutex.
+  iresult rebuild_pipeline_stage(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize pipeline_index,
+    const VkShaderStageFlagBits stage,
+    const std::vector<u32>& code,
+    reloaded_pipeline& reloaded
+  ) {
+    auto vkCreateShaderModule = ctx.vkft.vkCreateShaderModule;
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto vkCreateGraphicsPipelines = ctx.vkft.vkCreateGraphicsPipelines;
+    const auto& config = rnd.graphics_pipeline_configs[pipeline_index];
+    auto stages_end = std::begin(config.pipeline_stages) + config.graphics_pipeline_info.stageCount;
+    auto stage_pos = std::find_if(std::begin(config.pipeline_stages), stages_end,
+                                  [stage](const auto& info) { return info.stage == stage; });
+    if (stage_pos == stages_end)
+    {
+      return -1;
+    }
+    reloaded.pipeline_index = pipeline_index;
+    reloaded.stage_index = stage_pos - std::begin(config.pipeline_stages);
+    auto module_info = VkShaderModuleCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(module_info, SHADER_MODULE_CREATE_INFO);
+    module_info.pCode = std::data(code);
+    module_info.codeSize = std::size(code) * sizeof(u32);
+    auto result = vkCreateShaderModule(ctx.device, &module_info, ctx.host_allocator, &reloaded.module);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    auto stages = config.pipeline_stages;
+    for (const auto& pending : rnd.hot_reload.pending)
+    {
+      if (pending.pipeline_index == pipeline_index)
+      {
+        stages[pending.stage_index].module = pending.module;
+      }
+    }
+    stages[reloaded.stage_index].module = reloaded.module;
+    auto pipeline_info = config.graphics_pipeline_info;
+    pipeline_info.pStages = std::data(stages);
+    result = vkCreateGraphicsPipelines(ctx.device, rnd.pipeline_cache, 1, &pipeline_info, ctx.host_allocator,
+                                       &reloaded.pipeline);
+    if (result != VK_SUCCESS)
+    {
+      vkDestroyShaderModule(ctx.device, reloaded.module, ctx.host_allocator);
+      return result;
+    }
+    OBERON_NAME_VK_OBJECT(ctx, PIPELINE, reloaded.pipeline, "oberon reloaded graphics pipeline %zu", pipeline_index);
+    return 0;
+  }
+
+  void reload_shader_file(const context_impl& ctx, renderer_3d_impl& rnd, const cstring file_name) {
+    OBERON_TRACE_ZONE("reload shader");
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
+    auto& reload = rnd.hot_reload;
+    auto shader = builtin_shader_name{ };
+    auto stage = VkShaderStageFlagBits{ };
+    if (!parse_shader_file_name(file_name, shader, stage))
+    {
+      return;
+    }
+    // Compute pipelines aren't built from the graphics pipeline configurations that reloads are applied to.
+    if (is_builtin_compute_shader(shader))
+    {
+      OBERON_LOG(error, "Failed to reload %s. Compute shaders can't be reloaded.", file_name);
+      return;
+    }
+    auto code = std::vector<u32>{ };
+    if (!read_spirv_file(reload.directory + "/" + file_name, code))
+    {
+      OBERON_LOG(error, "Failed to reload %s. The file isn't a SPIR-V module.", file_name);
+      return;
+    }
+    auto lock = std::lock_guard{ reload.mutex };
+    for (auto i = usize{ 0 }; i < BUILTIN_PIPELINE_COUNT; ++i)
+    {
+      if (builtin_pipeline_shader(i) != shader)
+      {
+        continue;
+      }
+      auto reloaded = reloaded_pipeline{ };
+      if (auto result = rebuild_pipeline_stage(ctx, rnd, i, stage, code, reloaded); result)
+      {
+        OBERON_LOG(error, "Failed to rebuild pipeline %zu from %s (%jd).", i, file_name, result);
+        continue;
+      }
+      // The new pipeline supersedes every pending pipeline for the same index. Those were never used so they're
+      // destroyed immediately. Modules of other stages are still swapped in. An older module of the same stage is
+      // destroyed.
+      auto is_merged = false;
+      for (auto& pending : reload.pending)
+      {
+        if (pending.pipeline_index != reloaded.pipeline_index)
+        {
+          continue;
+        }
+        vkDestroyPipeline(ctx.device, pending.pipeline, ctx.host_allocator);
+        pending.pipeline = VK_NULL_HANDLE;
+        if (pending.stage_index == reloaded.stage_index)
+        {
+          vkDestroyShaderModule(ctx.device, pending.module, ctx.host_allocator);
+          pending = reloaded;
+          is_merged = true;
+        }
+      }
+      if (!is_merged)
+      {
+        reload.pending.push_back(reloaded);
+      }
+    }
+    OBERON_LOG(info, "Reloaded %s.", file_name);
+  }
+
+  void run_shader_watcher(const context_impl& ctx, renderer_3d_impl& rnd) {
+    OBERON_TRACE_THREAD_NAME("oberon shader watcher");
+    auto& reload = rnd.hot_reload;
+    alignas(inotify_event) auto buffer = std::array<char, 4096>{ };
+    auto fds = std::array<pollfd, 2>{ };
+    fds[0].fd = reload.inotify_fd;
+    fds[0].events = POLLIN;
+    fds[1].fd = reload.wake_fd;
+    fds[1].events = POLLIN;
+    for (;;)
+    {
+      if (poll(std::data(fds), std::size(fds), -1) < 0)
+      {
+        if (errno == EINTR)
+        {
+          continue;
+        }
+        OBERON_LOG(error, "Stopped watching %s for shader changes (%s).", reload.directory.c_str(),
+                   std::strerror(errno));
+        return;
+      }
+      if (fds[1].revents)
+      {
+        return;
+      }
+      auto length = read(reload.inotify_fd, std::data(buffer), std::size(buffer));
+      for (auto offset = isize{ 0 }; offset < length;)
+      {
+        const auto& event = *reinterpret_cast<readonly_ptr<inotify_event>>(std::data(buffer) + offset);
+        // Editors commonly replace files by renaming a temporary over them.
+        if (event.len && (event.mask & (IN_CLOSE_WRITE | IN_MOVED_TO)))
+        {
+          reload_shader_file(ctx, rnd, event.name);
+        }
+        offset += sizeof(inotify_event) + event.len;
+      }
+    }
+  }
+
+}
+
+  iresult start_shader_hot_reload(const context_impl& ctx, renderer_3d_impl& rnd, const cstring directory) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateGraphicsPipelines);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyPipeline);
+    OBERON_PRECONDITION(rnd.pipeline_cache);
+    OBERON_PRECONDITION(!rnd.hot_reload.watcher.joinable());
+    auto& reload = rnd.hot_reload;
+    reload.inotify_fd = inotify_init1(IN_CLOEXEC);
+    reload.wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (reload.inotify_fd < 0 || reload.wake_fd < 0 ||
+        inotify_add_watch(reload.inotify_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) < 0)
+    {
+      OBERON_LOG(error, "Failed to watch %s for shader changes (%s).", directory, std::strerror(errno));
+      stop_shader_hot_reload(ctx, rnd);
+      return -1;
+    }
+    reload.directory = directory;
+    reload.watcher = std::thread{ run_shader_watcher, std::cref(ctx), std::ref(rnd) };
+    OBERON_POSTCONDITION(reload.watcher.joinable());
+    return 0;
+  }
+
+  iresult stop_shader_hot_reload(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyPipeline);
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
+    auto& reload = rnd.hot_reload;
+    if (reload.watcher.joinable())
+    {
+      auto value = u64{ 1 };
+      auto written = write(reload.wake_fd, &value, sizeof(value));
+      OBERON_ASSERT(written == sizeof(value));
+      reload.watcher.join();
+    }
+    if (reload.inotify_fd >= 0)
+    {
+      close(reload.inotify_fd);
+      reload.inotify_fd = -1;
+    }
+    if (reload.wake_fd >= 0)
+    {
+      close(reload.wake_fd);
+      reload.wake_fd = -1;
+    }
+    // Pending pipelines were never used so they can be destroyed immediately.
+    for (const auto& pending : reload.pending)
+    {
+      vkDestroyPipeline(ctx.device, pending.pipeline, ctx.host_allocator);
+      vkDestroyShaderModule(ctx.device, pending.module, ctx.host_allocator);
+    }
+    reload.pending.clear();
+    reload.directory.clear();
+    OBERON_POSTCONDITION(!reload.watcher.joinable());
+    return 0;
+  }
+
+  iresult apply_reloaded_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto& reload = rnd.hot_reload;
+    auto lock = std::unique_lock{ reload.mutex, std::try_to_lock };
+    if (!lock.owns_lock() || std::empty(reload.pending))
+    {
+      return 0;
+    }
+    for (const auto& pending : reload.pending)
+    {
+      // Superseded entries only carry a module.
+      if (pending.pipeline)
+      {
+        auto& pipeline = rnd.graphics_pipelines[pending.pipeline_index];
+        retire_vulkan_pipeline(rnd.resources, pipeline);
+        pipeline = pending.pipeline;
+      }
+      // Pipelines don't reference their modules after creation. The module is kept so that rebuilding the renderer
+      // uses the reloaded code.
+      auto& stage = rnd.graphics_pipeline_configs[pending.pipeline_index].pipeline_stages[pending.stage_index];
+      vkDestroyShaderModule(ctx.device, stage.module, ctx.host_allocator);
+      stage.module = pending.module;
+    }
+    reload.pending.clear();
+    // Bundles recorded with the old pipelines are recorded again before their next use.
+    ++rnd.pipeline_generation;
+    return 0;
+  }
+
+  iresult merge_reloaded_shader_modules(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyPipeline);
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
+    auto& reload = rnd.hot_reload;
+    for (const auto& pending : reload.pending)
+    {
+      vkDestroyPipeline(ctx.device, pending.pipeline, ctx.host_allocator);
+      auto& stage = rnd.graphics_pipeline_configs[pending.pipeline_index].pipeline_stages[pending.stage_index];
+      vkDestroyShaderModule(ctx.device, stage.module, ctx.host_allocator);
+      stage.module = pending.module;
+    }
+    reload.pending.clear();
+    return 0;
+  }
+
+}
+}
+
+#undef OBERON_BUILTIN_SHADER
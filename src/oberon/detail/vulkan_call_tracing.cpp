@@ -0,0 +1,116 @@
+#include "oberon/detail/vulkan_call_tracing.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+#include "oberon/debug.hpp"
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  struct vulkan_call_record final {
+    std::atomic<u64> count{ };
+    std::atomic<u64> nanoseconds{ };
+  };
+
+  std::atomic<bool> g_is_tracing_installed{ };
+  std::array<vulkan_call_record, VULKAN_CALL_COUNT> g_vulkan_call_records{ };
+
+  // Records one call when it goes out of scope. This lets void and non-void thunks share one body.
+  class scoped_call_timer final {
+  private:
+    vulkan_call_record& m_record;
+    std::chrono::steady_clock::time_point m_start{ std::chrono::steady_clock::now() };
+  public:
+    scoped_call_timer(vulkan_call_record& record) noexcept : m_record{ record } { }
+
+    ~scoped_call_timer() noexcept {
+      auto elapsed = std::chrono::steady_clock::now() - m_start;
+      m_record.count.fetch_add(1, std::memory_order_relaxed);
+      m_record.nanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                                     std::memory_order_relaxed);
+    }
+  };
+
+  template <vulkan_call Call, typename Pfn>
+  struct vulkan_call_thunk;
+
+  template <vulkan_call Call, typename Return, typename... Args>
+  struct vulkan_call_thunk<Call, Return (VKAPI_PTR*)(Args...)> final {
+    static inline Return (VKAPI_PTR* original)(Args...){ };
+
+    static Return VKAPI_CALL invoke(Args... args) {
+      auto timer = scoped_call_timer{ g_vulkan_call_records[static_cast<usize>(Call)] };
+      return original(args...);
+    }
+  };
+
+#define OBERON_TRACED_VULKAN_CALL(name) \
+  #name,
+
+  constexpr std::array<cstring, VULKAN_CALL_COUNT> VULKAN_CALL_NAMES{
+    OBERON_TRACED_VULKAN_CALLS
+  };
+
+#undef OBERON_TRACED_VULKAN_CALL
+
+}
+
+  cstring vulkan_call_name(const vulkan_call call) noexcept {
+    OBERON_PRECONDITION(call < vulkan_call::max_value);
+    return VULKAN_CALL_NAMES[static_cast<usize>(call)];
+  }
+
+  iresult install_vulkan_call_tracing(vulkan_function_table& vkft) noexcept {
+    if (g_is_tracing_installed.exchange(true))
+    {
+      return -1;
+    }
+    reset_vulkan_call_statistics();
+#define OBERON_TRACED_VULKAN_CALL(name) \
+  if (vkft.name) \
+  { \
+    using thunk = vulkan_call_thunk<vulkan_call::name, PFN_##name>; \
+    thunk::original = vkft.name; \
+    vkft.name = &thunk::invoke; \
+  }
+
+    OBERON_TRACED_VULKAN_CALLS
+
+#undef OBERON_TRACED_VULKAN_CALL
+    return 0;
+  }
+
+  iresult uninstall_vulkan_call_tracing() noexcept {
+    reset_vulkan_call_statistics();
+    g_is_tracing_installed = false;
+    return 0;
+  }
+
+  iresult read_vulkan_call_statistics(std::vector<vulkan_call_statistics>& statistics) noexcept {
+    statistics.resize(VULKAN_CALL_COUNT);
+    for (auto i = usize{ 0 }; auto& entry : statistics)
+    {
+      const auto& record = g_vulkan_call_records[i];
+      entry.name = VULKAN_CALL_NAMES[i];
+      entry.call_count = record.count.load(std::memory_order_relaxed);
+      entry.total_time = std::chrono::nanoseconds{ record.nanoseconds.load(std::memory_order_relaxed) };
+      ++i;
+    }
+    return 0;
+  }
+
+  iresult reset_vulkan_call_statistics() noexcept {
+    for (auto& record : g_vulkan_call_records)
+    {
+      record.count.store(0, std::memory_order_relaxed);
+      record.nanoseconds.store(0, std::memory_order_relaxed);
+    }
+    return 0;
+  }
+
+}
+}
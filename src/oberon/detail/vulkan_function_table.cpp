@@ -27,13 +27,20 @@ namespace detail {
     OBERON_VK_PFN(vkft, instance, vkEnumerateDeviceExtensionProperties, true);
     OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceProperties, true);
     OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceFeatures, true);
+    OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceFeatures2, false);
     OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceQueueFamilyProperties, true);
+    OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceMemoryProperties, true);
     OBERON_VK_PFN(vkft, instance, vkCreateDevice, true);
     OBERON_VK_PFN(vkft, instance, vkDestroyInstance, true);
+    // VK_EXT_calibrated_timestamps
+    OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceCalibrateableTimeDomainsEXT, false);
     // VK_EXT_debug_utils
     OBERON_VK_PFN(vkft, instance, vkCreateDebugUtilsMessengerEXT, false);
     OBERON_VK_PFN(vkft, instance, vkSubmitDebugUtilsMessageEXT, false);
     OBERON_VK_PFN(vkft, instance, vkDestroyDebugUtilsMessengerEXT, false);
+    OBERON_VK_PFN(vkft, instance, vkSetDebugUtilsObjectNameEXT, false);
+    OBERON_VK_PFN(vkft, instance, vkCmdBeginDebugUtilsLabelEXT, false);
+    OBERON_VK_PFN(vkft, instance, vkCmdEndDebugUtilsLabelEXT, false);
     // VK_KHR_xcb_surface
     OBERON_VK_PFN(vkft, instance, vkGetPhysicalDeviceXcbPresentationSupportKHR, false);
     OBERON_VK_PFN(vkft, instance, vkCreateXcbSurfaceKHR, false);
@@ -63,9 +70,17 @@ namespace detail {
     OBERON_VK_PFN(vkft, device, vkDestroyPipelineCache, true);
     OBERON_VK_PFN(vkft, device, vkGetPipelineCacheData, true);
     OBERON_VK_PFN(vkft, device, vkMergePipelineCaches, true);
+    OBERON_VK_PFN(vkft, device, vkCreateDescriptorSetLayout, true);
+    OBERON_VK_PFN(vkft, device, vkDestroyDescriptorSetLayout, true);
+    OBERON_VK_PFN(vkft, device, vkCreateDescriptorPool, true);
+    OBERON_VK_PFN(vkft, device, vkDestroyDescriptorPool, true);
+    OBERON_VK_PFN(vkft, device, vkResetDescriptorPool, true);
+    OBERON_VK_PFN(vkft, device, vkAllocateDescriptorSets, true);
+    OBERON_VK_PFN(vkft, device, vkUpdateDescriptorSets, true);
     OBERON_VK_PFN(vkft, device, vkCreatePipelineLayout, true);
     OBERON_VK_PFN(vkft, device, vkDestroyPipelineLayout, true);
     OBERON_VK_PFN(vkft, device, vkCreateGraphicsPipelines, true);
+    OBERON_VK_PFN(vkft, device, vkCreateComputePipelines, true);
     OBERON_VK_PFN(vkft, device, vkDestroyPipeline, true);
     OBERON_VK_PFN(vkft, device, vkCreateCommandPool, true);
     OBERON_VK_PFN(vkft, device, vkDestroyCommandPool, true);
@@ -77,6 +92,17 @@ namespace detail {
     OBERON_VK_PFN(vkft, device, vkCmdEndRenderPass, true);
     OBERON_VK_PFN(vkft, device, vkCmdBindPipeline, true);
     OBERON_VK_PFN(vkft, device, vkCmdDraw, true);
+    OBERON_VK_PFN(vkft, device, vkCmdBindDescriptorSets, true);
+    OBERON_VK_PFN(vkft, device, vkCmdPushConstants, true);
+    OBERON_VK_PFN(vkft, device, vkCmdBindVertexBuffers, true);
+    OBERON_VK_PFN(vkft, device, vkCmdBindIndexBuffer, true);
+    OBERON_VK_PFN(vkft, device, vkCmdFillBuffer, true);
+    OBERON_VK_PFN(vkft, device, vkCmdPipelineBarrier, true);
+    OBERON_VK_PFN(vkft, device, vkCmdDispatch, true);
+    // Core in Vulkan 1.2 but only usable when the drawIndirectCount feature is enabled.
+    OBERON_VK_PFN(vkft, device, vkCmdDrawIndexedIndirectCount, false);
+    OBERON_VK_PFN(vkft, device, vkCmdSetViewport, true);
+    OBERON_VK_PFN(vkft, device, vkCmdSetScissor, true);
     OBERON_VK_PFN(vkft, device, vkCreateSemaphore, true);
     OBERON_VK_PFN(vkft, device, vkDestroySemaphore, true);
     OBERON_VK_PFN(vkft, device, vkQueueSubmit, true);
@@ -86,12 +112,34 @@ namespace detail {
     OBERON_VK_PFN(vkft, device, vkWaitForFences, true);
     OBERON_VK_PFN(vkft, device, vkResetFences, true);
     OBERON_VK_PFN(vkft, device, vkResetCommandBuffer, true);
+    OBERON_VK_PFN(vkft, device, vkAllocateMemory, true);
+    OBERON_VK_PFN(vkft, device, vkFreeMemory, true);
+    OBERON_VK_PFN(vkft, device, vkCreateBuffer, true);
+    OBERON_VK_PFN(vkft, device, vkDestroyBuffer, true);
+    OBERON_VK_PFN(vkft, device, vkGetBufferMemoryRequirements, true);
+    OBERON_VK_PFN(vkft, device, vkBindBufferMemory, true);
+    OBERON_VK_PFN(vkft, device, vkMapMemory, true);
+    OBERON_VK_PFN(vkft, device, vkCreateImage, true);
+    OBERON_VK_PFN(vkft, device, vkDestroyImage, true);
+    OBERON_VK_PFN(vkft, device, vkGetImageMemoryRequirements, true);
+    OBERON_VK_PFN(vkft, device, vkBindImageMemory, true);
+    OBERON_VK_PFN(vkft, device, vkCreateSampler, true);
+    OBERON_VK_PFN(vkft, device, vkDestroySampler, true);
+    OBERON_VK_PFN(vkft, device, vkCreateQueryPool, true);
+    OBERON_VK_PFN(vkft, device, vkDestroyQueryPool, true);
+    OBERON_VK_PFN(vkft, device, vkGetQueryPoolResults, true);
+    OBERON_VK_PFN(vkft, device, vkCmdResetQueryPool, true);
+    OBERON_VK_PFN(vkft, device, vkCmdWriteTimestamp, true);
     // VK_KHR_swapchain
     OBERON_VK_PFN(vkft, device, vkCreateSwapchainKHR, false);
     OBERON_VK_PFN(vkft, device, vkGetSwapchainImagesKHR, false);
     OBERON_VK_PFN(vkft, device, vkDestroySwapchainKHR, false);
     OBERON_VK_PFN(vkft, device, vkAcquireNextImageKHR, false);
     OBERON_VK_PFN(vkft, device, vkQueuePresentKHR, false);
+    // VK_KHR_present_wait
+    OBERON_VK_PFN(vkft, device, vkWaitForPresentKHR, false);
+    // VK_EXT_calibrated_timestamps
+    OBERON_VK_PFN(vkft, device, vkGetCalibratedTimestampsEXT, false);
     return 0;
   }
 
@@ -0,0 +1,103 @@
+#include "oberon/detail/worker_pool.hpp"
+
+#include <algorithm>
+
+#include "oberon/debug.hpp"
+
+namespace oberon {
+namespace detail {
+
+namespace {
+
+  thread_local bool t_is_running_chunk{ };
+
+}
+
+  worker_pool::worker_pool(const usize worker_count) {
+    m_workers.reserve(worker_count);
+    for (auto i = usize{ 0 }; i < worker_count; ++i)
+    {
+      m_workers.emplace_back(&worker_pool::run_worker, this);
+    }
+  }
+
+  worker_pool::~worker_pool() noexcept {
+    {
+      auto lock = std::lock_guard{ m_mutex };
+      m_is_stopping = true;
+    }
+    m_job_ready.notify_all();
+    for (auto& worker : m_workers)
+    {
+      worker.join();
+    }
+  }
+
+  bool worker_pool::is_running_chunk() noexcept {
+    return t_is_running_chunk;
+  }
+
+  void worker_pool::run_chunks(job& current) noexcept {
+    auto was_running_chunk = t_is_running_chunk;
+    t_is_running_chunk = true;
+    auto chunk_count = (current.count + current.chunk_size - 1) / current.chunk_size;
+    for (auto chunk = current.next_chunk.fetch_add(1, std::memory_order_relaxed); chunk < chunk_count;
+         chunk = current.next_chunk.fetch_add(1, std::memory_order_relaxed))
+    {
+      auto begin = chunk * current.chunk_size;
+      current.invoke(current.function, begin, std::min(begin + current.chunk_size, current.count));
+    }
+    t_is_running_chunk = was_running_chunk;
+  }
+
+  void worker_pool::run_worker() noexcept {
+    auto seen_generation = u64{ 0 };
+    auto lock = std::unique_lock{ m_mutex };
+    while (true)
+    {
+      m_job_ready.wait(lock, [&]() { return m_is_stopping || (m_job && m_job_generation != seen_generation); });
+      if (m_is_stopping)
+      {
+        return;
+      }
+      seen_generation = m_job_generation;
+      auto current = m_job;
+      ++m_busy_workers;
+      lock.unlock();
+      run_chunks(*current);
+      lock.lock();
+      if (!--m_busy_workers)
+      {
+        m_job_finished.notify_one();
+      }
+    }
+  }
+
+  void worker_pool::run(job& current) {
+    auto submit_lock = std::lock_guard{ m_submit_mutex };
+    {
+      auto lock = std::lock_guard{ m_mutex };
+      m_job = &current;
+      ++m_job_generation;
+    }
+    m_job_ready.notify_all();
+    run_chunks(current);
+    // Every chunk has been claimed. Wait for workers still executing theirs and stop late workers from picking up a
+    // job that's about to go out of scope.
+    auto lock = std::unique_lock{ m_mutex };
+    m_job_finished.wait(lock, [this]() { return !m_busy_workers; });
+    m_job = nullptr;
+    OBERON_POSTCONDITION(current.next_chunk.load() >= (current.count + current.chunk_size - 1) / current.chunk_size);
+  }
+
+  usize worker_pool::worker_count() const noexcept {
+    return std::size(m_workers);
+  }
+
+  worker_pool& default_worker_pool() {
+    static auto pool = worker_pool{ std::max(std::thread::hardware_concurrency(), 1U) - 1 };
+    return pool;
+  }
+
+}
+}
@@ -1,8 +1,21 @@
 #include "oberon/detail/x11.hpp"
 
+#include "oberon/debug.hpp"
+
+#define OBERON_X11_ATOM(name) \
+  #name,
+
 namespace oberon {
 namespace detail {
 
+namespace {
+
+  const auto x11_atom_names = std::array<cstring, X11_ATOM_COUNT>{
+    OBERON_X11_ATOMS
+  };
+
+}
+
   // This is basically the canon implementation from
   // https://www.x.org/releases/X11R7.7/doc/libxcb/tutorial/index.html#screenofdisplay
   xcb_screen_t* screen_of_display(xcb_connection_t *const connection, int screen) {
@@ -18,5 +31,29 @@ namespace detail {
     return nullptr;
   }
 
+  f64 x11_mode_refresh_rate(const xcb_randr_mode_info_t& mode) noexcept {
+    auto vtotal = static_cast<f64>(mode.vtotal);
+    if (mode.mode_flags & XCB_RANDR_MODE_FLAG_DOUBLE_SCAN)
+    {
+      vtotal *= 2.0;
+    }
+    if (mode.mode_flags & XCB_RANDR_MODE_FLAG_INTERLACE)
+    {
+      vtotal /= 2.0;
+    }
+    if (!mode.htotal || vtotal == 0.0)
+    {
+      return 0.0;
+    }
+    return static_cast<f64>(mode.dot_clock) / (static_cast<f64>(mode.htotal) * vtotal);
+  }
+
+  cstring x11_atom_name(const x11_atom atom) noexcept {
+    OBERON_PRECONDITION(atom < x11_atom::max_value);
+    return x11_atom_names[static_cast<usize>(atom)];
+  }
+
 }
 }
+
+#undef OBERON_X11_ATOM
@@ -0,0 +1,280 @@
+#include "oberon/log.hpp"
+
+#include <syslog.h>
+
+#include <cstdio>
+#include <cstdarg>
+#include <ctime>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+namespace oberon {
+
+namespace {
+
+  // Must be a power of 2.
+  constexpr usize LOG_RING_SIZE{ 512 };
+  // Longer messages are truncated.
+  constexpr usize LOG_MESSAGE_SIZE{ 1024 };
+
+  constexpr std::array<cstring, 6> SEVERITY_NAMES{ "trace", "debug", "info", "warning", "error", "fatal" };
+  constexpr std::array<int, 6> SYSLOG_PRIORITIES{ LOG_DEBUG, LOG_DEBUG, LOG_INFO, LOG_WARNING, LOG_ERR, LOG_CRIT };
+
+  // These are read on every call site so they live outside of log_state to avoid starting the writer thread.
+  std::atomic<int> g_log_severity{ OBERON_LOG_MIN_SEVERITY };
+  std::atomic<u32> g_log_sinks{ LOG_SINK_STDERR_BIT };
+  std::atomic<u64> g_dropped_log_messages{ };
+
+  struct log_entry final {
+    // Bounded MPMC queue sequence. Equal to the ring position when free and the position + 1 when ready to write.
+    std::atomic<usize> sequence{ };
+    log_severity severity{ };
+    std::chrono::system_clock::time_point time{ };
+    usize length{ };
+    std::array<char, LOG_MESSAGE_SIZE> message{ };
+  };
+
+  class log_state final {
+  private:
+    std::array<log_entry, LOG_RING_SIZE> m_entries{ };
+    alignas(64) std::atomic<usize> m_enqueue_position{ };
+    // Only the writer thread advances this. Flushing threads wait on it.
+    alignas(64) std::atomic<usize> m_written_position{ };
+    std::atomic<bool> m_has_work{ };
+    std::atomic<bool> m_is_running{ true };
+    std::mutex m_file_mutex{ };
+    ptr<std::FILE> m_file{ };
+    std::thread m_writer{ };
+
+    void write(const log_entry& entry) {
+      auto sinks = g_log_sinks.load(std::memory_order_relaxed);
+      auto severity = static_cast<usize>(entry.severity);
+      auto length = static_cast<int>(entry.length);
+      auto seconds = std::chrono::system_clock::to_time_t(entry.time);
+      auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(entry.time.time_since_epoch()) % 1000;
+      auto local = std::tm{ };
+      localtime_r(&seconds, &local);
+      auto timestamp = std::array<char, 16>{ };
+      std::snprintf(std::data(timestamp), std::size(timestamp), "%02d:%02d:%02d.%03d", local.tm_hour, local.tm_min,
+                    local.tm_sec, static_cast<int>(milliseconds.count()));
+      if (sinks & LOG_SINK_STDERR_BIT)
+      {
+        std::fprintf(stderr, "%s [%s] %.*s\n", std::data(timestamp), SEVERITY_NAMES[severity], length,
+                     std::data(entry.message));
+      }
+      if (sinks & LOG_SINK_FILE_BIT)
+      {
+        auto lock = std::lock_guard{ m_file_mutex };
+        if (m_file)
+        {
+          std::fprintf(m_file, "%s [%s] %.*s\n", std::data(timestamp), SEVERITY_NAMES[severity], length,
+                       std::data(entry.message));
+        }
+      }
+      if (sinks & LOG_SINK_SYSLOG_BIT)
+      {
+        syslog(SYSLOG_PRIORITIES[severity], "%.*s", length, std::data(entry.message));
+      }
+    }
+
+    void drain() {
+      auto position = m_written_position.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        auto& entry = m_entries[position & (LOG_RING_SIZE - 1)];
+        if (entry.sequence.load(std::memory_order_acquire) != position + 1)
+        {
+          break;
+        }
+        write(entry);
+        entry.sequence.store(position + LOG_RING_SIZE, std::memory_order_release);
+        m_written_position.store(++position, std::memory_order_release);
+        m_written_position.notify_all();
+      }
+      std::fflush(stderr);
+      auto lock = std::lock_guard{ m_file_mutex };
+      if (m_file)
+      {
+        std::fflush(m_file);
+      }
+    }
+
+    void run() {
+      while (m_is_running.load(std::memory_order_acquire))
+      {
+        m_has_work.wait(false, std::memory_order_acquire);
+        // Clearing the flag before draining means any message published during the drain wakes the writer again.
+        m_has_work.exchange(false, std::memory_order_acq_rel);
+        drain();
+      }
+      drain();
+    }
+
+    void wake() noexcept {
+      if (!m_has_work.exchange(true, std::memory_order_acq_rel))
+      {
+        m_has_work.notify_one();
+      }
+    }
+  public:
+    log_state() {
+      for (auto i = usize{ 0 }; i < LOG_RING_SIZE; ++i)
+      {
+        m_entries[i].sequence.store(i, std::memory_order_relaxed);
+      }
+      m_writer = std::thread{ &log_state::run, this };
+    }
+
+    log_state(const log_state& other) = delete;
+    log_state(log_state&& other) = delete;
+
+    ~log_state() noexcept {
+      m_is_running.store(false, std::memory_order_release);
+      wake();
+      m_writer.join();
+      close_file();
+    }
+
+    log_state& operator=(const log_state& rhs) = delete;
+    log_state& operator=(log_state&& rhs) = delete;
+
+    bool enqueue(const log_severity severity, const cstring format, std::va_list args) noexcept {
+      auto position = m_enqueue_position.load(std::memory_order_relaxed);
+      auto entry = ptr<log_entry>{ };
+      for (;;)
+      {
+        entry = &m_entries[position & (LOG_RING_SIZE - 1)];
+        auto difference = static_cast<isize>(entry->sequence.load(std::memory_order_acquire) - position);
+        if (!difference)
+        {
+          if (m_enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+          {
+            break;
+          }
+        }
+        else if (difference < 0)
+        {
+          // The writer hasn't freed this entry yet so the ring is full.
+          g_dropped_log_messages.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        else
+        {
+          position = m_enqueue_position.load(std::memory_order_relaxed);
+        }
+      }
+      entry->severity = severity;
+      entry->time = std::chrono::system_clock::now();
+      auto length = std::vsnprintf(std::data(entry->message), LOG_MESSAGE_SIZE, format, args);
+      entry->length = std::clamp(length, 0, static_cast<int>(LOG_MESSAGE_SIZE - 1));
+      entry->sequence.store(position + 1, std::memory_order_release);
+      wake();
+      return true;
+    }
+
+    void flush() noexcept {
+      // The writer can't wait on itself. This only happens if a sink asserts.
+      if (std::this_thread::get_id() == m_writer.get_id())
+      {
+        return;
+      }
+      auto target = m_enqueue_position.load(std::memory_order_acquire);
+      wake();
+      auto position = m_written_position.load(std::memory_order_acquire);
+      while (position < target)
+      {
+        m_written_position.wait(position, std::memory_order_acquire);
+        position = m_written_position.load(std::memory_order_acquire);
+      }
+    }
+
+    bool open_file(const cstring path) noexcept {
+      auto file = std::fopen(path, "a");
+      if (!file)
+      {
+        return false;
+      }
+      auto lock = std::lock_guard{ m_file_mutex };
+      if (m_file)
+      {
+        std::fclose(m_file);
+      }
+      m_file = file;
+      return true;
+    }
+
+    void close_file() noexcept {
+      auto lock = std::lock_guard{ m_file_mutex };
+      if (m_file)
+      {
+        std::fclose(m_file);
+        m_file = nullptr;
+      }
+    }
+  };
+
+  // Constructed on first use so that programs that never log never start the writer thread.
+  log_state& get_log_state() {
+    static auto state = log_state{ };
+    return state;
+  }
+
+}
+
+  bool is_log_enabled(const log_severity severity) noexcept {
+    return static_cast<int>(severity) >= g_log_severity.load(std::memory_order_relaxed);
+  }
+
+  void set_log_severity(const log_severity severity) noexcept {
+    g_log_severity.store(static_cast<int>(severity), std::memory_order_relaxed);
+  }
+
+  log_severity current_log_severity() noexcept {
+    return static_cast<log_severity>(g_log_severity.load(std::memory_order_relaxed));
+  }
+
+  void set_log_sinks(const u32 sinks) noexcept {
+    g_log_sinks.store(sinks, std::memory_order_relaxed);
+  }
+
+  u32 current_log_sinks() noexcept {
+    return g_log_sinks.load(std::memory_order_relaxed);
+  }
+
+  bool open_log_file(const cstring path) noexcept {
+    return get_log_state().open_file(path);
+  }
+
+  void close_log_file() noexcept {
+    get_log_state().close_file();
+  }
+
+  void log_message(const log_severity severity, const cstring format, ...) noexcept {
+    std::va_list args;
+    va_start(args, format);
+    auto is_queued = get_log_state().enqueue(severity, format, args);
+    va_end(args);
+    // Fatal messages precede termination so they must never be lost.
+    if (!is_queued && severity == log_severity::fatal)
+    {
+      va_start(args, format);
+      std::vfprintf(stderr, format, args);
+      std::fputc('\n', stderr);
+      va_end(args);
+    }
+  }
+
+  void flush_log() noexcept {
+    get_log_state().flush();
+  }
+
+  u64 dropped_log_messages() noexcept {
+    return g_dropped_log_messages.load(std::memory_order_relaxed);
+  }
+
+}
@@ -0,0 +1,396 @@
+#include "oberon/math.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#include "oberon/memory.hpp"
+#include "oberon/debug.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define OBERON_MATH_X86 1
+  #include <immintrin.h>
+#endif
+
+// SIMD kernels are compiled with per-function target attributes so the library itself doesn't require SSE4.1 or AVX2.
+// They're only called after the CPU has been checked.
+#if defined(OBERON_MATH_X86)
+  #define OBERON_TARGET_SSE4 __attribute__((target("sse4.1")))
+  #define OBERON_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace oberon {
+
+namespace {
+
+  struct math_kernels final {
+    void (*multiply_mat4)(readonly_ptr<mat4> lhs, readonly_ptr<mat4> rhs, ptr<mat4> out, usize count) noexcept{ };
+    void (*transform_vec4)(const mat4& m, readonly_ptr<vec4> in, ptr<vec4> out, usize count) noexcept{ };
+    void (*transform_points)(const mat4& m, readonly_ptr<f32> x, readonly_ptr<f32> y, readonly_ptr<f32> z,
+                             ptr<f32> out_x, ptr<f32> out_y, ptr<f32> out_z, usize count) noexcept{ };
+  };
+
+  void scalar_multiply_mat4(readonly_ptr<mat4> lhs, readonly_ptr<mat4> rhs, ptr<mat4> out, usize count) noexcept {
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      out[i] = lhs[i] * rhs[i];
+    }
+  }
+
+  void scalar_transform_vec4(const mat4& m, readonly_ptr<vec4> in, ptr<vec4> out, usize count) noexcept {
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      out[i] = m * in[i];
+    }
+  }
+
+  void scalar_transform_points(const mat4& m, readonly_ptr<f32> x, readonly_ptr<f32> y, readonly_ptr<f32> z,
+                               ptr<f32> out_x, ptr<f32> out_y, ptr<f32> out_z, usize count) noexcept {
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      auto p = transform_point(m, { x[i], y[i], z[i] });
+      out_x[i] = p.x;
+      out_y[i] = p.y;
+      out_z[i] = p.z;
+    }
+  }
+
+  constexpr math_kernels SCALAR_KERNELS{ scalar_multiply_mat4, scalar_transform_vec4, scalar_transform_points };
+
+#if defined(OBERON_MATH_X86)
+  OBERON_TARGET_SSE4 inline __m128 sse4_transform(const __m128 (&columns)[4], const __m128 v) noexcept {
+    auto result = _mm_mul_ps(columns[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    result = _mm_add_ps(result, _mm_mul_ps(columns[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+    result = _mm_add_ps(result, _mm_mul_ps(columns[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+    return _mm_add_ps(result, _mm_mul_ps(columns[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))));
+  }
+
+  OBERON_TARGET_SSE4 void sse4_multiply_mat4(readonly_ptr<mat4> lhs, readonly_ptr<mat4> rhs, ptr<mat4> out,
+                                             usize count) noexcept {
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      const auto a = reinterpret_cast<readonly_ptr<f32>>(&lhs[i]);
+      const auto b = reinterpret_cast<readonly_ptr<f32>>(&rhs[i]);
+      const auto result = reinterpret_cast<ptr<f32>>(&out[i]);
+      const __m128 columns[4]{ _mm_load_ps(a), _mm_load_ps(a + 4), _mm_load_ps(a + 8), _mm_load_ps(a + 12) };
+      // Every column is loaded before anything is stored so out may alias lhs or rhs.
+      const auto c0 = sse4_transform(columns, _mm_load_ps(b));
+      const auto c1 = sse4_transform(columns, _mm_load_ps(b + 4));
+      const auto c2 = sse4_transform(columns, _mm_load_ps(b + 8));
+      const auto c3 = sse4_transform(columns, _mm_load_ps(b + 12));
+      _mm_store_ps(result, c0);
+      _mm_store_ps(result + 4, c1);
+      _mm_store_ps(result + 8, c2);
+      _mm_store_ps(result + 12, c3);
+    }
+  }
+
+  OBERON_TARGET_SSE4 void sse4_transform_vec4(const mat4& m, readonly_ptr<vec4> in, ptr<vec4> out,
+                                              usize count) noexcept {
+    const auto a = reinterpret_cast<readonly_ptr<f32>>(&m);
+    const __m128 columns[4]{ _mm_load_ps(a), _mm_load_ps(a + 4), _mm_load_ps(a + 8), _mm_load_ps(a + 12) };
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      auto v = _mm_load_ps(reinterpret_cast<readonly_ptr<f32>>(&in[i]));
+      _mm_store_ps(reinterpret_cast<ptr<f32>>(&out[i]), sse4_transform(columns, v));
+    }
+  }
+
+  OBERON_TARGET_SSE4 void sse4_transform_points(const mat4& m, readonly_ptr<f32> x, readonly_ptr<f32> y,
+                                                readonly_ptr<f32> z, ptr<f32> out_x, ptr<f32> out_y, ptr<f32> out_z,
+                                                usize count) noexcept {
+    const auto& [c0, c1, c2, c3] = m.columns;
+    auto i = usize{ 0 };
+    for (; i + 4 <= count; i += 4)
+    {
+      const auto px = _mm_loadu_ps(x + i);
+      const auto py = _mm_loadu_ps(y + i);
+      const auto pz = _mm_loadu_ps(z + i);
+      auto rx = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c0.x), px), _mm_set1_ps(c3.x));
+      auto ry = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c0.y), px), _mm_set1_ps(c3.y));
+      auto rz = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(c0.z), px), _mm_set1_ps(c3.z));
+      rx = _mm_add_ps(rx, _mm_mul_ps(_mm_set1_ps(c1.x), py));
+      ry = _mm_add_ps(ry, _mm_mul_ps(_mm_set1_ps(c1.y), py));
+      rz = _mm_add_ps(rz, _mm_mul_ps(_mm_set1_ps(c1.z), py));
+      rx = _mm_add_ps(rx, _mm_mul_ps(_mm_set1_ps(c2.x), pz));
+      ry = _mm_add_ps(ry, _mm_mul_ps(_mm_set1_ps(c2.y), pz));
+      rz = _mm_add_ps(rz, _mm_mul_ps(_mm_set1_ps(c2.z), pz));
+      _mm_storeu_ps(out_x + i, rx);
+      _mm_storeu_ps(out_y + i, ry);
+      _mm_storeu_ps(out_z + i, rz);
+    }
+    scalar_transform_points(m, x + i, y + i, z + i, out_x + i, out_y + i, out_z + i, count - i);
+  }
+
+  constexpr math_kernels SSE4_KERNELS{ sse4_multiply_mat4, sse4_transform_vec4, sse4_transform_points };
+
+  // Two columns or vectors are processed per instruction with the matrix repeated in both 128 bit lanes.
+  OBERON_TARGET_AVX2 inline __m256 avx2_transform(const __m256 (&columns)[4], const __m256 v) noexcept {
+    auto result = _mm256_mul_ps(columns[0], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+    result = _mm256_fmadd_ps(columns[1], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), result);
+    result = _mm256_fmadd_ps(columns[2], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), result);
+    return _mm256_fmadd_ps(columns[3], _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), result);
+  }
+
+  OBERON_TARGET_AVX2 void avx2_multiply_mat4(readonly_ptr<mat4> lhs, readonly_ptr<mat4> rhs, ptr<mat4> out,
+                                             usize count) noexcept {
+    for (auto i = usize{ 0 }; i < count; ++i)
+    {
+      const auto a = reinterpret_cast<readonly_ptr<f32>>(&lhs[i]);
+      const auto b = reinterpret_cast<readonly_ptr<f32>>(&rhs[i]);
+      const auto result = reinterpret_cast<ptr<f32>>(&out[i]);
+      const __m256 columns[4]{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a)),
+                               _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4)),
+                               _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8)),
+                               _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12)) };
+      // mat4 is only 16 byte aligned.
+      const auto c01 = avx2_transform(columns, _mm256_loadu_ps(b));
+      const auto c23 = avx2_transform(columns, _mm256_loadu_ps(b + 8));
+      _mm256_storeu_ps(result, c01);
+      _mm256_storeu_ps(result + 8, c23);
+    }
+  }
+
+  OBERON_TARGET_AVX2 void avx2_transform_vec4(const mat4& m, readonly_ptr<vec4> in, ptr<vec4> out,
+                                              usize count) noexcept {
+    const auto a = reinterpret_cast<readonly_ptr<f32>>(&m);
+    const __m256 columns[4]{ _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a)),
+                             _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4)),
+                             _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8)),
+                             _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12)) };
+    const auto src = reinterpret_cast<readonly_ptr<f32>>(in);
+    const auto dst = reinterpret_cast<ptr<f32>>(out);
+    auto i = usize{ 0 };
+    // vec4 is only 16 byte aligned so pairs are loaded unaligned.
+    for (; i + 2 <= count; i += 2)
+    {
+      _mm256_storeu_ps(dst + i * 4, avx2_transform(columns, _mm256_loadu_ps(src + i * 4)));
+    }
+    if (i < count)
+    {
+      const auto v = _mm_load_ps(src + i * 4);
+      const auto r = avx2_transform(columns, _mm256_castps128_ps256(v));
+      _mm_store_ps(dst + i * 4, _mm256_castps256_ps128(r));
+    }
+  }
+
+  OBERON_TARGET_AVX2 void avx2_transform_points(const mat4& m, readonly_ptr<f32> x, readonly_ptr<f32> y,
+                                                readonly_ptr<f32> z, ptr<f32> out_x, ptr<f32> out_y, ptr<f32> out_z,
+                                                usize count) noexcept {
+    const auto& [c0, c1, c2, c3] = m.columns;
+    auto i = usize{ 0 };
+    for (; i + 8 <= count; i += 8)
+    {
+      const auto px = _mm256_loadu_ps(x + i);
+      const auto py = _mm256_loadu_ps(y + i);
+      const auto pz = _mm256_loadu_ps(z + i);
+      auto rx = _mm256_fmadd_ps(_mm256_set1_ps(c0.x), px, _mm256_set1_ps(c3.x));
+      auto ry = _mm256_fmadd_ps(_mm256_set1_ps(c0.y), px, _mm256_set1_ps(c3.y));
+      auto rz = _mm256_fmadd_ps(_mm256_set1_ps(c0.z), px, _mm256_set1_ps(c3.z));
+      rx = _mm256_fmadd_ps(_mm256_set1_ps(c1.x), py, rx);
+      ry = _mm256_fmadd_ps(_mm256_set1_ps(c1.y), py, ry);
+      rz = _mm256_fmadd_ps(_mm256_set1_ps(c1.z), py, rz);
+      rx = _mm256_fmadd_ps(_mm256_set1_ps(c2.x), pz, rx);
+      ry = _mm256_fmadd_ps(_mm256_set1_ps(c2.y), pz, ry);
+      rz = _mm256_fmadd_ps(_mm256_set1_ps(c2.z), pz, rz);
+      _mm256_storeu_ps(out_x + i, rx);
+      _mm256_storeu_ps(out_y + i, ry);
+      _mm256_storeu_ps(out_z + i, rz);
+    }
+    sse4_transform_points(m, x + i, y + i, z + i, out_x + i, out_y + i, out_z + i, count - i);
+  }
+
+  constexpr math_kernels AVX2_KERNELS{ avx2_multiply_mat4, avx2_transform_vec4, avx2_transform_points };
+#endif
+
+  simd_level detect_simd_level() noexcept {
+#if defined(OBERON_MATH_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    {
+      return simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1"))
+    {
+      return simd_level::sse4;
+    }
+#endif
+    return simd_level::scalar;
+  }
+
+  readonly_ptr<math_kernels> select_kernels(const simd_level level) noexcept {
+    switch (level)
+    {
+#if defined(OBERON_MATH_X86)
+    case simd_level::avx2:
+      return &AVX2_KERNELS;
+    case simd_level::sse4:
+      return &SSE4_KERNELS;
+#endif
+    default:
+      return &SCALAR_KERNELS;
+    }
+  }
+
+  // Both are constant initialized so kernels can be called during static initialization of other translation units.
+  std::atomic<simd_level> g_simd_level{ simd_level::scalar };
+  std::atomic<readonly_ptr<math_kernels>> g_kernels{ };
+
+  const math_kernels& kernels() noexcept {
+    auto result = g_kernels.load(std::memory_order_relaxed);
+    if (!result)
+    {
+      set_simd_level(max_simd_level());
+      result = g_kernels.load(std::memory_order_relaxed);
+    }
+    return *result;
+  }
+
+}
+
+  mat4 inverse(const mat4& m) noexcept {
+    const auto& [c0, c1, c2, c3] = m.columns;
+    // 2x2 sub-determinants of the lower two and upper two rows.
+    auto s0 = c0.x * c1.y - c1.x * c0.y;
+    auto s1 = c0.x * c2.y - c2.x * c0.y;
+    auto s2 = c0.x * c3.y - c3.x * c0.y;
+    auto s3 = c1.x * c2.y - c2.x * c1.y;
+    auto s4 = c1.x * c3.y - c3.x * c1.y;
+    auto s5 = c2.x * c3.y - c3.x * c2.y;
+    auto t0 = c0.z * c1.w - c1.z * c0.w;
+    auto t1 = c0.z * c2.w - c2.z * c0.w;
+    auto t2 = c0.z * c3.w - c3.z * c0.w;
+    auto t3 = c1.z * c2.w - c2.z * c1.w;
+    auto t4 = c1.z * c3.w - c3.z * c1.w;
+    auto t5 = c2.z * c3.w - c3.z * c2.w;
+    auto det = s0 * t5 - s1 * t4 + s2 * t3 + s3 * t2 - s4 * t1 + s5 * t0;
+    OBERON_ASSERT(det != 0.0f);
+    auto inv = 1.0f / det;
+    auto result = mat4{ };
+    result.columns[0] = {
+      ( c1.y * t5 - c2.y * t4 + c3.y * t3) * inv,
+      (-c0.y * t5 + c2.y * t2 - c3.y * t1) * inv,
+      ( c0.y * t4 - c1.y * t2 + c3.y * t0) * inv,
+      (-c0.y * t3 + c1.y * t1 - c2.y * t0) * inv
+    };
+    result.columns[1] = {
+      (-c1.x * t5 + c2.x * t4 - c3.x * t3) * inv,
+      ( c0.x * t5 - c2.x * t2 + c3.x * t1) * inv,
+      (-c0.x * t4 + c1.x * t2 - c3.x * t0) * inv,
+      ( c0.x * t3 - c1.x * t1 + c2.x * t0) * inv
+    };
+    result.columns[2] = {
+      ( c1.w * s5 - c2.w * s4 + c3.w * s3) * inv,
+      (-c0.w * s5 + c2.w * s2 - c3.w * s1) * inv,
+      ( c0.w * s4 - c1.w * s2 + c3.w * s0) * inv,
+      (-c0.w * s3 + c1.w * s1 - c2.w * s0) * inv
+    };
+    result.columns[3] = {
+      (-c1.z * s5 + c2.z * s4 - c3.z * s3) * inv,
+      ( c0.z * s5 - c2.z * s2 + c3.z * s1) * inv,
+      (-c0.z * s4 + c1.z * s2 - c3.z * s0) * inv,
+      ( c0.z * s3 - c1.z * s1 + c2.z * s0) * inv
+    };
+    return result;
+  }
+
+  mat4 look_at(const vec3& eye, const vec3& target, const vec3& up) noexcept {
+    auto f = normalize(target - eye);
+    auto s = normalize(cross(f, up));
+    auto u = cross(s, f);
+    return { { {
+      { s.x, u.x, -f.x, 0.0f },
+      { s.y, u.y, -f.y, 0.0f },
+      { s.z, u.z, -f.z, 0.0f },
+      { -dot(s, eye), -dot(u, eye), dot(f, eye), 1.0f }
+    } } };
+  }
+
+  mat4 perspective(const f32 fov_y, const f32 aspect, const f32 near_plane, const f32 far_plane) noexcept {
+    OBERON_PRECONDITION(aspect > 0.0f);
+    OBERON_PRECONDITION(near_plane > 0.0f && far_plane > near_plane);
+    auto focal_length = 1.0f / std::tan(fov_y * 0.5f);
+    auto depth_scale = far_plane / (near_plane - far_plane);
+    // Vulkan's clip space y axis points down.
+    return { { {
+      { focal_length / aspect, 0.0f, 0.0f, 0.0f },
+      { 0.0f, -focal_length, 0.0f, 0.0f },
+      { 0.0f, 0.0f, depth_scale, -1.0f },
+      { 0.0f, 0.0f, near_plane * depth_scale, 0.0f }
+    } } };
+  }
+
+  quat nlerp(const quat& from, const quat& to, const f32 t) noexcept {
+    // Interpolate along the shorter arc.
+    auto sign = dot(from, to) < 0.0f ? -1.0f : 1.0f;
+    auto result = quat{
+      from.x + (to.x * sign - from.x) * t,
+      from.y + (to.y * sign - from.y) * t,
+      from.z + (to.z * sign - from.z) * t,
+      from.w + (to.w * sign - from.w) * t
+    };
+    return normalize(result);
+  }
+
+  quat slerp(const quat& from, const quat& to, const f32 t) noexcept {
+    auto cos_theta = dot(from, to);
+    auto sign = 1.0f;
+    if (cos_theta < 0.0f)
+    {
+      cos_theta = -cos_theta;
+      sign = -1.0f;
+    }
+    // Nearly parallel rotations divide by almost zero below.
+    if (cos_theta > 0.9995f)
+    {
+      return nlerp(from, to, t);
+    }
+    auto theta = std::acos(cos_theta);
+    auto sin_theta = std::sin(theta);
+    auto a = std::sin((1.0f - t) * theta) / sin_theta;
+    auto b = std::sin(t * theta) / sin_theta * sign;
+    return { from.x * a + to.x * b, from.y * a + to.y * b, from.z * a + to.z * b, from.w * a + to.w * b };
+  }
+
+  simd_level max_simd_level() noexcept {
+    static const auto level = detect_simd_level();
+    return level;
+  }
+
+  simd_level current_simd_level() noexcept {
+    // Make sure the default has been selected.
+    kernels();
+    return g_simd_level.load(std::memory_order_relaxed);
+  }
+
+  void set_simd_level(const simd_level level) noexcept {
+    auto clamped = std::min(level, max_simd_level());
+    g_simd_level.store(clamped, std::memory_order_relaxed);
+    g_kernels.store(select_kernels(clamped), std::memory_order_relaxed);
+  }
+
+  void multiply_mat4(const std::span<const mat4> lhs, const std::span<const mat4> rhs,
+                     const std::span<mat4> out) noexcept {
+    OBERON_PRECONDITION(std::size(lhs) == std::size(out) && std::size(rhs) == std::size(out));
+    kernels().multiply_mat4(std::data(lhs), std::data(rhs), std::data(out), std::size(out));
+  }
+
+  void transform_vec4(const mat4& m, const std::span<const vec4> in, const std::span<vec4> out) noexcept {
+    OBERON_PRECONDITION(std::size(in) == std::size(out));
+    kernels().transform_vec4(m, std::data(in), std::data(out), std::size(out));
+  }
+
+  void transform_points(const mat4& m, const std::span<const f32> x, const std::span<const f32> y,
+                        const std::span<const f32> z, const std::span<f32> out_x, const std::span<f32> out_y,
+                        const std::span<f32> out_z) noexcept {
+    OBERON_PRECONDITION(std::size(x) == std::size(out_x) && std::size(y) == std::size(out_x));
+    OBERON_PRECONDITION(std::size(z) == std::size(out_x) && std::size(out_y) == std::size(out_x));
+    OBERON_PRECONDITION(std::size(out_z) == std::size(out_x));
+    kernels().transform_points(m, std::data(x), std::data(y), std::data(z), std::data(out_x), std::data(out_y),
+                               std::data(out_z), std::size(out_x));
+  }
+
+}
+
+#undef OBERON_TARGET_SSE4
+#undef OBERON_TARGET_AVX2
+#undef OBERON_MATH_X86
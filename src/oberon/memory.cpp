@@ -0,0 +1,182 @@
+#include "oberon/memory.hpp"
+
+#include <cstddef>
+
+#include <algorithm>
+
+#include "oberon/debug.hpp"
+
+namespace oberon {
+
+namespace {
+
+  constexpr usize MAX_ALIGNMENT{ alignof(std::max_align_t) };
+
+  constexpr usize align_up(const usize value, const usize alignment) noexcept {
+    return (value + alignment - 1) & ~(alignment - 1);
+  }
+
+}
+
+  struct alignas(std::max_align_t) linear_arena::block final {
+    ptr<block> next{ };
+    usize capacity{ };
+
+    ptr<std::byte> data() noexcept {
+      return reinterpret_cast<ptr<std::byte>>(this + 1);
+    }
+  };
+
+  linear_arena::linear_arena(const usize block_size) :
+  linear_arena{ block_size, std::pmr::get_default_resource() } { }
+
+  linear_arena::linear_arena(const usize block_size, const ptr<std::pmr::memory_resource> upstream) :
+  m_upstream{ upstream }, m_block_size{ block_size } {
+    OBERON_PRECONDITION(upstream);
+    OBERON_PRECONDITION(block_size > 0);
+  }
+
+  linear_arena::~linear_arena() noexcept {
+    release();
+  }
+
+  ptr<void> linear_arena::do_allocate(const usize bytes, const usize alignment) {
+    // Try the current block and then any blocks retained from before the last reset.
+    for (auto cur = m_current; cur; cur = cur->next)
+    {
+      auto base = reinterpret_cast<uptr>(cur->data());
+      auto offset = cur == m_current ? m_offset : 0;
+      auto start = align_up(base + offset, alignment) - base;
+      if (start + bytes <= cur->capacity)
+      {
+        m_current = cur;
+        m_offset = start + bytes;
+        return cur->data() + start;
+      }
+    }
+    auto capacity = std::max(m_block_size, bytes + alignment);
+    auto memory = m_upstream->allocate(sizeof(block) + capacity, alignof(block));
+    auto new_block = new (memory) block{ nullptr, capacity };
+    // Link the new block after the current block so that skipped blocks are reused after the next reset.
+    if (m_current)
+    {
+      new_block->next = m_current->next;
+      m_current->next = new_block;
+    }
+    else
+    {
+      m_first = new_block;
+    }
+    m_current = new_block;
+    auto base = reinterpret_cast<uptr>(new_block->data());
+    auto start = align_up(base, alignment) - base;
+    m_offset = start + bytes;
+    return new_block->data() + start;
+  }
+
+  void linear_arena::do_deallocate(const ptr<void>, const usize, const usize) noexcept { }
+
+  bool linear_arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+  }
+
+  void linear_arena::reset() noexcept {
+    m_current = m_first;
+    m_offset = 0;
+  }
+
+  void linear_arena::release() noexcept {
+    while (m_first)
+    {
+      auto next = m_first->next;
+      m_upstream->deallocate(m_first, sizeof(block) + m_first->capacity, alignof(block));
+      m_first = next;
+    }
+    m_current = nullptr;
+    m_offset = 0;
+  }
+
+  usize linear_arena::capacity() const noexcept {
+    auto result = usize{ 0 };
+    for (auto cur = m_first; cur; cur = cur->next)
+    {
+      result += cur->capacity;
+    }
+    return result;
+  }
+
+  struct alignas(std::max_align_t) block_pool::chunk final {
+    ptr<chunk> next{ };
+  };
+
+  struct block_pool::free_block final {
+    ptr<free_block> next{ };
+  };
+
+  block_pool::block_pool(const usize block_size, const usize blocks_per_chunk) :
+  block_pool{ block_size, blocks_per_chunk, std::pmr::get_default_resource() } { }
+
+  block_pool::block_pool(
+    const usize block_size,
+    const usize blocks_per_chunk,
+    const ptr<std::pmr::memory_resource> upstream
+  ) : m_upstream{ upstream }, m_block_size{ align_up(std::max(block_size, sizeof(free_block)), MAX_ALIGNMENT) },
+  m_blocks_per_chunk{ blocks_per_chunk } {
+    OBERON_PRECONDITION(upstream);
+    OBERON_PRECONDITION(blocks_per_chunk > 0);
+  }
+
+  block_pool::~block_pool() noexcept {
+    release();
+  }
+
+  ptr<void> block_pool::do_allocate(const usize bytes, const usize alignment) {
+    if (bytes > m_block_size || alignment > MAX_ALIGNMENT)
+    {
+      return m_upstream->allocate(bytes, alignment);
+    }
+    if (!m_free_blocks)
+    {
+      auto chunk_size = sizeof(chunk) + m_block_size * m_blocks_per_chunk;
+      auto new_chunk = new (m_upstream->allocate(chunk_size, alignof(chunk))) chunk{ m_chunks };
+      m_chunks = new_chunk;
+      auto data = reinterpret_cast<ptr<std::byte>>(new_chunk + 1);
+      for (auto i = m_blocks_per_chunk; i > 0; --i)
+      {
+        m_free_blocks = new (data + (i - 1) * m_block_size) free_block{ m_free_blocks };
+      }
+    }
+    auto result = m_free_blocks;
+    m_free_blocks = result->next;
+    return result;
+  }
+
+  void block_pool::do_deallocate(const ptr<void> memory, const usize bytes, const usize alignment) noexcept {
+    if (bytes > m_block_size || alignment > MAX_ALIGNMENT)
+    {
+      m_upstream->deallocate(memory, bytes, alignment);
+      return;
+    }
+    m_free_blocks = new (memory) free_block{ m_free_blocks };
+  }
+
+  bool block_pool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+  }
+
+  void block_pool::release() noexcept {
+    auto chunk_size = sizeof(chunk) + m_block_size * m_blocks_per_chunk;
+    while (m_chunks)
+    {
+      auto next = m_chunks->next;
+      m_upstream->deallocate(m_chunks, chunk_size, alignof(chunk));
+      m_chunks = next;
+    }
+    m_free_blocks = nullptr;
+  }
+
+  usize block_pool::block_size() const noexcept {
+    return m_block_size;
+  }
+
+}
@@ -2,11 +2,17 @@
 
 #include <cstring>
 
+#include <algorithm>
+#include <functional>
+#include <thread>
+
 #include "oberon/errors.hpp"
 #include "oberon/debug.hpp"
+#include "oberon/trace.hpp"
 
 #include "oberon/detail/context_impl.hpp"
 #include "oberon/detail/window_impl.hpp"
+#include "oberon/detail/debug_labels.hpp"
 
 namespace oberon {
 namespace detail {
@@ -97,6 +103,12 @@ namespace {
     OBERON_INIT_VK_STRUCT(swapchain_info, SWAPCHAIN_CREATE_INFO_KHR);
     swapchain_info.surface = win.surface;
     swapchain_info.minImageCount = rnd.surface_capabilities.minImageCount + 1;
+    // The present thread acquires the next image of a slot before the other slot's image has been presented. Vulkan
+    // only guarantees that imageCount - minImageCount images can be acquired at once.
+    if (rnd.requested_execution == frame_execution::pipelined)
+    {
+      swapchain_info.minImageCount = rnd.surface_capabilities.minImageCount + MAX_FRAMES_IN_FLIGHT;
+    }
     if (rnd.surface_capabilities.maxImageCount && swapchain_info.minImageCount > rnd.surface_capabilities.maxImageCount)
     {
       swapchain_info.minImageCount = rnd.surface_capabilities.maxImageCount;
@@ -105,6 +117,11 @@ namespace {
     // This should be selected by user input instead of the library.
     // Personally I think offer these as FIFO, FIFO Relaxed, Immediate, and Mailbox are better than
     // Offering them as Vsync, Double/triple buffering, etc.
+    {
+      auto& modes = rnd.presentation_modes;
+      auto pos = std::find(std::begin(modes), std::end(modes), rnd.requested_presentation_mode);
+      rnd.current_presentation_mode = pos != std::end(modes) ? *pos : VK_PRESENT_MODE_FIFO_KHR;
+    }
     swapchain_info.presentMode = rnd.current_presentation_mode;
     // This will probably be finicky.
     if (rnd.current_surface_format.format == VK_FORMAT_UNDEFINED)
@@ -148,7 +165,7 @@ namespace {
     // Should this ever be any other value?
     swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapchain_info.clipped = true;
-    if (auto result = vkCreateSwapchainKHR(ctx.device, &swapchain_info, nullptr, &rnd.swapchain);
+    if (auto result = vkCreateSwapchainKHR(ctx.device, &swapchain_info, ctx.host_allocator, &rnd.swapchain);
         result != VK_SUCCESS)
     {
       return result;
@@ -161,6 +178,7 @@ namespace {
       result = vkGetSwapchainImagesKHR(ctx.device, rnd.swapchain, &sz, std::data(rnd.swapchain_images));
       OBERON_ASSERT(result == VK_SUCCESS);
     }
+    OBERON_NAME_VK_OBJECT(ctx, SWAPCHAIN_KHR, rnd.swapchain, "oberon swapchain");
     {
       rnd.swapchain_image_views.resize(std::size(rnd.swapchain_images));
       auto image_view_info = VkImageViewCreateInfo{ };
@@ -176,17 +194,21 @@ namespace {
       image_view_info.subresourceRange.layerCount = 1;
       image_view_info.subresourceRange.baseMipLevel = 0;
       image_view_info.subresourceRange.levelCount = 1;
-      for (auto cur = std::begin(rnd.swapchain_image_views); const auto& swapchain_image : rnd.swapchain_images)
+      for (auto i = usize{ 0 }; i < std::size(rnd.swapchain_images); ++i)
       {
-        image_view_info.image = swapchain_image;
-        auto& image_view = *(cur++);
-        if (auto result = vkCreateImageView(ctx.device, &image_view_info, nullptr, &image_view); result != VK_SUCCESS)
+        image_view_info.image = rnd.swapchain_images[i];
+        auto& image_view = rnd.swapchain_image_views[i];
+        if (auto result = vkCreateImageView(ctx.device, &image_view_info, ctx.host_allocator, &image_view);
+            result != VK_SUCCESS)
         {
           return result;
         }
+        OBERON_NAME_VK_OBJECT(ctx, IMAGE, rnd.swapchain_images[i], "oberon swapchain image %zu", i);
+        OBERON_NAME_VK_OBJECT(ctx, IMAGE_VIEW, image_view, "oberon swapchain image view %zu", i);
       }
     }
-    rnd.in_flight_images.resize(std::size(rnd.swapchain_images), VK_NULL_HANDLE);
+    rnd.in_flight_images.assign(std::size(rnd.swapchain_images), { });
+    rnd.swapchain_present_id_base = rnd.present_id;
     OBERON_POSTCONDITION(rnd.swapchain);
     OBERON_POSTCONDITION(std::size(rnd.swapchain_images) > 0);
     OBERON_POSTCONDITION(std::size(rnd.swapchain_images) == std::size(rnd.swapchain_image_views));
@@ -224,11 +246,12 @@ namespace {
     subpass_description.colorAttachmentCount = 1;
     renderpass_info.pSubpasses = &subpass_description;
     renderpass_info.subpassCount = 1;
-    auto result = vkCreateRenderPass(ctx.device, &renderpass_info, nullptr, &rnd.main_renderpass);
+    auto result = vkCreateRenderPass(ctx.device, &renderpass_info, ctx.host_allocator, &rnd.main_renderpass);
     if (result != VK_SUCCESS)
     {
       return result;
     }
+    OBERON_NAME_VK_OBJECT(ctx, RENDER_PASS, rnd.main_renderpass, "oberon main render pass");
     OBERON_POSTCONDITION(rnd.main_renderpass);
     return 0;
   }
@@ -250,17 +273,28 @@ namespace {
     OBERON_PRECONDITION(ctx.device);
     OBERON_PRECONDITION(ctx.vkft.vkCreateCommandPool);
     OBERON_PRECONDITION(!rnd.graphics_transfer_command_pool);
+    OBERON_PRECONDITION(!rnd.bundle_command_pool);
     auto vkCreateCommandPool = ctx.vkft.vkCreateCommandPool;
     auto command_pool_info = VkCommandPoolCreateInfo{ };
     OBERON_INIT_VK_STRUCT(command_pool_info, COMMAND_POOL_CREATE_INFO);
     command_pool_info.queueFamilyIndex = ctx.graphics_transfer_queue_family;
     command_pool_info.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-    auto result = vkCreateCommandPool(ctx.device, &command_pool_info, nullptr, &rnd.graphics_transfer_command_pool);
+    auto result = vkCreateCommandPool(ctx.device, &command_pool_info, ctx.host_allocator,
+                                      &rnd.graphics_transfer_command_pool);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    OBERON_NAME_VK_OBJECT(ctx, COMMAND_POOL, rnd.graphics_transfer_command_pool, "oberon graphics transfer pool");
+    command_pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    result = vkCreateCommandPool(ctx.device, &command_pool_info, ctx.host_allocator, &rnd.bundle_command_pool);
     if (result != VK_SUCCESS)
     {
       return result;
     }
+    OBERON_NAME_VK_OBJECT(ctx, COMMAND_POOL, rnd.bundle_command_pool, "oberon bundle pool");
     OBERON_POSTCONDITION(rnd.graphics_transfer_command_pool);
+    OBERON_POSTCONDITION(rnd.bundle_command_pool);
     return 0;
   }
 
@@ -270,10 +304,16 @@ namespace {
     auto vkDestroyCommandPool = ctx.vkft.vkDestroyCommandPool;
     if (rnd.graphics_transfer_command_pool)
     {
-      vkDestroyCommandPool(ctx.device, rnd.graphics_transfer_command_pool, nullptr);
+      vkDestroyCommandPool(ctx.device, rnd.graphics_transfer_command_pool, ctx.host_allocator);
       rnd.graphics_transfer_command_pool = nullptr;
     }
+    if (rnd.bundle_command_pool)
+    {
+      vkDestroyCommandPool(ctx.device, rnd.bundle_command_pool, ctx.host_allocator);
+      rnd.bundle_command_pool = nullptr;
+    }
     OBERON_POSTCONDITION(!rnd.graphics_transfer_command_pool);
+    OBERON_POSTCONDITION(!rnd.bundle_command_pool);
     return 0;
   }
 
@@ -295,6 +335,11 @@ namespace {
     {
       return result;
     }
+    for (auto i = usize{ 0 }; i < std::size(rnd.graphics_transfer_command_buffers); ++i)
+    {
+      OBERON_NAME_VK_OBJECT(ctx, COMMAND_BUFFER, rnd.graphics_transfer_command_buffers[i],
+                            "oberon frame %zu command buffer", i);
+    }
     OBERON_POSTCONDITION(std::size(rnd.graphics_transfer_command_buffers) == MAX_FRAMES_IN_FLIGHT);
     return 0;
   }
@@ -336,14 +381,15 @@ namespace {
       framebuffer_info.width = rnd.current_swapchain_extent.width;
       framebuffer_info.height = rnd.current_swapchain_extent.height;
       auto result = VkResult{ };
-      for (auto& framebuffer : rnd.framebuffers)
+      for (auto i = usize{ 0 }; i < std::size(rnd.framebuffers); ++i)
       {
         color_attachment = *(current_color_view++);
-        result = vkCreateFramebuffer(ctx.device, &framebuffer_info, nullptr, &framebuffer);
+        result = vkCreateFramebuffer(ctx.device, &framebuffer_info, ctx.host_allocator, &rnd.framebuffers[i]);
         if (result != VK_SUCCESS)
         {
           return result;
         }
+        OBERON_NAME_VK_OBJECT(ctx, FRAMEBUFFER, rnd.framebuffers[i], "oberon main framebuffer %zu", i);
       }
     }
     OBERON_POSTCONDITION(std::size(rnd.framebuffers) > 0);
@@ -358,7 +404,7 @@ namespace {
     auto vkCreatePipelineCache = ctx.vkft.vkCreatePipelineCache;
     auto pipeline_cache_info = VkPipelineCacheCreateInfo{ };
     OBERON_INIT_VK_STRUCT(pipeline_cache_info, PIPELINE_CACHE_CREATE_INFO);
-    auto result = vkCreatePipelineCache(ctx.device, &pipeline_cache_info, nullptr, &rnd.pipeline_cache);
+    auto result = vkCreatePipelineCache(ctx.device, &pipeline_cache_info, ctx.host_allocator, &rnd.pipeline_cache);
     if (result != VK_SUCCESS)
     {
       return result;
@@ -373,139 +419,206 @@ namespace {
     auto vkDestroyPipelineCache = ctx.vkft.vkDestroyPipelineCache;
     if (rnd.pipeline_cache)
     {
-      vkDestroyPipelineCache(ctx.device, rnd.pipeline_cache, nullptr);
+      vkDestroyPipelineCache(ctx.device, rnd.pipeline_cache, ctx.host_allocator);
       rnd.pipeline_cache = nullptr;
     }
     OBERON_POSTCONDITION(!rnd.pipeline_cache);
     return 0;
   }
 
-  iresult configure_test_frame_pipeline(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+  iresult acquire_reflected_pipeline_layout(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const builtin_shader_layout& layout,
+    VkPipelineLayout& pipeline_layout
+  ) noexcept {
     OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkCreateShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateDescriptorSetLayout);
     OBERON_PRECONDITION(ctx.vkft.vkCreatePipelineLayout);
-    auto vkCreateShaderModule = ctx.vkft.vkCreateShaderModule;
+    auto vkCreateDescriptorSetLayout = ctx.vkft.vkCreateDescriptorSetLayout;
     auto vkCreatePipelineLayout = ctx.vkft.vkCreatePipelineLayout;
-    auto& config = rnd.graphics_pipeline_configs[static_cast<usize>(builtin_shader_name::test_frame)];
-    // Begin GFX pipeline config
-    OBERON_INIT_VK_STRUCT(config.graphics_pipeline_info, GRAPHICS_PIPELINE_CREATE_INFO);
-    // Shader stages
-    auto pipeline_shader_stage_info = VkPipelineShaderStageCreateInfo{ };
-    OBERON_INIT_VK_STRUCT(pipeline_shader_stage_info, PIPELINE_SHADER_STAGE_CREATE_INFO);
-    pipeline_shader_stage_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    auto module_info = VkShaderModuleCreateInfo{ };
-    OBERON_INIT_VK_STRUCT(module_info, SHADER_MODULE_CREATE_INFO);
-    OBERON_GET_VERTEX_BINARY(test_frame, module_info.pCode, module_info.codeSize);
-    auto result = vkCreateShaderModule(ctx.device, &module_info, nullptr, &pipeline_shader_stage_info.module);
-    if (result != VK_SUCCESS)
+    auto set_layouts = arena_vector<VkDescriptorSetLayout>(std::size(layout.descriptor_sets), &rnd.frame_arena);
+    for (auto cur = std::begin(set_layouts); const auto& set : layout.descriptor_sets)
     {
-      return result;
+      auto [itr, is_new] = rnd.descriptor_set_layouts.try_emplace(set.key, VkDescriptorSetLayout{ });
+      if (is_new)
+      {
+        auto bindings = arena_vector<VkDescriptorSetLayoutBinding>(std::size(set.bindings), &rnd.frame_arena);
+        for (auto cur = std::begin(bindings); const auto& binding : set.bindings)
+        {
+          *cur = VkDescriptorSetLayoutBinding{ };
+          cur->binding = binding.binding;
+          cur->descriptorType = binding.type;
+          cur->descriptorCount = binding.count;
+          cur->stageFlags = binding.stages;
+          ++cur;
+        }
+        auto set_layout_info = VkDescriptorSetLayoutCreateInfo{ };
+        OBERON_INIT_VK_STRUCT(set_layout_info, DESCRIPTOR_SET_LAYOUT_CREATE_INFO);
+        set_layout_info.pBindings = std::data(bindings);
+        set_layout_info.bindingCount = std::size(bindings);
+        auto result = vkCreateDescriptorSetLayout(ctx.device, &set_layout_info, ctx.host_allocator, &itr->second);
+        if (result != VK_SUCCESS)
+        {
+          rnd.descriptor_set_layouts.erase(itr);
+          return result;
+        }
+        OBERON_NAME_VK_OBJECT(ctx, DESCRIPTOR_SET_LAYOUT, itr->second, "oberon descriptor set layout %016llx",
+                              static_cast<unsigned long long>(set.key));
+      }
+      *(cur++) = itr->second;
     }
-    pipeline_shader_stage_info.pName = "main";
-    config.pipeline_stages.push_back(pipeline_shader_stage_info);
-    pipeline_shader_stage_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    OBERON_GET_FRAGMENT_BINARY(test_frame, module_info.pCode, module_info.codeSize);
-    result = vkCreateShaderModule(ctx.device, &module_info, nullptr, &pipeline_shader_stage_info.module);
-    if (result != VK_SUCCESS)
+    auto [itr, is_new] = rnd.pipeline_layouts.try_emplace(layout.key, VkPipelineLayout{ });
+    if (is_new)
     {
-      return result;
+      auto pipeline_layout_info = VkPipelineLayoutCreateInfo{ };
+      OBERON_INIT_VK_STRUCT(pipeline_layout_info, PIPELINE_LAYOUT_CREATE_INFO);
+      pipeline_layout_info.pSetLayouts = std::data(set_layouts);
+      pipeline_layout_info.setLayoutCount = std::size(set_layouts);
+      pipeline_layout_info.pPushConstantRanges = std::data(layout.push_constant_ranges);
+      pipeline_layout_info.pushConstantRangeCount = std::size(layout.push_constant_ranges);
+      auto result = vkCreatePipelineLayout(ctx.device, &pipeline_layout_info, ctx.host_allocator, &itr->second);
+      if (result != VK_SUCCESS)
+      {
+        rnd.pipeline_layouts.erase(itr);
+        return result;
+      }
+      OBERON_NAME_VK_OBJECT(ctx, PIPELINE_LAYOUT, itr->second, "oberon pipeline layout %016llx",
+                            static_cast<unsigned long long>(layout.key));
     }
-    config.pipeline_stages.push_back(pipeline_shader_stage_info);
-    config.graphics_pipeline_info.pStages = std::data(config.pipeline_stages);
-    config.graphics_pipeline_info.stageCount = std::size(config.pipeline_stages);
-    // Vertex Inputs
-    OBERON_INIT_VK_STRUCT(config.vertex_input_state_info, PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO);
-    config.graphics_pipeline_info.pVertexInputState = &config.vertex_input_state_info;
-    // Input Assembly
-    OBERON_INIT_VK_STRUCT(config.input_assembly_state_info, PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO);
-    config.input_assembly_state_info.primitiveRestartEnable = false;
-    config.input_assembly_state_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    config.graphics_pipeline_info.pInputAssemblyState = &config.input_assembly_state_info;
-    // No Tessellation
-    // Viewports
-    OBERON_INIT_VK_STRUCT(config.viewport_state_info, PIPELINE_VIEWPORT_STATE_CREATE_INFO);
-    auto viewport = VkViewport{ };
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = static_cast<f32>(rnd.current_swapchain_extent.width);
-    viewport.height = static_cast<f32>(rnd.current_swapchain_extent.height);
-    config.viewports.push_back(viewport);
-    auto scissor = VkRect2D{ };
-    scissor.offset = { 0, 0 };
-    scissor.extent = rnd.current_swapchain_extent;
-    config.scissors.push_back(scissor);
-    config.viewport_state_info.pViewports = std::data(config.viewports);
-    config.viewport_state_info.viewportCount = std::size(config.viewports);
-    config.viewport_state_info.pScissors = std::data(config.scissors);
-    config.viewport_state_info.scissorCount = std::size(config.scissors);
-    config.graphics_pipeline_info.pViewportState = &config.viewport_state_info;
-    // Rasterization
-    OBERON_INIT_VK_STRUCT(config.rasterization_state_info, PIPELINE_RASTERIZATION_STATE_CREATE_INFO);
-    config.rasterization_state_info.cullMode = VK_CULL_MODE_BACK_BIT;
-    config.rasterization_state_info.polygonMode = VK_POLYGON_MODE_FILL;
-    config.rasterization_state_info.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    config.rasterization_state_info.lineWidth = 1.0f;
-    config.graphics_pipeline_info.pRasterizationState = &config.rasterization_state_info;
-    // Multisampling
-    OBERON_INIT_VK_STRUCT(config.multisample_state_info, PIPELINE_MULTISAMPLE_STATE_CREATE_INFO);
-    config.multisample_state_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    config.graphics_pipeline_info.pMultisampleState = &config.multisample_state_info;
-    // No Depth-Stencil
-    // Color Blending
-    OBERON_INIT_VK_STRUCT(config.color_blend_state_info, PIPELINE_COLOR_BLEND_STATE_CREATE_INFO);
-    auto color_blend_attachment = VkPipelineColorBlendAttachmentState{ };
-    color_blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                                            VK_COLOR_COMPONENT_G_BIT |
-                                            VK_COLOR_COMPONENT_B_BIT |
-                                            VK_COLOR_COMPONENT_A_BIT;
-    color_blend_attachment.blendEnable = true;
-    color_blend_attachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    color_blend_attachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    color_blend_attachment.colorBlendOp = VK_BLEND_OP_ADD;
-    color_blend_attachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    color_blend_attachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    color_blend_attachment.alphaBlendOp = VK_BLEND_OP_ADD;
-    config.color_blend_attachments.push_back(color_blend_attachment);
-    config.color_blend_state_info.pAttachments = std::data(config.color_blend_attachments);
-    config.color_blend_state_info.attachmentCount = std::size(config.color_blend_attachments);
-    config.graphics_pipeline_info.pColorBlendState = &config.color_blend_state_info;
-    // No Dynamic States
-    OBERON_INIT_VK_STRUCT(config.pipeline_layout_info, PIPELINE_LAYOUT_CREATE_INFO);
-    result = vkCreatePipelineLayout(ctx.device, &config.pipeline_layout_info, nullptr,
-                                    &config.graphics_pipeline_info.layout);
-    if (result != VK_SUCCESS)
+    pipeline_layout = itr->second;
+    OBERON_POSTCONDITION(pipeline_layout);
+    return 0;
+  }
+
+  iresult configure_builtin_pipeline(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize pipeline_index,
+    const builtin_shader_name shader,
+    const readonly_ptr<VkSpecializationInfo> specialization
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateShaderModule);
+    OBERON_PRECONDITION(pipeline_index < std::size(rnd.graphics_pipeline_configs));
+    auto vkCreateShaderModule = ctx.vkft.vkCreateShaderModule;
+    const auto& layout = get_builtin_shader_layout(shader);
+    const auto& description = get_builtin_pipeline_description(shader);
+    const auto stages = get_builtin_shader_stages(shader);
+    OBERON_PRECONDITION(std::size(stages) <= MAX_GRAPHICS_PIPELINE_STAGES);
+    OBERON_PRECONDITION(description.viewport_state);
+    auto& config = rnd.graphics_pipeline_configs[pipeline_index];
+    for (auto cur = std::begin(config.pipeline_stages); const auto& stage : stages)
+    {
+      OBERON_INIT_VK_STRUCT(*cur, PIPELINE_SHADER_STAGE_CREATE_INFO);
+      cur->stage = stage.stage;
+      cur->pName = "main";
+      cur->pSpecializationInfo = specialization;
+      auto module_info = VkShaderModuleCreateInfo{ };
+      OBERON_INIT_VK_STRUCT(module_info, SHADER_MODULE_CREATE_INFO);
+      // The embedded words are used in place. Nothing is copied.
+      module_info.pCode = std::data(stage.code);
+      module_info.codeSize = std::size(stage.code) * sizeof(u32);
+      auto result = vkCreateShaderModule(ctx.device, &module_info, ctx.host_allocator, &cur->module);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      ++cur;
+    }
+    auto& info = config.graphics_pipeline_info;
+    OBERON_INIT_VK_STRUCT(info, GRAPHICS_PIPELINE_CREATE_INFO);
+    info.pStages = std::data(config.pipeline_stages);
+    info.stageCount = std::size(stages);
+    info.pVertexInputState = description.vertex_input_state;
+    info.pInputAssemblyState = description.input_assembly_state;
+    info.pTessellationState = description.tessellation_state;
+    info.pViewportState = description.viewport_state;
+    info.pRasterizationState = description.rasterization_state;
+    info.pMultisampleState = description.multisample_state;
+    info.pDepthStencilState = description.depth_stencil_state;
+    info.pColorBlendState = description.color_blend_state;
+    info.pDynamicState = description.dynamic_state;
+    if (auto result = acquire_reflected_pipeline_layout(ctx, rnd, layout, info.layout); result)
     {
       return result;
     }
-    // Final Configuration
     OBERON_POSTCONDITION(config.graphics_pipeline_info.layout);
     return 0;
   }
 
+  iresult configure_builtin_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(std::size(rnd.graphics_pipeline_configs) == BUILTIN_PIPELINE_COUNT);
+    for (auto i = usize{ 0 }; i < BUILTIN_SHADER_COUNT; ++i)
+    {
+      auto shader = static_cast<builtin_shader_name>(i);
+      if (is_builtin_compute_shader(shader))
+      {
+        continue;
+      }
+      if (auto result = configure_builtin_pipeline(ctx, rnd, builtin_pipeline_index(shader), shader, nullptr); result)
+      {
+        return result;
+      }
+    }
+    for (auto i = usize{ 0 }; i < BUILTIN_SHADER_VARIANT_COUNT; ++i)
+    {
+      auto variant = static_cast<builtin_shader_variant>(i);
+      const auto& info = get_builtin_shader_variant_info(variant);
+      OBERON_ASSERT(!is_builtin_compute_shader(info.shader));
+      // Every override must name a 32 bit constant declared by the shader.
+      const auto& constants = get_builtin_shader_layout(info.shader).specialization_constants;
+      for (const auto& value : info.values)
+      {
+        OBERON_ASSERT(std::any_of(std::begin(constants), std::end(constants), [&value](const auto& constant) {
+          return constant.constant_id == value.constant_id && constant.size == sizeof(u32);
+        }));
+      }
+      auto result = configure_builtin_pipeline(ctx, rnd, builtin_pipeline_index(variant), info.shader,
+                                               &info.specialization_info);
+      if (result)
+      {
+        return result;
+      }
+    }
+    return 0;
+  }
+
   iresult create_vulkan_graphics_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
     OBERON_PRECONDITION(ctx.device);
     OBERON_PRECONDITION(ctx.vkft.vkCreateGraphicsPipelines);
     OBERON_PRECONDITION(rnd.pipeline_cache);
     auto vkCreateGraphicsPipelines = ctx.vkft.vkCreateGraphicsPipelines;
-    auto configs = std::vector<VkGraphicsPipelineCreateInfo>(std::size(rnd.graphics_pipeline_configs));
-    for (auto cur = std::begin(configs); auto& config : rnd.graphics_pipeline_configs)
+    auto configs = arena_vector<VkGraphicsPipelineCreateInfo>(&rnd.frame_arena);
+    auto indices = arena_vector<usize>(&rnd.frame_arena);
+    configs.reserve(std::size(rnd.graphics_pipeline_configs));
+    indices.reserve(std::size(rnd.graphics_pipeline_configs));
+    // Viewports and scissors are dynamic so only the render pass changes when the swapchain is rebuilt. Compute
+    // shaders have empty configurations and their graphics pipelines stay null.
+    for (auto i = usize{ 0 }; i < std::size(rnd.graphics_pipeline_configs); ++i)
     {
-      if (config.graphics_pipeline_info.pViewportState)
+      auto& config = rnd.graphics_pipeline_configs[i];
+      if (!config.graphics_pipeline_info.stageCount)
       {
-        config.viewports[0].width = rnd.current_swapchain_extent.width;
-        config.viewports[0].height = rnd.current_swapchain_extent.height;
-        config.scissors[0].extent = rnd.current_swapchain_extent;
+        continue;
       }
       config.graphics_pipeline_info.renderPass = rnd.main_renderpass;
       config.graphics_pipeline_info.subpass = 0;
-      *(cur++) = config.graphics_pipeline_info;
+      configs.push_back(config.graphics_pipeline_info);
+      indices.push_back(i);
     }
+    auto pipelines = arena_vector<VkPipeline>(std::size(configs), &rnd.frame_arena);
     auto result = vkCreateGraphicsPipelines(ctx.device, rnd.pipeline_cache, std::size(configs), std::data(configs),
-                                            nullptr, std::data(rnd.graphics_pipelines));
+                                            ctx.host_allocator, std::data(pipelines));
     if (result != VK_SUCCESS)
     {
       return result;
     }
+    for (auto i = usize{ 0 }; i < std::size(pipelines); ++i)
+    {
+      rnd.graphics_pipelines[indices[i]] = pipelines[i];
+      OBERON_NAME_VK_OBJECT(ctx, PIPELINE, pipelines[i], "oberon builtin graphics pipeline %zu", indices[i]);
+    }
     return 0;
   }
 
@@ -513,10 +626,116 @@ namespace {
     OBERON_PRECONDITION(ctx.device);
     OBERON_PRECONDITION(ctx.vkft.vkDestroyPipeline);
     auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
-    for (const auto& pipeline : rnd.graphics_pipelines)
+    for (auto& pipeline : rnd.graphics_pipelines)
+    {
+      vkDestroyPipeline(ctx.device, pipeline, ctx.host_allocator);
+      pipeline = nullptr;
+    }
+    return 0;
+  }
+
+  iresult create_vulkan_compute_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateComputePipelines);
+    OBERON_PRECONDITION(rnd.pipeline_cache);
+    OBERON_PRECONDITION(std::size(rnd.compute_pipelines) == BUILTIN_SHADER_COUNT);
+    auto vkCreateShaderModule = ctx.vkft.vkCreateShaderModule;
+    auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
+    auto vkCreateComputePipelines = ctx.vkft.vkCreateComputePipelines;
+    for (auto i = usize{ 0 }; i < BUILTIN_SHADER_COUNT; ++i)
+    {
+      auto shader = static_cast<builtin_shader_name>(i);
+      if (!is_builtin_compute_shader(shader))
+      {
+        continue;
+      }
+      const auto& stage = get_builtin_shader_stages(shader).front();
+      const auto& layout = get_builtin_shader_layout(shader);
+      auto& pipeline = rnd.compute_pipelines[i];
+      if (auto result = acquire_reflected_pipeline_layout(ctx, rnd, layout, pipeline.layout); result)
+      {
+        return result;
+      }
+      auto module_info = VkShaderModuleCreateInfo{ };
+      OBERON_INIT_VK_STRUCT(module_info, SHADER_MODULE_CREATE_INFO);
+      module_info.pCode = std::data(stage.code);
+      module_info.codeSize = std::size(stage.code) * sizeof(u32);
+      auto pipeline_info = VkComputePipelineCreateInfo{ };
+      OBERON_INIT_VK_STRUCT(pipeline_info, COMPUTE_PIPELINE_CREATE_INFO);
+      OBERON_INIT_VK_STRUCT(pipeline_info.stage, PIPELINE_SHADER_STAGE_CREATE_INFO);
+      pipeline_info.stage.stage = stage.stage;
+      pipeline_info.stage.pName = "main";
+      pipeline_info.layout = pipeline.layout;
+      auto result = vkCreateShaderModule(ctx.device, &module_info, ctx.host_allocator, &pipeline_info.stage.module);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      result = vkCreateComputePipelines(ctx.device, rnd.pipeline_cache, 1, &pipeline_info, ctx.host_allocator,
+                                        &pipeline.pipeline);
+      vkDestroyShaderModule(ctx.device, pipeline_info.stage.module, ctx.host_allocator);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      OBERON_NAME_VK_OBJECT(ctx, PIPELINE, pipeline.pipeline, "oberon builtin compute pipeline %zu", i);
+    }
+    return 0;
+  }
+
+  iresult destroy_vulkan_compute_pipelines(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyPipeline);
+    auto vkDestroyPipeline = ctx.vkft.vkDestroyPipeline;
+    // Layouts belong to the shared layout cache.
+    for (auto& pipeline : rnd.compute_pipelines)
+    {
+      vkDestroyPipeline(ctx.device, pipeline.pipeline, ctx.host_allocator);
+      pipeline = { };
+    }
+    return 0;
+  }
+
+  iresult create_vulkan_descriptor_pools(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateDescriptorPool);
+    auto vkCreateDescriptorPool = ctx.vkft.vkCreateDescriptorPool;
+    // Culling binds the bounds and the draws. Drawing binds the transforms.
+    auto pool_size = VkDescriptorPoolSize{ };
+    pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    pool_size.descriptorCount = 3 * MAX_CULLED_BATCHES;
+    auto pool_info = VkDescriptorPoolCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(pool_info, DESCRIPTOR_POOL_CREATE_INFO);
+    pool_info.maxSets = 2 * MAX_CULLED_BATCHES;
+    pool_info.pPoolSizes = &pool_size;
+    pool_info.poolSizeCount = 1;
+    for (auto i = usize{ 0 }; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+      auto result = vkCreateDescriptorPool(ctx.device, &pool_info, ctx.host_allocator, &rnd.descriptor_pools[i]);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      OBERON_NAME_VK_OBJECT(ctx, DESCRIPTOR_POOL, rnd.descriptor_pools[i], "oberon frame descriptor pool %zu", i);
+    }
+    return 0;
+  }
+
+  iresult destroy_vulkan_descriptor_pools(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyDescriptorPool);
+    auto vkDestroyDescriptorPool = ctx.vkft.vkDestroyDescriptorPool;
+    for (auto& pool : rnd.descriptor_pools)
     {
-      vkDestroyPipeline(ctx.device, pipeline, nullptr);
+      if (pool)
+      {
+        vkDestroyDescriptorPool(ctx.device, pool, ctx.host_allocator);
+        pool = nullptr;
+      }
     }
+    rnd.culled_batches.clear();
     return 0;
   }
 
@@ -524,18 +743,31 @@ namespace {
     OBERON_PRECONDITION(ctx.device);
     OBERON_PRECONDITION(ctx.vkft.vkDestroyShaderModule);
     OBERON_PRECONDITION(ctx.vkft.vkDestroyPipelineLayout);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyDescriptorSetLayout);
     auto vkDestroyShaderModule = ctx.vkft.vkDestroyShaderModule;
     auto vkDestroyPipelineLayout = ctx.vkft.vkDestroyPipelineLayout;
+    auto vkDestroyDescriptorSetLayout = ctx.vkft.vkDestroyDescriptorSetLayout;
     for (auto& config : rnd.graphics_pipeline_configs)
     {
-      for (auto& pipeline_stage : config.pipeline_stages)
+      for (auto i = u32{ 0 }; i < config.graphics_pipeline_info.stageCount; ++i)
       {
-        vkDestroyShaderModule(ctx.device, pipeline_stage.module, nullptr);
+        vkDestroyShaderModule(ctx.device, config.pipeline_stages[i].module, ctx.host_allocator);
       }
-      vkDestroyPipelineLayout(ctx.device, config.graphics_pipeline_info.layout, nullptr);
     }
     rnd.graphics_pipeline_configs.clear();
+    // Layouts are shared between configurations so they're destroyed once here.
+    for (const auto& [key, pipeline_layout] : rnd.pipeline_layouts)
+    {
+      vkDestroyPipelineLayout(ctx.device, pipeline_layout, ctx.host_allocator);
+    }
+    rnd.pipeline_layouts.clear();
+    for (const auto& [key, set_layout] : rnd.descriptor_set_layouts)
+    {
+      vkDestroyDescriptorSetLayout(ctx.device, set_layout, ctx.host_allocator);
+    }
+    rnd.descriptor_set_layouts.clear();
     OBERON_POSTCONDITION(!std::size(rnd.graphics_pipeline_configs));
+    OBERON_POSTCONDITION(!std::size(rnd.pipeline_layouts));
     return 0;
   }
 
@@ -547,7 +779,7 @@ namespace {
     {
       if (framebuffer)
       {
-        vkDestroyFramebuffer(ctx.device, framebuffer, nullptr);
+        vkDestroyFramebuffer(ctx.device, framebuffer, ctx.host_allocator);
       }
     }
     rnd.framebuffers.resize(0);
@@ -561,7 +793,7 @@ namespace {
     auto vkDestroyRenderPass = ctx.vkft.vkDestroyRenderPass;
     if (rnd.main_renderpass)
     {
-      vkDestroyRenderPass(ctx.device, rnd.main_renderpass, nullptr);
+      vkDestroyRenderPass(ctx.device, rnd.main_renderpass, ctx.host_allocator);
       rnd.main_renderpass = nullptr;
     }
     return 0;
@@ -580,9 +812,9 @@ namespace {
 
     for (const auto& swapchain_image_view : rnd.swapchain_image_views)
     {
-      vkDestroyImageView(ctx.device, swapchain_image_view, nullptr);
+      vkDestroyImageView(ctx.device, swapchain_image_view, ctx.host_allocator);
     }
-    vkDestroySwapchainKHR(ctx.device, rnd.swapchain, nullptr);
+    vkDestroySwapchainKHR(ctx.device, rnd.swapchain, ctx.host_allocator);
     rnd.swapchain_images.resize(0);
     rnd.swapchain_image_views.resize(0);
     rnd.in_flight_images.resize(0);
@@ -591,343 +823,1823 @@ namespace {
     return 0;
   }
 
-  iresult begin_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+  iresult create_vulkan_timestamp_queries(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
     OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkBeginCommandBuffer);
-    OBERON_PRECONDITION(ctx.vkft.vkResetCommandBuffer);
-    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
-    auto vkResetCommandBuffer = ctx.vkft.vkResetCommandBuffer;
-    auto vkBeginCommandBuffer = ctx.vkft.vkBeginCommandBuffer;
-    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
-    auto result = vkResetCommandBuffer(command_buffer, 0);
-    if (result != VK_SUCCESS)
+    OBERON_PRECONDITION(ctx.vkft.vkGetPhysicalDeviceQueueFamilyProperties);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateQueryPool);
+    OBERON_PRECONDITION(!rnd.timestamp_query_pool);
+    auto vkGetPhysicalDeviceQueueFamilyProperties = ctx.vkft.vkGetPhysicalDeviceQueueFamilyProperties;
+    auto vkCreateQueryPool = ctx.vkft.vkCreateQueryPool;
+    // Without calibration GPU timestamps can't be placed on the same timeline as CPU zones.
+    if (!ctx.has_calibrated_timestamps)
     {
-      return result;
+      return 0;
     }
-    auto buffer_begin_info = VkCommandBufferBeginInfo{ };
-    OBERON_INIT_VK_STRUCT(buffer_begin_info, COMMAND_BUFFER_BEGIN_INFO);
-    //for (auto& command_buffer : rnd.graphics_transfer_command_buffers)
     {
-      result = vkBeginCommandBuffer(command_buffer, &buffer_begin_info);
-      if (result != VK_SUCCESS)
+      auto sz = u32{ 0 };
+      vkGetPhysicalDeviceQueueFamilyProperties(ctx.physical_device, &sz, nullptr);
+      auto queue_families = std::vector<VkQueueFamilyProperties>(sz);
+      vkGetPhysicalDeviceQueueFamilyProperties(ctx.physical_device, &sz, std::data(queue_families));
+      rnd.timestamp_valid_bits = queue_families[ctx.graphics_transfer_queue_family].timestampValidBits;
+      if (!rnd.timestamp_valid_bits)
       {
-        return result;
+        return 0;
       }
     }
+    auto query_pool_info = VkQueryPoolCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(query_pool_info, QUERY_POOL_CREATE_INFO);
+    query_pool_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    query_pool_info.queryCount = 2 * MAX_FRAMES_IN_FLIGHT;
+    auto result = vkCreateQueryPool(ctx.device, &query_pool_info, ctx.host_allocator, &rnd.timestamp_query_pool);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    OBERON_NAME_VK_OBJECT(ctx, QUERY_POOL, rnd.timestamp_query_pool, "oberon frame timestamps");
+    rnd.has_frame_timestamps = { };
+    OBERON_POSTCONDITION(rnd.timestamp_query_pool);
     return 0;
   }
 
-  iresult end_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkEndCommandBuffer);
-    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
-    auto vkEndCommandBuffer = ctx.vkft.vkEndCommandBuffer;
-    auto result = VK_SUCCESS;
-    //for (auto& command_buffer : rnd.graphics_transfer_command_buffers)
-    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+  iresult write_frame_begin_timestamp(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.vkft.vkCmdResetQueryPool);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdWriteTimestamp);
+    auto vkCmdResetQueryPool = ctx.vkft.vkCmdResetQueryPool;
+    auto vkCmdWriteTimestamp = ctx.vkft.vkCmdWriteTimestamp;
+    rnd.has_frame_timestamps[rnd.frame_index] = rnd.timestamp_query_pool && is_trace_active();
+    if (!rnd.has_frame_timestamps[rnd.frame_index])
     {
-      result = vkEndCommandBuffer(command_buffer);
-      if (result != VK_SUCCESS)
-      {
-        return result;
-      }
+      return 0;
     }
+    auto command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    auto first_query = static_cast<u32>(2 * rnd.frame_index);
+    vkCmdResetQueryPool(command_buffer, rnd.timestamp_query_pool, first_query, 2);
+    vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, rnd.timestamp_query_pool, first_query);
     return 0;
   }
 
-  iresult begin_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkCmdBeginRenderPass);
-    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
-    auto vkCmdBeginRenderPass = ctx.vkft.vkCmdBeginRenderPass;
-    auto render_pass_info = VkRenderPassBeginInfo{ };
-    OBERON_INIT_VK_STRUCT(render_pass_info, RENDER_PASS_BEGIN_INFO);
-    render_pass_info.renderPass = rnd.main_renderpass;
-    render_pass_info.renderArea = { { 0, 0 }, rnd.current_swapchain_extent };
-    auto clear_value = VkClearValue{ };
-    std::fill(std::begin(clear_value.color.float32), std::end(clear_value.color.float32) - 1, 0.2f);
-    clear_value.color.float32[3] = 1.0f;
-    render_pass_info.pClearValues = &clear_value;
-    render_pass_info.clearValueCount = 1;
-    render_pass_info.framebuffer = rnd.framebuffers[rnd.acquired_image_index];
-    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
-    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+  iresult write_frame_end_timestamp(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.vkft.vkCmdWriteTimestamp);
+    auto vkCmdWriteTimestamp = ctx.vkft.vkCmdWriteTimestamp;
+    if (!rnd.has_frame_timestamps[rnd.frame_index])
+    {
+      return 0;
+    }
+    vkCmdWriteTimestamp(rnd.graphics_transfer_command_buffers[rnd.frame_index], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        rnd.timestamp_query_pool, static_cast<u32>(2 * rnd.frame_index + 1));
     return 0;
   }
 
-  iresult end_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkCmdEndRenderPass);
-    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
-    auto vkCmdEndRenderPass = ctx.vkft.vkCmdEndRenderPass;
-    vkCmdEndRenderPass(rnd.graphics_transfer_command_buffers[rnd.frame_index]);
-    return 0;
+  iresult reserve_frame_instance_buffer(const context_impl& ctx, renderer_3d_impl& rnd, const usize size) noexcept {
+    OBERON_PRECONDITION(size > 0);
+    auto& instance_buffer = rnd.instance_buffers[rnd.frame_index];
+    auto current_size = usize{ 0 };
+    {
+      auto lock = std::lock_guard{ rnd.resources.mutex };
+      if (auto buffer_size = rnd.resources.buffers.find<BUFFER_COLUMN_SIZE>(instance_buffer.value()); buffer_size)
+      {
+        current_size = *buffer_size;
+      }
+    }
+    if (current_size >= size)
+    {
+      return 0;
+    }
+    if (instance_buffer)
+    {
+      destroy_registry_buffer(rnd.resources, instance_buffer);
+      instance_buffer = { };
+    }
+    return create_registry_buffer(ctx, rnd.resources, std::max(size, 2 * current_size),
+                                  BUFFER_USAGE_VERTEX_BIT | BUFFER_USAGE_STORAGE_BIT, memory_location::host,
+                                  instance_buffer);
   }
 
-  iresult draw_test_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkCmdBindPipeline);
-    OBERON_PRECONDITION(ctx.vkft.vkCmdDraw);
-    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
-    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
-    auto vkCmdBindPipeline = ctx.vkft.vkCmdBindPipeline;
-    auto vkCmdDraw = ctx.vkft.vkCmdDraw;
-    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
-    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                      rnd.graphics_pipelines[static_cast<usize>(builtin_shader_name::test_frame)]);
-    vkCmdDraw(command_buffer, 3, 1, 0, 0);
+namespace {
+
+  // Matches cull_parameters in cull_instances.comp.
+  struct cull_parameters final {
+    std::array<vec4, 6> planes{ };
+    u32 instance_count{ };
+    u32 index_count{ };
+    u32 first_index{ };
+    i32 vertex_offset{ };
+  };
+
+  static_assert(sizeof(cull_parameters) == 112);
+
+  // Allocate a set for the first descriptor set of a builtin shader from the current frame's pool. Each storage
+  // buffer binding is pointed at the corresponding entry of buffers in binding order.
+  iresult allocate_storage_buffer_set(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const builtin_shader_name shader,
+    const std::span<const VkDescriptorBufferInfo> buffers,
+    VkDescriptorSet& set
+  ) noexcept {
+    auto vkAllocateDescriptorSets = ctx.vkft.vkAllocateDescriptorSets;
+    auto vkUpdateDescriptorSets = ctx.vkft.vkUpdateDescriptorSets;
+    const auto& descriptor_set = get_builtin_shader_layout(shader).descriptor_sets.front();
+    OBERON_ASSERT(std::size(descriptor_set.bindings) == std::size(buffers));
+    auto set_layout = rnd.descriptor_set_layouts.find(descriptor_set.key);
+    OBERON_ASSERT(set_layout != std::end(rnd.descriptor_set_layouts));
+    auto allocate_info = VkDescriptorSetAllocateInfo{ };
+    OBERON_INIT_VK_STRUCT(allocate_info, DESCRIPTOR_SET_ALLOCATE_INFO);
+    allocate_info.descriptorPool = rnd.descriptor_pools[rnd.frame_index];
+    allocate_info.pSetLayouts = &set_layout->second;
+    allocate_info.descriptorSetCount = 1;
+    auto result = vkAllocateDescriptorSets(ctx.device, &allocate_info, &set);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    auto writes = arena_vector<VkWriteDescriptorSet>(std::size(buffers), &rnd.frame_arena);
+    for (auto i = usize{ 0 }; i < std::size(buffers); ++i)
+    {
+      OBERON_INIT_VK_STRUCT(writes[i], WRITE_DESCRIPTOR_SET);
+      writes[i].dstSet = set;
+      writes[i].dstBinding = descriptor_set.bindings[i].binding;
+      writes[i].descriptorCount = 1;
+      writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      writes[i].pBufferInfo = &buffers[i];
+    }
+    vkUpdateDescriptorSets(ctx.device, std::size(writes), std::data(writes), 0, nullptr);
     return 0;
   }
 
-  iresult create_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkCreateSemaphore);
-    OBERON_PRECONDITION(ctx.vkft.vkCreateFence);
-    OBERON_PRECONDITION(!std::size(rnd.image_available_semaphores));
-    OBERON_PRECONDITION(!std::size(rnd.render_complete_semaphores));
-    OBERON_PRECONDITION(!std::size(rnd.in_flight_fences));
-    auto vkCreateSemaphore = ctx.vkft.vkCreateSemaphore;
-    auto vkCreateFence = ctx.vkft.vkCreateFence;
-    rnd.image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    rnd.render_complete_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    rnd.in_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
-    auto semaphore_info = VkSemaphoreCreateInfo{ };
-    OBERON_INIT_VK_STRUCT(semaphore_info, SEMAPHORE_CREATE_INFO);
-    auto fence_info = VkFenceCreateInfo{ };
-    OBERON_INIT_VK_STRUCT(fence_info, FENCE_CREATE_INFO);
-    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-    auto result = VK_SUCCESS;
-    for (auto i = usize{ 0 }; i < MAX_FRAMES_IN_FLIGHT; ++i)
+  // Find room for size bytes at the end of the current frame's indirect buffer. A full buffer is replaced by a device
+  // buffer at least twice its size. The old buffer is retired so batches already culled this frame are unaffected.
+  iresult reserve_indirect_region(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const VkDeviceSize size,
+    VkBuffer& buffer,
+    VkDeviceSize& offset
+  ) noexcept {
+    auto& indirect_buffer = rnd.indirect_buffers[rnd.frame_index];
+    // Every region is bound as a storage buffer.
+    auto alignment = ctx.physical_device_properties.limits.minStorageBufferOffsetAlignment;
+    offset = (rnd.indirect_buffer_offset + alignment - 1) / alignment * alignment;
+    auto current_size = VkDeviceSize{ 0 };
     {
-      result = vkCreateSemaphore(ctx.device, &semaphore_info, nullptr, &rnd.image_available_semaphores[i]);
-      if (result != VK_SUCCESS)
+      auto lock = std::lock_guard{ rnd.resources.mutex };
+      if (auto buffer_size = rnd.resources.buffers.find<BUFFER_COLUMN_SIZE>(indirect_buffer.value()); buffer_size)
       {
-        return result;
+        current_size = *buffer_size;
       }
-      result = vkCreateSemaphore(ctx.device, &semaphore_info, nullptr, &rnd.render_complete_semaphores[i]);
-      if (result != VK_SUCCESS)
+    }
+    if (offset + size > current_size)
+    {
+      if (indirect_buffer)
       {
-        return result;
+        destroy_registry_buffer(rnd.resources, indirect_buffer);
+        indirect_buffer = { };
       }
-      result = vkCreateFence(ctx.device, &fence_info, nullptr, &rnd.in_flight_fences[i]);
-      if (result != VK_SUCCESS)
+      auto result = create_registry_buffer(ctx, rnd.resources, std::max(size, 2 * current_size),
+                                           BUFFER_USAGE_STORAGE_BIT | BUFFER_USAGE_INDIRECT_BIT |
+                                           BUFFER_USAGE_TRANSFER_DESTINATION_BIT, memory_location::device,
+                                           indirect_buffer);
+      if (result)
       {
         return result;
       }
+      offset = 0;
     }
-    OBERON_POSTCONDITION(std::size(rnd.image_available_semaphores) == std::size(rnd.render_complete_semaphores));
-    OBERON_POSTCONDITION(std::size(rnd.in_flight_fences) == std::size(rnd.image_available_semaphores));
+    {
+      auto lock = std::lock_guard{ rnd.resources.mutex };
+      buffer = *rnd.resources.buffers.find<BUFFER_COLUMN_HANDLE>(indirect_buffer.value());
+    }
+    rnd.indirect_buffer_offset = offset + size;
     return 0;
   }
 
-  iresult destroy_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkDestroySemaphore);
-    OBERON_PRECONDITION(ctx.vkft.vkDestroyFence);
-    OBERON_PRECONDITION(std::size(rnd.image_available_semaphores) == std::size(rnd.render_complete_semaphores));
+  // Resolve a buffer that shaders read as a storage buffer of at least size bytes. Returns null if the handle is
+  // stale, the buffer is too small, or it wasn't created with BUFFER_USAGE_STORAGE_BIT. reg.mutex *must* be held.
+  VkBuffer find_storage_buffer(
+    const resource_registry& reg,
+    const buffer_handle buffer,
+    const VkDeviceSize size
+  ) noexcept {
+    auto handle = reg.buffers.find<BUFFER_COLUMN_HANDLE>(buffer.value());
+    if (!handle || *reg.buffers.find<BUFFER_COLUMN_SIZE>(buffer.value()) < size ||
+        !(*reg.buffers.find<BUFFER_COLUMN_USAGE>(buffer.value()) & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))
+    {
+      return nullptr;
+    }
+    return *handle;
+  }
+
+}
+
+  iresult reset_frame_culling(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkResetDescriptorPool);
+    OBERON_PRECONDITION(rnd.descriptor_pools[rnd.frame_index]);
+    auto vkResetDescriptorPool = ctx.vkft.vkResetDescriptorPool;
+    rnd.culled_batches.clear();
+    rnd.indirect_buffer_offset = 0;
+    return vkResetDescriptorPool(ctx.device, rnd.descriptor_pools[rnd.frame_index], 0);
+  }
+
+  iresult cull_mesh_instances(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const mesh_handle mesh,
+    const buffer_handle bounds,
+    const buffer_handle transforms,
+    const u32 instance_count,
+    const frustum& f,
+    usize& batch
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdFillBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdPipelineBarrier);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindPipeline);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindDescriptorSets);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdPushConstants);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdDispatch);
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    OBERON_PRECONDITION(!rnd.is_main_render_pass_open);
+    auto vkCmdFillBuffer = ctx.vkft.vkCmdFillBuffer;
+    auto vkCmdPipelineBarrier = ctx.vkft.vkCmdPipelineBarrier;
+    auto vkCmdBindPipeline = ctx.vkft.vkCmdBindPipeline;
+    auto vkCmdBindDescriptorSets = ctx.vkft.vkCmdBindDescriptorSets;
+    auto vkCmdPushConstants = ctx.vkft.vkCmdPushConstants;
+    auto vkCmdDispatch = ctx.vkft.vkCmdDispatch;
+    const auto& pipeline = rnd.compute_pipelines[static_cast<usize>(builtin_shader_name::cull_instances)];
+    const auto& layout = get_builtin_shader_layout(builtin_shader_name::cull_instances);
+    const auto& limits = ctx.physical_device_properties.limits;
+    auto workgroup_size = layout.workgroup_size[0];
+    auto group_count = (u64{ instance_count } + workgroup_size - 1) / workgroup_size;
+    // Every range is bound as a single storage buffer descriptor.
+    auto bounds_size = VkDeviceSize{ instance_count } * sizeof(vec4);
+    auto transforms_size = VkDeviceSize{ instance_count } * sizeof(mat4);
+    auto region_size = sizeof(u32) + VkDeviceSize{ instance_count } * sizeof(VkDrawIndexedIndirectCommand);
+    auto max_range = VkDeviceSize{ limits.maxStorageBufferRange };
+    if (!instance_count || std::size(rnd.culled_batches) >= MAX_CULLED_BATCHES ||
+        group_count > limits.maxComputeWorkGroupCount[0] || bounds_size > max_range || transforms_size > max_range ||
+        region_size > max_range)
+    {
+      return -1;
+    }
+    auto parameters = cull_parameters{ f.planes, instance_count, 0, 0, 0 };
+    auto culled = culled_batch{ };
+    culled.max_draw_count = instance_count;
+    auto bounds_buffer = VkBuffer{ };
+    auto transforms_buffer = VkBuffer{ };
+    {
+      auto lock = std::lock_guard{ rnd.resources.mutex };
+      const auto& reg = rnd.resources;
+      auto vertices = reg.meshes.find<MESH_COLUMN_VERTICES>(mesh.value());
+      if (!vertices)
+      {
+        return -1;
+      }
+      auto indices = *reg.meshes.find<MESH_COLUMN_INDICES>(mesh.value());
+      parameters.index_count = *reg.meshes.find<MESH_COLUMN_INDEX_COUNT>(mesh.value());
+      parameters.vertex_offset = *reg.meshes.find<MESH_COLUMN_VERTEX_OFFSET>(mesh.value());
+      // A mesh doesn't own its buffers so they may have been destroyed since it was created.
+      auto vertex_buffer = reg.buffers.find<BUFFER_COLUMN_HANDLE>(vertices->value());
+      auto index_buffer = reg.buffers.find<BUFFER_COLUMN_HANDLE>(indices.value());
+      bounds_buffer = find_storage_buffer(reg, bounds, bounds_size);
+      transforms_buffer = find_storage_buffer(reg, transforms, transforms_size);
+      if (!vertex_buffer || !index_buffer || !bounds_buffer || !transforms_buffer)
+      {
+        return -1;
+      }
+      culled.vertices = *vertex_buffer;
+      culled.indices = *index_buffer;
+    }
+    if (auto result = reserve_indirect_region(ctx, rnd, region_size, culled.draws, culled.draws_offset); result)
+    {
+      return result;
+    }
+    auto cull_set = VkDescriptorSet{ };
+    {
+      auto buffers = std::array<VkDescriptorBufferInfo, 2>{ {
+        { bounds_buffer, 0, bounds_size },
+        { culled.draws, culled.draws_offset, region_size }
+      } };
+      auto result = allocate_storage_buffer_set(ctx, rnd, builtin_shader_name::cull_instances, buffers, cull_set);
+      if (result)
+      {
+        return result;
+      }
+    }
+    {
+      auto buffers = std::array<VkDescriptorBufferInfo, 1>{ { { transforms_buffer, 0, transforms_size } } };
+      auto result = allocate_storage_buffer_set(ctx, rnd, builtin_shader_name::culled_mesh, buffers,
+                                                culled.transforms);
+      if (result)
+      {
+        return result;
+      }
+    }
+    auto command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    OBERON_BEGIN_VK_LABEL(ctx, command_buffer, "cull instances");
+    vkCmdFillBuffer(command_buffer, culled.draws, culled.draws_offset, sizeof(u32), 0);
+    auto barrier = VkMemoryBarrier{ };
+    OBERON_INIT_VK_STRUCT(barrier, MEMORY_BARRIER);
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1,
+                         &barrier, 0, nullptr, 0, nullptr);
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.pipeline);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.layout, 0, 1, &cull_set, 0,
+                            nullptr);
+    vkCmdPushConstants(command_buffer, pipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(parameters),
+                       &parameters);
+    vkCmdDispatch(command_buffer, static_cast<u32>(group_count), 1, 1);
+    OBERON_END_VK_LABEL(ctx, command_buffer);
+    batch = std::size(rnd.culled_batches);
+    rnd.culled_batches.push_back(culled);
+    return 0;
+  }
+
+  iresult draw_culled_batch(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize batch,
+    const mat4& view_projection
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindPipeline);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindDescriptorSets);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdPushConstants);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindVertexBuffers);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindIndexBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdDrawIndexedIndirectCount);
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    OBERON_PRECONDITION(batch < std::size(rnd.culled_batches));
+    auto vkCmdBindPipeline = ctx.vkft.vkCmdBindPipeline;
+    auto vkCmdBindDescriptorSets = ctx.vkft.vkCmdBindDescriptorSets;
+    auto vkCmdPushConstants = ctx.vkft.vkCmdPushConstants;
+    auto vkCmdBindVertexBuffers = ctx.vkft.vkCmdBindVertexBuffers;
+    auto vkCmdBindIndexBuffer = ctx.vkft.vkCmdBindIndexBuffer;
+    auto vkCmdDrawIndexedIndirectCount = ctx.vkft.vkCmdDrawIndexedIndirectCount;
+    begin_main_render_pass(ctx, rnd);
+    const auto& culled = rnd.culled_batches[batch];
+    auto pipeline_index = builtin_pipeline_index(builtin_shader_name::culled_mesh);
+    auto layout = rnd.graphics_pipeline_configs[pipeline_index].graphics_pipeline_info.layout;
+    auto command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    OBERON_BEGIN_VK_LABEL(ctx, command_buffer, "culled instances");
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, rnd.graphics_pipelines[pipeline_index]);
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &culled.transforms, 0,
+                            nullptr);
+    vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(view_projection),
+                       &view_projection);
+    auto vertex_offset = VkDeviceSize{ 0 };
+    vkCmdBindVertexBuffers(command_buffer, 0, 1, &culled.vertices, &vertex_offset);
+    vkCmdBindIndexBuffer(command_buffer, culled.indices, 0, VK_INDEX_TYPE_UINT32);
+    // The commands follow the count in the batch's region.
+    vkCmdDrawIndexedIndirectCount(command_buffer, culled.draws, culled.draws_offset + sizeof(u32), culled.draws,
+                                  culled.draws_offset, culled.max_draw_count, sizeof(VkDrawIndexedIndirectCommand));
+    OBERON_END_VK_LABEL(ctx, command_buffer);
+    return 0;
+  }
+
+  iresult collect_frame_timestamps(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkGetQueryPoolResults);
+    auto vkGetQueryPoolResults = ctx.vkft.vkGetQueryPoolResults;
+    auto vkGetCalibratedTimestampsEXT = ctx.vkft.vkGetCalibratedTimestampsEXT;
+    if (!rnd.has_frame_timestamps[rnd.frame_index])
+    {
+      return 0;
+    }
+    rnd.has_frame_timestamps[rnd.frame_index] = false;
+    OBERON_ASSERT(vkGetCalibratedTimestampsEXT);
+    auto timestamps = std::array<u64, 2>{ };
+    auto result = vkGetQueryPoolResults(ctx.device, rnd.timestamp_query_pool, static_cast<u32>(2 * rnd.frame_index),
+                                        std::size(timestamps), sizeof(timestamps), std::data(timestamps), sizeof(u64),
+                                        VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    // Calibrating every frame keeps drift between the clocks from accumulating over long traces.
+    auto calibration_infos = std::array<VkCalibratedTimestampInfoEXT, 2>{ };
+    auto& [ device_info, monotonic_info ] = calibration_infos;
+    OBERON_INIT_VK_STRUCT(device_info, CALIBRATED_TIMESTAMP_INFO_EXT);
+    device_info.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    OBERON_INIT_VK_STRUCT(monotonic_info, CALIBRATED_TIMESTAMP_INFO_EXT);
+    monotonic_info.timeDomain = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+    auto calibration = std::array<u64, 2>{ };
+    auto max_deviation = u64{ };
+    result = vkGetCalibratedTimestampsEXT(ctx.device, std::size(calibration_infos), std::data(calibration_infos),
+                                          std::data(calibration), &max_deviation);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    const auto& [ device_now, monotonic_now ] = calibration;
+    auto period = static_cast<f64>(ctx.physical_device_properties.limits.timestampPeriod);
+    // Bits above timestampValidBits are undefined and the counter wraps around below them. Unsigned subtraction
+    // followed by the mask gives the elapsed ticks across a wrap.
+    auto mask = rnd.timestamp_valid_bits < 64 ? (u64{ 1 } << rnd.timestamp_valid_bits) - 1 : -1ULL;
+    auto to_trace_time = [&](const u64 timestamp) {
+      auto elapsed = ((device_now & mask) - (timestamp & mask)) & mask;
+      return static_cast<i64>(monotonic_now) - static_cast<i64>(elapsed * period);
+    };
+    record_trace_event("GPU frame", trace_track::gpu, to_trace_time(timestamps[0]), to_trace_time(timestamps[1]));
+    return 0;
+  }
+
+  iresult destroy_vulkan_timestamp_queries(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyQueryPool);
+    auto vkDestroyQueryPool = ctx.vkft.vkDestroyQueryPool;
+    if (rnd.timestamp_query_pool)
+    {
+      vkDestroyQueryPool(ctx.device, rnd.timestamp_query_pool, ctx.host_allocator);
+      rnd.timestamp_query_pool = nullptr;
+      rnd.timestamp_valid_bits = 0;
+    }
+    rnd.has_frame_timestamps = { };
+    OBERON_POSTCONDITION(!rnd.timestamp_query_pool);
+    return 0;
+  }
+
+  iresult begin_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkBeginCommandBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkResetCommandBuffer);
+    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
+    auto vkResetCommandBuffer = ctx.vkft.vkResetCommandBuffer;
+    auto vkBeginCommandBuffer = ctx.vkft.vkBeginCommandBuffer;
+    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    auto result = vkResetCommandBuffer(command_buffer, 0);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    auto buffer_begin_info = VkCommandBufferBeginInfo{ };
+    OBERON_INIT_VK_STRUCT(buffer_begin_info, COMMAND_BUFFER_BEGIN_INFO);
+    //for (auto& command_buffer : rnd.graphics_transfer_command_buffers)
+    {
+      result = vkBeginCommandBuffer(command_buffer, &buffer_begin_info);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+    }
+    return 0;
+  }
+
+  iresult end_vulkan_command_buffers(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkEndCommandBuffer);
+    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
+    auto vkEndCommandBuffer = ctx.vkft.vkEndCommandBuffer;
+    auto result = VK_SUCCESS;
+    //for (auto& command_buffer : rnd.graphics_transfer_command_buffers)
+    auto& command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    {
+      result = vkEndCommandBuffer(command_buffer);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+    }
+    return 0;
+  }
+
+namespace {
+
+  void record_begin_main_render_pass(
+    const context_impl& ctx,
+    const renderer_3d_impl& rnd,
+    const VkCommandBuffer command_buffer,
+    const VkFramebuffer framebuffer
+  ) noexcept {
+    auto vkCmdBeginRenderPass = ctx.vkft.vkCmdBeginRenderPass;
+    auto vkCmdSetViewport = ctx.vkft.vkCmdSetViewport;
+    auto vkCmdSetScissor = ctx.vkft.vkCmdSetScissor;
+    auto render_pass_info = VkRenderPassBeginInfo{ };
+    OBERON_INIT_VK_STRUCT(render_pass_info, RENDER_PASS_BEGIN_INFO);
+    render_pass_info.renderPass = rnd.main_renderpass;
+    render_pass_info.renderArea = { { 0, 0 }, rnd.current_swapchain_extent };
+    auto clear_value = VkClearValue{ };
+    std::fill(std::begin(clear_value.color.float32), std::end(clear_value.color.float32) - 1, 0.2f);
+    clear_value.color.float32[3] = 1.0f;
+    render_pass_info.pClearValues = &clear_value;
+    render_pass_info.clearValueCount = 1;
+    render_pass_info.framebuffer = framebuffer;
+    OBERON_BEGIN_VK_LABEL(ctx, command_buffer, "main render pass");
+    vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    // Every builtin pipeline uses a dynamic viewport and scissor covering the whole swapchain image.
+    auto viewport = VkViewport{ };
+    viewport.width = static_cast<f32>(rnd.current_swapchain_extent.width);
+    viewport.height = static_cast<f32>(rnd.current_swapchain_extent.height);
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+    vkCmdSetScissor(command_buffer, 0, 1, &render_pass_info.renderArea);
+  }
+
+  void record_end_main_render_pass(const context_impl& ctx, const VkCommandBuffer command_buffer) noexcept {
+    auto vkCmdEndRenderPass = ctx.vkft.vkCmdEndRenderPass;
+    vkCmdEndRenderPass(command_buffer);
+    OBERON_END_VK_LABEL(ctx, command_buffer);
+  }
+
+  void record_test_frame(const context_impl& ctx, const renderer_3d_impl& rnd,
+                         const VkCommandBuffer command_buffer) noexcept {
+    auto vkCmdBindPipeline = ctx.vkft.vkCmdBindPipeline;
+    auto vkCmdDraw = ctx.vkft.vkCmdDraw;
+    OBERON_BEGIN_VK_LABEL(ctx, command_buffer, "test frame");
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                      rnd.graphics_pipelines[static_cast<usize>(builtin_shader_name::test_frame)]);
+    vkCmdDraw(command_buffer, 3, 1, 0, 0);
+    OBERON_END_VK_LABEL(ctx, command_buffer);
+  }
+
+}
+
+  iresult begin_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBeginRenderPass);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdPipelineBarrier);
+    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    auto vkCmdPipelineBarrier = ctx.vkft.vkCmdPipelineBarrier;
+    if (rnd.is_main_render_pass_open)
+    {
+      return 0;
+    }
+    auto command_buffer = rnd.graphics_transfer_command_buffers[rnd.frame_index];
+    if (!std::empty(rnd.culled_batches))
+    {
+      // One barrier covers every batch culled this frame.
+      auto barrier = VkMemoryBarrier{ };
+      OBERON_INIT_VK_STRUCT(barrier, MEMORY_BARRIER);
+      barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+      barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+      vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                           0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+    record_begin_main_render_pass(ctx, rnd, command_buffer, rnd.framebuffers[rnd.acquired_image_index]);
+    rnd.is_main_render_pass_open = true;
+    return 0;
+  }
+
+  iresult end_main_render_pass(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdEndRenderPass);
+    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
+    begin_main_render_pass(ctx, rnd);
+    record_end_main_render_pass(ctx, rnd.graphics_transfer_command_buffers[rnd.frame_index]);
+    rnd.is_main_render_pass_open = false;
+    return 0;
+  }
+
+  iresult draw_test_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdBindPipeline);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdDraw);
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    OBERON_PRECONDITION(std::size(rnd.graphics_transfer_command_buffers));
+    begin_main_render_pass(ctx, rnd);
+    record_test_frame(ctx, rnd, rnd.graphics_transfer_command_buffers[rnd.frame_index]);
+    return 0;
+  }
+
+  iresult begin_command_bundle(renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    rnd.bundles.emplace_back();
+    rnd.is_recording_bundle = true;
+    return 0;
+  }
+
+  usize end_command_bundle(renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(rnd.is_recording_bundle);
+    rnd.is_recording_bundle = false;
+    return std::size(rnd.bundles) - 1;
+  }
+
+  iresult record_command_bundle(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    command_bundle& bundle,
+    const u32 image_index
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkAllocateCommandBuffers);
+    OBERON_PRECONDITION(ctx.vkft.vkFreeCommandBuffers);
+    OBERON_PRECONDITION(ctx.vkft.vkBeginCommandBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkEndCommandBuffer);
+    OBERON_PRECONDITION(ctx.vkft.vkCmdEndRenderPass);
+    OBERON_PRECONDITION(rnd.bundle_command_pool);
+    OBERON_PRECONDITION(image_index < std::size(rnd.framebuffers));
+    auto vkAllocateCommandBuffers = ctx.vkft.vkAllocateCommandBuffers;
+    auto vkFreeCommandBuffers = ctx.vkft.vkFreeCommandBuffers;
+    auto vkBeginCommandBuffer = ctx.vkft.vkBeginCommandBuffer;
+    auto vkEndCommandBuffer = ctx.vkft.vkEndCommandBuffer;
+    if (std::size(bundle.command_buffers) != std::size(rnd.swapchain_images))
+    {
+      bundle.command_buffers.resize(std::size(rnd.swapchain_images), VK_NULL_HANDLE);
+      bundle.pipeline_generations.resize(std::size(rnd.swapchain_images));
+    }
+    auto& command_buffer = bundle.command_buffers[image_index];
+    auto& pipeline_generation = bundle.pipeline_generations[image_index];
+    if (command_buffer && pipeline_generation == rnd.pipeline_generation)
+    {
+      return 0;
+    }
+    if (command_buffer)
+    {
+      // Recorded with pipelines that have since been reloaded. Acquiring the image guarantees it isn't pending.
+      vkFreeCommandBuffers(ctx.device, rnd.bundle_command_pool, 1, &command_buffer);
+      command_buffer = VK_NULL_HANDLE;
+    }
+    OBERON_TRACE_ZONE("record bundle");
+    auto command_buffer_info = VkCommandBufferAllocateInfo{ };
+    OBERON_INIT_VK_STRUCT(command_buffer_info, COMMAND_BUFFER_ALLOCATE_INFO);
+    command_buffer_info.commandPool = rnd.bundle_command_pool;
+    command_buffer_info.commandBufferCount = 1;
+    command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    auto result = vkAllocateCommandBuffers(ctx.device, &command_buffer_info, &command_buffer);
+    if (result != VK_SUCCESS)
+    {
+      command_buffer = VK_NULL_HANDLE;
+      return result;
+    }
+    OBERON_NAME_VK_OBJECT(ctx, COMMAND_BUFFER, command_buffer, "oberon bundle %zu image %u command buffer",
+                          static_cast<usize>(&bundle - std::data(rnd.bundles)), image_index);
+    // No ONE_TIME_SUBMIT or SIMULTANEOUS_USE. Each image's buffer is resubmitted only after its last use retires.
+    auto buffer_begin_info = VkCommandBufferBeginInfo{ };
+    OBERON_INIT_VK_STRUCT(buffer_begin_info, COMMAND_BUFFER_BEGIN_INFO);
+    result = vkBeginCommandBuffer(command_buffer, &buffer_begin_info);
+    if (result == VK_SUCCESS)
+    {
+      record_begin_main_render_pass(ctx, rnd, command_buffer, rnd.framebuffers[image_index]);
+      for (const auto& command : bundle.commands)
+      {
+        switch (command.type)
+        {
+        case bundle_command_type::draw_test_frame:
+          record_test_frame(ctx, rnd, command_buffer);
+          break;
+        }
+      }
+      record_end_main_render_pass(ctx, command_buffer);
+      result = vkEndCommandBuffer(command_buffer);
+    }
+    if (result != VK_SUCCESS)
+    {
+      vkFreeCommandBuffers(ctx.device, rnd.bundle_command_pool, 1, &command_buffer);
+      command_buffer = VK_NULL_HANDLE;
+      return result;
+    }
+    pipeline_generation = rnd.pipeline_generation;
+    OBERON_POSTCONDITION(command_buffer);
+    return 0;
+  }
+
+  iresult invalidate_command_bundles(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkFreeCommandBuffers);
+    auto vkFreeCommandBuffers = ctx.vkft.vkFreeCommandBuffers;
+    for (auto& bundle : rnd.bundles)
+    {
+      for (auto& command_buffer : bundle.command_buffers)
+      {
+        if (command_buffer)
+        {
+          vkFreeCommandBuffers(ctx.device, rnd.bundle_command_pool, 1, &command_buffer);
+        }
+      }
+      bundle.command_buffers.resize(0);
+    }
+    return 0;
+  }
+
+  iresult destroy_command_bundle(const context_impl& ctx, renderer_3d_impl& rnd, command_bundle& bundle) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkFreeCommandBuffers);
+    auto vkFreeCommandBuffers = ctx.vkft.vkFreeCommandBuffers;
+    for (auto& command_buffer : bundle.command_buffers)
+    {
+      if (command_buffer)
+      {
+        vkFreeCommandBuffers(ctx.device, rnd.bundle_command_pool, 1, &command_buffer);
+      }
+    }
+    // Bundle indices are handed out to the application so the slot remains and presents an empty frame.
+    bundle = { };
+    return 0;
+  }
+
+  iresult create_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateSemaphore);
+    OBERON_PRECONDITION(ctx.vkft.vkCreateFence);
+    OBERON_PRECONDITION(!std::size(rnd.image_available_semaphores));
+    OBERON_PRECONDITION(!std::size(rnd.render_complete_semaphores));
+    OBERON_PRECONDITION(!std::size(rnd.in_flight_fences));
+    auto vkCreateSemaphore = ctx.vkft.vkCreateSemaphore;
+    auto vkCreateFence = ctx.vkft.vkCreateFence;
+    rnd.image_available_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    rnd.render_complete_semaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    rnd.in_flight_fences.resize(MAX_FRAMES_IN_FLIGHT);
+    auto semaphore_info = VkSemaphoreCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(semaphore_info, SEMAPHORE_CREATE_INFO);
+    auto fence_info = VkFenceCreateInfo{ };
+    OBERON_INIT_VK_STRUCT(fence_info, FENCE_CREATE_INFO);
+    fence_info.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+    auto result = VK_SUCCESS;
+    for (auto i = usize{ 0 }; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+      result = vkCreateSemaphore(ctx.device, &semaphore_info, ctx.host_allocator, &rnd.image_available_semaphores[i]);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      result = vkCreateSemaphore(ctx.device, &semaphore_info, ctx.host_allocator, &rnd.render_complete_semaphores[i]);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      result = vkCreateFence(ctx.device, &fence_info, ctx.host_allocator, &rnd.in_flight_fences[i]);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      OBERON_NAME_VK_OBJECT(ctx, SEMAPHORE, rnd.image_available_semaphores[i], "oberon frame %zu image available", i);
+      OBERON_NAME_VK_OBJECT(ctx, SEMAPHORE, rnd.render_complete_semaphores[i], "oberon frame %zu render complete", i);
+      OBERON_NAME_VK_OBJECT(ctx, FENCE, rnd.in_flight_fences[i], "oberon frame %zu in flight", i);
+    }
+    OBERON_POSTCONDITION(std::size(rnd.image_available_semaphores) == std::size(rnd.render_complete_semaphores));
+    OBERON_POSTCONDITION(std::size(rnd.in_flight_fences) == std::size(rnd.image_available_semaphores));
+    return 0;
+  }
+
+  iresult destroy_vulkan_synchronization_objects(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroySemaphore);
+    OBERON_PRECONDITION(ctx.vkft.vkDestroyFence);
+    OBERON_PRECONDITION(std::size(rnd.image_available_semaphores) == std::size(rnd.render_complete_semaphores));
     OBERON_PRECONDITION(std::size(rnd.in_flight_fences) == std::size(rnd.image_available_semaphores));
     auto vkDestroySemaphore = ctx.vkft.vkDestroySemaphore;
     auto vkDestroyFence = ctx.vkft.vkDestroyFence;
     for (auto i = usize{ 0 }; i < std::size(rnd.image_available_semaphores); ++i)
     {
-      vkDestroySemaphore(ctx.device, rnd.image_available_semaphores[i], nullptr);
-      vkDestroySemaphore(ctx.device, rnd.render_complete_semaphores[i], nullptr);
-      vkDestroyFence(ctx.device, rnd.in_flight_fences[i], nullptr);
+      vkDestroySemaphore(ctx.device, rnd.image_available_semaphores[i], ctx.host_allocator);
+      vkDestroySemaphore(ctx.device, rnd.render_complete_semaphores[i], ctx.host_allocator);
+      vkDestroyFence(ctx.device, rnd.in_flight_fences[i], ctx.host_allocator);
+    }
+    rnd.image_available_semaphores.resize(0);
+    rnd.render_complete_semaphores.resize(0);
+    rnd.in_flight_fences.resize(0);
+    return 0;
+  }
+
+  iresult pace_frame(const context_impl& ctx, const window_impl& win, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_TRACE_ZONE("pace frame");
+    auto period = rnd.frame_period;
+    switch (rnd.pacing)
+    {
+    case frame_pacing::refresh_rate:
+      if (win.refresh_rate <= 0.0)
+      {
+        return 0;
+      }
+      period = std::chrono::nanoseconds{ static_cast<i64>(1'000'000'000.0 / win.refresh_rate) };
+      break;
+    case frame_pacing::fixed_rate:
+      break;
+    default:
+      return 0;
+    }
+    auto present_id = rnd.present_id.load();
+    // vkWaitForPresentKHR requires external synchronization of the swapchain. The present thread owns it when the
+    // renderer is pipelined.
+    if (ctx.has_present_wait && !rnd.is_pipelined && present_id > rnd.swapchain_present_id_base)
+    {
+      OBERON_ASSERT(ctx.vkft.vkWaitForPresentKHR);
+      auto vkWaitForPresentKHR = ctx.vkft.vkWaitForPresentKHR;
+      auto result = vkWaitForPresentKHR(ctx.device, rnd.swapchain, present_id, period.count());
+      if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+      {
+        rnd.should_rebuild = true;
+      }
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - rnd.frame_deadline > period)
+    {
+      rnd.frame_deadline = now;
+    }
+    else
+    {
+      std::this_thread::sleep_until(rnd.frame_deadline);
+    }
+    rnd.frame_deadline += period;
+    return 0;
+  }
+
+  iresult throttle_occluded_frame(const window_impl& win, renderer_3d_impl& rnd) noexcept {
+    if (rnd.occlusion == occlusion_policy::none || is_window_visible(win))
+    {
+      return 0;
+    }
+    std::this_thread::sleep_for(OCCLUDED_FRAME_PERIOD);
+    return rnd.occlusion == occlusion_policy::suspend;
+  }
+
+  iresult skip_unchanged_frame(const window_impl& win, renderer_3d_impl& rnd) noexcept {
+    if (!rnd.is_frame_unchanged || win.content_generation != rnd.drawn_content_generation)
+    {
+      return 0;
+    }
+    if (rnd.pacing == frame_pacing::none)
+    {
+      auto refresh_rate = win.refresh_rate > 0.0 ? win.refresh_rate : DEFAULT_REFRESH_RATE;
+      std::this_thread::sleep_for(std::chrono::nanoseconds{ static_cast<i64>(1'000'000'000.0 / refresh_rate) });
+    }
+    return 1;
+  }
+
+  iresult add_frame_damage(renderer_3d_impl& rnd, const bounding_rect& rect) noexcept {
+    auto& damage = rnd.pending_damage;
+    if (damage.size == MAX_DAMAGE_RECTS)
+    {
+      damage.is_overflowed = true;
+      return -1;
+    }
+    // Present regions must lie within the swapchain image extent.
+    const auto& extent = rnd.current_swapchain_extent;
+    auto left = std::clamp(rect.position.x, isize{ 0 }, static_cast<isize>(extent.width));
+    auto top = std::clamp(rect.position.y, isize{ 0 }, static_cast<isize>(extent.height));
+    auto right = std::clamp(rect.position.x + static_cast<isize>(rect.size.width), left,
+                            static_cast<isize>(extent.width));
+    auto bottom = std::clamp(rect.position.y + static_cast<isize>(rect.size.height), top,
+                             static_cast<isize>(extent.height));
+    if (right == left || bottom == top)
+    {
+      return 0;
+    }
+    auto& damage_rect = damage.rects[damage.size++];
+    damage_rect.offset = { static_cast<i32>(left), static_cast<i32>(top) };
+    damage_rect.extent = { static_cast<u32>(right - left), static_cast<u32>(bottom - top) };
+    damage_rect.layer = 0;
+    return 0;
+  }
+
+  iresult acquire_frame_image(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize frame_index,
+    const u64 previous_serial,
+    const u64 timeout,
+    u32& image_index
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(rnd.swapchain);
+    OBERON_PRECONDITION(ctx.vkft.vkAcquireNextImageKHR);
+    OBERON_PRECONDITION(ctx.vkft.vkWaitForFences);
+    OBERON_PRECONDITION(frame_index < MAX_FRAMES_IN_FLIGHT);
+    auto vkWaitForFences = ctx.vkft.vkWaitForFences;
+    auto vkAcquireNextImageKHR = ctx.vkft.vkAcquireNextImageKHR;
+    image_index = -1U;
+    auto result = VK_SUCCESS;
+    {
+      OBERON_TRACE_ZONE("wait for frame fence");
+      result = vkWaitForFences(ctx.device, 1, &rnd.in_flight_fences[frame_index], true, -1ULL);
+    }
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    rnd.acquire_completed_serial = std::max(rnd.acquire_completed_serial, previous_serial);
+    {
+      OBERON_TRACE_ZONE("acquire image");
+      result = vkAcquireNextImageKHR(ctx.device, rnd.swapchain, timeout, rnd.image_available_semaphores[frame_index],
+                                     VK_NULL_HANDLE, &image_index);
+    }
+    switch (result)
+    {
+    case VK_SUBOPTIMAL_KHR: // The image is still usable.
+      rnd.should_rebuild = true;
+    case VK_SUCCESS:
+      break;
+    default:
+      image_index = -1U;
+      return result;
+    }
+    // Every frame up to acquire_completed_serial has been waited for through its own slot. A newer owner is therefore
+    // the newest frame in its slot and that slot can't be reused (and its fence reset) until this thread waits for it.
+    const auto& owner = rnd.in_flight_images[image_index];
+    if (owner.frame_serial > rnd.acquire_completed_serial)
+    {
+      OBERON_TRACE_ZONE("wait for image fence");
+      result = vkWaitForFences(ctx.device, 1, &rnd.in_flight_fences[owner.frame_index], true, -1ULL);
+      if (result != VK_SUCCESS)
+      {
+        return result;
+      }
+      rnd.acquire_completed_serial = owner.frame_serial;
+    }
+    OBERON_POSTCONDITION(image_index < -1U);
+    return 0;
+  }
+
+  iresult acquire_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(!rnd.is_pipelined);
+    return acquire_frame_image(ctx, rnd, rnd.frame_index, rnd.frame_serials[rnd.frame_index], -1ULL,
+                               rnd.acquired_image_index);
+  }
+
+  iresult submit_frame_commands(const context_impl& ctx, renderer_3d_impl& rnd, const frame_submission& frame) noexcept {
+    OBERON_PRECONDITION(ctx.device);
+    OBERON_PRECONDITION(ctx.vkft.vkQueueSubmit);
+    OBERON_PRECONDITION(ctx.vkft.vkResetFences);
+    OBERON_PRECONDITION(frame.frame_index < MAX_FRAMES_IN_FLIGHT);
+    auto vkQueueSubmit = ctx.vkft.vkQueueSubmit;
+    auto vkResetFences = ctx.vkft.vkResetFences;
+    auto submit_info = VkSubmitInfo{ };
+    OBERON_INIT_VK_STRUCT(submit_info, SUBMIT_INFO);
+    submit_info.pWaitSemaphores = &rnd.image_available_semaphores[frame.frame_index];
+    submit_info.waitSemaphoreCount = 1;
+    auto wait_stages = VkPipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    submit_info.pWaitDstStageMask = &wait_stages;
+    submit_info.pCommandBuffers = &frame.command_buffer;
+    submit_info.commandBufferCount = 1;
+    submit_info.pSignalSemaphores = &rnd.render_complete_semaphores[frame.frame_index];
+    submit_info.signalSemaphoreCount = 1;
+    auto result = vkResetFences(ctx.device, 1, &rnd.in_flight_fences[frame.frame_index]);
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    OBERON_TRACE_ZONE("queue submit");
+    auto lock = std::lock_guard{ ctx.graphics_transfer_queue_mutex };
+    result = vkQueueSubmit(ctx.graphics_transfer_queue, 1, &submit_info, rnd.in_flight_fences[frame.frame_index]);
+    if (result != VK_SUCCESS)
+    {
+      return result;
     }
-    rnd.image_available_semaphores.resize(0);
-    rnd.render_complete_semaphores.resize(0);
-    rnd.in_flight_fences.resize(0);
     return 0;
   }
 
-  iresult acquire_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+  iresult present_frame(const context_impl& ctx, renderer_3d_impl& rnd, const frame_submission& frame) noexcept {
     OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(rnd.swapchain);
-    OBERON_PRECONDITION(ctx.vkft.vkAcquireNextImageKHR);
-    OBERON_PRECONDITION(ctx.vkft.vkWaitForFences);
-    auto vkWaitForFences = ctx.vkft.vkWaitForFences;
-    auto vkAcquireNextImageKHR = ctx.vkft.vkAcquireNextImageKHR;
-    auto result = vkWaitForFences(ctx.device, 1, &rnd.in_flight_fences[rnd.frame_index], true, -1ULL);
+    OBERON_PRECONDITION(ctx.vkft.vkQueuePresentKHR);
+    OBERON_PRECONDITION(frame.frame_index < MAX_FRAMES_IN_FLIGHT);
+    OBERON_PRECONDITION(frame.image_index < -1U);
+    auto vkQueuePresentKHR = ctx.vkft.vkQueuePresentKHR;
+    auto present_info = VkPresentInfoKHR{ };
+    OBERON_INIT_VK_STRUCT(present_info, PRESENT_INFO_KHR);
+    present_info.pImageIndices = &frame.image_index;
+    present_info.pSwapchains = &rnd.swapchain;
+    present_info.swapchainCount = 1;
+    present_info.pWaitSemaphores = &rnd.render_complete_semaphores[frame.frame_index];
+    present_info.waitSemaphoreCount = 1;
+    auto present_id_info = VkPresentIdKHR{ };
+    auto present_id = u64{ };
+    if (ctx.has_present_id)
+    {
+      present_id = ++rnd.present_id;
+      OBERON_INIT_VK_STRUCT(present_id_info, PRESENT_ID_KHR);
+      present_id_info.pPresentIds = &present_id;
+      present_id_info.swapchainCount = 1;
+      present_info.pNext = &present_id_info;
+    }
+    rnd.in_flight_images[frame.image_index] = { frame.frame_index, frame.frame_serial };
+    auto& damage = rnd.frame_damages[frame.frame_index];
+    auto present_region = VkPresentRegionKHR{ };
+    auto present_regions_info = VkPresentRegionsKHR{ };
+    if (ctx.has_incremental_present && damage.size && !damage.is_overflowed)
+    {
+      present_region.pRectangles = std::data(damage.rects);
+      present_region.rectangleCount = damage.size;
+      OBERON_INIT_VK_STRUCT(present_regions_info, PRESENT_REGIONS_KHR);
+      present_regions_info.pNext = present_info.pNext;
+      present_regions_info.pRegions = &present_region;
+      present_regions_info.swapchainCount = 1;
+      present_info.pNext = &present_regions_info;
+    }
+    // When both queue families are the same the queues are the same object and must share a lock.
+    // This means a blocking present will stall submission in that case.
+    auto& queue_mutex = ctx.presentation_queue == ctx.graphics_transfer_queue ? ctx.graphics_transfer_queue_mutex :
+                                                                                ctx.presentation_queue_mutex;
+    OBERON_TRACE_ZONE("queue present");
+    auto lock = std::lock_guard{ queue_mutex };
+    auto result = vkQueuePresentKHR(ctx.presentation_queue, &present_info);
+    damage = frame_damage{ };
+    if (result != VK_SUCCESS)
+    {
+      return result;
+    }
+    return 0;
+  }
+
+  iresult submit_frame(const context_impl& ctx, renderer_3d_impl& rnd, const VkCommandBuffer commands) noexcept {
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    auto frame = frame_submission{ rnd.frame_index, rnd.acquired_image_index, rnd.frame_serials[rnd.frame_index],
+                                   commands };
+    auto result = submit_frame_commands(ctx, rnd, frame);
     if (result != VK_SUCCESS)
     {
-      return result;
+      return result;
+    }
+    result = present_frame(ctx, rnd, frame);
+    rnd.acquired_image_index = -1U;
+    rnd.frame_index = (rnd.frame_index + 1) & (MAX_FRAMES_IN_FLIGHT - 1); // frame_index % MAX_FRAMES_IN_FLIGHT
+    return result;
+  }
+
+namespace {
+
+  // Wait for the image available semaphore of a frame whose commands couldn't be submitted. The semaphore was
+  // signaled by the acquire and has to be unsignaled before the slot acquires again.
+  iresult discard_frame_commands(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const frame_submission& frame
+  ) noexcept {
+    OBERON_PRECONDITION(ctx.vkft.vkQueueSubmit);
+    auto vkQueueSubmit = ctx.vkft.vkQueueSubmit;
+    auto submit_info = VkSubmitInfo{ };
+    OBERON_INIT_VK_STRUCT(submit_info, SUBMIT_INFO);
+    submit_info.pWaitSemaphores = &rnd.image_available_semaphores[frame.frame_index];
+    submit_info.waitSemaphoreCount = 1;
+    auto wait_stages = VkPipelineStageFlags{ VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+    submit_info.pWaitDstStageMask = &wait_stages;
+    auto lock = std::lock_guard{ ctx.graphics_transfer_queue_mutex };
+    return vkQueueSubmit(ctx.graphics_transfer_queue, 1, &submit_info, VK_NULL_HANDLE);
+  }
+
+  // Acquire the next image of a slot and hand it back to the application.
+  void recycle_frame_slot(
+    const context_impl& ctx,
+    renderer_3d_impl& rnd,
+    const usize frame_index,
+    const u64 previous_serial
+  ) noexcept {
+    auto frame = frame_submission{ frame_index };
+    auto timeout = static_cast<u64>(std::chrono::nanoseconds{ PIPELINED_ACQUIRE_TIMEOUT }.count());
+    switch (auto result = acquire_frame_image(ctx, rnd, frame_index, previous_serial, timeout, frame.image_index);
+            result)
+    {
+    case VK_ERROR_OUT_OF_DATE_KHR: // The application skips frames until the renderer is rebuilt.
+      rnd.should_rebuild = true;
+    case 0:
+      break;
+    case VK_TIMEOUT: // The application thread only checks for errors.
+    case VK_NOT_READY:
+      frame.image_index = -1U;
+      rnd.pipeline_result = -1;
+      break;
+    default:
+      rnd.pipeline_result = result;
+      break;
+    }
+    rnd.free_frames.push(frame);
+  }
+
+  void run_render_stage(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_TRACE_THREAD_NAME("oberon render");
+    auto frame = frame_submission{ };
+    while (rnd.submit_queue.pop(frame))
+    {
+      auto result = submit_frame_commands(ctx, rnd, frame);
+      if (OBERON_IS_IERROR(result))
+      {
+        // Nothing will signal the render complete semaphore so the frame can't be presented. The application thread
+        // reports the error.
+        rnd.pipeline_result = result;
+        discard_frame_commands(ctx, rnd, frame);
+        frame.is_discarded = true;
+      }
+      rnd.present_queue.push(frame);
+    }
+  }
+
+  void run_present_stage(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_TRACE_THREAD_NAME("oberon present");
+    // No slot has been handed out yet so reading their serials here doesn't race with the application thread.
+    for (auto i = usize{ 0 }; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+      recycle_frame_slot(ctx, rnd, i, rnd.frame_serials[i]);
+    }
+    auto frame = frame_submission{ };
+    while (rnd.present_queue.pop(frame))
+    {
+      if (frame.is_discarded)
+      {
+        // The pipeline has failed. The slot's fence may never be signaled so the slot is returned without waiting.
+        // Its image stays acquired until the swapchain is destroyed.
+        rnd.free_frames.push({ frame.frame_index });
+        continue;
+      }
+      switch (auto result = present_frame(ctx, rnd, frame); result)
+      {
+      case VK_ERROR_OUT_OF_DATE_KHR: // Rebuild swapchain
+      case VK_SUBOPTIMAL_KHR:
+        rnd.should_rebuild = true;
+      case 0:
+        break;
+      default:
+        rnd.pipeline_result = result;
+        break;
+      }
+      recycle_frame_slot(ctx, rnd, frame.frame_index, frame.frame_serial);
+    }
+  }
+
+}
+
+  iresult start_frame_pipeline(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(!rnd.render_thread.joinable());
+    OBERON_PRECONDITION(!rnd.present_thread.joinable());
+    OBERON_PRECONDITION(std::size(rnd.in_flight_fences) == MAX_FRAMES_IN_FLIGHT);
+    if (std::size(rnd.swapchain_images) < rnd.surface_capabilities.minImageCount + MAX_FRAMES_IN_FLIGHT)
+    {
+      return -1;
+    }
+    rnd.pipeline_result = 0;
+    rnd.submit_queue.reopen();
+    rnd.present_queue.reopen();
+    rnd.render_thread = std::thread{ run_render_stage, std::cref(ctx), std::ref(rnd) };
+    rnd.present_thread = std::thread{ run_present_stage, std::cref(ctx), std::ref(rnd) };
+    rnd.is_pipelined = true;
+    return 0;
+  }
+
+  iresult acquire_frame_slot(renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(rnd.is_pipelined);
+    auto frame = frame_submission{ };
+    if (!rnd.free_frames.pop(frame))
+    {
+      return -1;
+    }
+    if (auto result = rnd.pipeline_result.load(); OBERON_IS_IERROR(result))
+    {
+      rnd.free_frames.push(frame);
+      return result;
+    }
+    rnd.frame_index = frame.frame_index;
+    rnd.acquired_image_index = frame.image_index;
+    return 0;
+  }
+
+  iresult release_frame_slot(renderer_3d_impl& rnd) noexcept {
+    OBERON_PRECONDITION(rnd.is_pipelined);
+    OBERON_PRECONDITION(rnd.acquired_image_index == -1U);
+    rnd.free_frames.push({ rnd.frame_index });
+    return 0;
+  }
+
+  iresult queue_frame(renderer_3d_impl& rnd, const VkCommandBuffer commands) noexcept {
+    OBERON_PRECONDITION(rnd.is_pipelined);
+    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
+    auto frame = frame_submission{ rnd.frame_index, rnd.acquired_image_index, rnd.frame_serials[rnd.frame_index],
+                                   commands };
+    rnd.acquired_image_index = -1U;
+    if (!rnd.submit_queue.push(frame))
+    {
+      // The image is still acquired and its semaphore still signaled so the slot can be recorded into again.
+      rnd.free_frames.push(frame);
+      return -1;
+    }
+    return 0;
+  }
+
+  iresult drain_frame_pipeline(renderer_3d_impl& rnd) noexcept {
+    if (!rnd.is_pipelined)
+    {
+      return 0;
+    }
+    // Collecting every slot guarantees that every recorded frame has been submitted and presented.
+    auto slots = std::array<frame_submission, MAX_FRAMES_IN_FLIGHT>{ };
+    for (auto& slot : slots)
+    {
+      rnd.free_frames.pop(slot);
+    }
+    for (const auto& slot : slots)
+    {
+      rnd.free_frames.push(slot);
+    }
+    return 0;
+  }
+
+  iresult stop_frame_pipeline(renderer_3d_impl& rnd) noexcept {
+    if (!rnd.is_pipelined)
+    {
+      return 0;
+    }
+    // The slots are left out of free_frames so that the pipeline can be started again.
+    auto slot = frame_submission{ };
+    for (auto i = usize{ 0 }; i < MAX_FRAMES_IN_FLIGHT; ++i)
+    {
+      rnd.free_frames.pop(slot);
+    }
+    rnd.submit_queue.close();
+    rnd.present_queue.close();
+    rnd.render_thread.join();
+    rnd.present_thread.join();
+    rnd.is_pipelined = false;
+    OBERON_POSTCONDITION(!rnd.render_thread.joinable());
+    OBERON_POSTCONDITION(!rnd.present_thread.joinable());
+    return 0;
+  }
+}
+
+  void renderer_3d::v_dispose() noexcept {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    detail::stop_shader_hot_reload(ctx, rnd);
+    detail::stop_frame_pipeline(rnd);
+    detail::wait_for_device_idle(ctx);
+    detail::destroy_resource_registry(ctx, rnd.resources);
+    detail::destroy_vulkan_timestamp_queries(ctx, rnd);
+    detail::destroy_vulkan_synchronization_objects(ctx, rnd);
+    detail::destroy_vulkan_descriptor_pools(ctx, rnd);
+    detail::destroy_vulkan_compute_pipelines(ctx, rnd);
+    detail::destroy_vulkan_graphics_pipelines(ctx, rnd);
+    detail::release_graphics_pipeline_configurations(ctx, rnd);
+    detail::destroy_vulkan_pipeline_cache(ctx, rnd);
+    detail::invalidate_command_bundles(ctx, rnd);
+    detail::destroy_vulkan_command_buffers(ctx, rnd);
+    detail::destroy_vulkan_framebuffers(ctx, rnd);
+    detail::destroy_vulkan_command_pools(ctx, rnd);
+    detail::destroy_vulkan_renderpasses(ctx, rnd);
+    detail::destroy_vulkan_swapchain(ctx, rnd);
+  }
+
+  renderer_3d::renderer_3d(const window& win) : renderer_3d{ win, frame_execution::serial } { }
+
+  renderer_3d::renderer_3d(const window& win, const frame_execution execution) :
+  object{ new detail::renderer_3d_impl{ }, &win } {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& win_impl = reference_cast<detail::window_impl>(parent().implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    rnd.requested_execution = execution;
+    rnd.graphics_pipeline_configs.resize(detail::BUILTIN_PIPELINE_COUNT);
+    rnd.graphics_pipelines.resize(detail::BUILTIN_PIPELINE_COUNT);
+    rnd.compute_pipelines.resize(detail::BUILTIN_SHADER_COUNT);
+    detail::retrieve_vulkan_surface_info(ctx, win_impl, rnd);
+    if (OBERON_IS_IERROR(detail::create_vulkan_swapchain(ctx, win_impl, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan swapchain." };
+    }
+    //TODO create depth/stencil images with some kind of allocator here.
+    if (OBERON_IS_IERROR(detail::create_vulkan_renderpasses(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan render passes." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_command_pools(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan command pools." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_framebuffers(ctx, win_impl, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan framebuffers." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_command_buffers(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to allocate Vulkan command buffers." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_pipeline_cache(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan pipeline cache." };
+    }
+    // Every variant is created up front so each one is compiled into the pipeline cache before the first frame.
+    if (OBERON_IS_IERROR(detail::configure_builtin_pipelines(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to configure builtin pipelines." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_graphics_pipelines(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan graphics pipelines." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_compute_pipelines(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan compute pipelines." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_descriptor_pools(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan descriptor pools." };
+    }
+    if (OBERON_IS_IERROR(detail::create_vulkan_synchronization_objects(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan semaphores." };
+    }
+    if constexpr (IS_TRACING_ENABLED)
+    {
+      if (OBERON_IS_IERROR(detail::create_vulkan_timestamp_queries(ctx, rnd)))
+      {
+        throw fatal_error{ "Failed to create Vulkan timestamp queries." };
+      }
+    }
+    // A swapchain without enough images falls back to serial execution.
+    if (execution == frame_execution::pipelined)
+    {
+      detail::start_frame_pipeline(ctx, rnd);
+    }
+  }
+
+  renderer_3d::~renderer_3d() noexcept {
+    dispose();
+  }
+
+
+namespace {
+
+  // Returns true if the frame should be skipped. Otherwise a swapchain image has been acquired for the frame.
+  bool start_frame(const detail::context_impl& ctx, const detail::window_impl& win, detail::renderer_3d_impl& rnd) {
+    OBERON_TRACE_ZONE("start frame");
+    rnd.is_frame_skipped = detail::throttle_occluded_frame(win, rnd) || detail::skip_unchanged_frame(win, rnd);
+    rnd.is_frame_unchanged = false;
+    if (rnd.is_frame_skipped)
+    {
+      rnd.pending_damage = { };
+      return true;
+    }
+    detail::pace_frame(ctx, win, rnd);
+    rnd.frame_arena.reset();
+    if (win.content_generation != rnd.drawn_content_generation)
+    {
+      // Partial damage means nothing when the previous contents are gone.
+      rnd.pending_damage.is_overflowed = true;
+      rnd.drawn_content_generation = win.content_generation;
+    }
+    if (rnd.is_pipelined)
+    {
+      if (OBERON_IS_IERROR(detail::acquire_frame_slot(rnd)))
+      {
+        throw fatal_error{ "Failed to acquire, submit, or present a pipelined frame." };
+      }
+      if (rnd.acquired_image_index == -1U)
+      {
+        // The swapchain is out of date. Nothing can be drawn until the renderer is rebuilt.
+        detail::release_frame_slot(rnd);
+        rnd.is_frame_skipped = true;
+        rnd.pending_damage = { };
+        return true;
+      }
+    }
+    else if (OBERON_IS_IERROR(detail::acquire_frame(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to acquire next image for drawing." };
+    }
+    // Acquiring waited for the previous frame in this slot so every frame up to its serial has finished executing.
+    auto& serial = rnd.frame_serials[rnd.frame_index];
+    serial = detail::advance_registry_frame(ctx, rnd.resources, serial);
+    detail::reset_frame_culling(ctx, rnd);
+    if (rnd.hot_reload.watcher.joinable())
+    {
+      detail::apply_reloaded_pipelines(ctx, rnd);
+    }
+    if constexpr (IS_TRACING_ENABLED)
+    {
+      detail::collect_frame_timestamps(ctx, rnd);
+    }
+    return false;
+  }
+
+  void finish_frame(const detail::context_impl& ctx, detail::renderer_3d_impl& rnd, const VkCommandBuffer commands) {
+    OBERON_TRACE_ZONE("finish frame");
+    rnd.frame_damages[rnd.frame_index] = rnd.pending_damage;
+    rnd.pending_damage = { };
+    if (rnd.is_pipelined)
+    {
+      if (OBERON_IS_IERROR(detail::queue_frame(rnd, commands)))
+      {
+        throw fatal_error{ "Failed to queue frame for submission." };
+      }
+      return;
+    }
+    auto result = detail::submit_frame(ctx, rnd, commands);
+    switch (result)
+    {
+    case VK_ERROR_OUT_OF_DATE_KHR: // Rebuild swapchain
+    case VK_SUBOPTIMAL_KHR:
+      rnd.should_rebuild = true;
+    case 0:
+      break;
+    default:
+      throw fatal_error{ "Failed to submit image for presentation." };
+    }
+  }
+
+}
+
+  renderer_3d& renderer_3d::begin_frame() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& win = reference_cast<detail::window_impl>(parent().implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_TRACE_ZONE("begin frame");
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    if (start_frame(ctx, win, rnd))
+    {
+      return *this;
+    }
+    if (OBERON_IS_IERROR(detail::begin_vulkan_command_buffers(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to begin Vulkan command buffer recording." };
+    }
+    if constexpr (IS_TRACING_ENABLED)
+    {
+      detail::write_frame_begin_timestamp(ctx, rnd);
+    }
+    // The main render pass is begun by the first draw so that instances can be culled before it.
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::end_frame() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_TRACE_ZONE("end frame");
+    if (rnd.is_frame_skipped)
+    {
+      return *this;
     }
-    result = vkAcquireNextImageKHR(ctx.device, rnd.swapchain, -1ULL,
-                                   rnd.image_available_semaphores[rnd.frame_index], VK_NULL_HANDLE,
-                                   &rnd.acquired_image_index);
-    if (result != VK_SUCCESS)
+    detail::end_main_render_pass(ctx, rnd);
+    if constexpr (IS_TRACING_ENABLED)
     {
-      return result;
+      detail::write_frame_end_timestamp(ctx, rnd);
     }
-    auto& fence = rnd.in_flight_images[rnd.acquired_image_index];
-    if (fence)
+    if (OBERON_IS_IERROR(detail::end_vulkan_command_buffers(ctx, rnd)))
     {
-      result = vkWaitForFences(ctx.device, 1, &fence, true, -1ULL);
-      if (result != VK_SUCCESS)
-      {
-        return result;
-      }
+      throw fatal_error{ "Failed to end Vulkan command buffer recording." };
     }
-    rnd.in_flight_images[rnd.acquired_image_index] = VK_NULL_HANDLE;
-    OBERON_POSTCONDITION(rnd.acquired_image_index < -1U);
-    return 0;
+    finish_frame(ctx, rnd, rnd.graphics_transfer_command_buffers[rnd.frame_index]);
+    return *this;
   }
 
-  iresult submit_frame(const context_impl& ctx, renderer_3d_impl& rnd) noexcept {
-    OBERON_PRECONDITION(ctx.device);
-    OBERON_PRECONDITION(ctx.vkft.vkQueueSubmit);
-    OBERON_PRECONDITION(ctx.vkft.vkQueuePresentKHR);
-    OBERON_PRECONDITION(ctx.vkft.vkResetFences);
-    OBERON_PRECONDITION(rnd.acquired_image_index < -1U);
-    auto vkQueueSubmit = ctx.vkft.vkQueueSubmit;
-    auto vkQueuePresentKHR = ctx.vkft.vkQueuePresentKHR;
-    auto vkResetFences = ctx.vkft.vkResetFences;
-    auto submit_info = VkSubmitInfo{ };
-    OBERON_INIT_VK_STRUCT(submit_info, SUBMIT_INFO);
-    submit_info.pWaitSemaphores = &rnd.image_available_semaphores[rnd.frame_index];
-    submit_info.waitSemaphoreCount = 1;
-    auto wait_stages = VkPipelineStageFlags{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    submit_info.pWaitDstStageMask = &wait_stages;
-    submit_info.pCommandBuffers = &rnd.graphics_transfer_command_buffers[rnd.frame_index];
-    submit_info.commandBufferCount = 1;
-    submit_info.pSignalSemaphores = &rnd.render_complete_semaphores[rnd.frame_index];
-    submit_info.signalSemaphoreCount = 1;
-    auto result = vkResetFences(ctx.device, 1, &rnd.in_flight_fences[rnd.frame_index]);
-    if (result != VK_SUCCESS)
+  renderer_3d& renderer_3d::begin_bundle() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    detail::begin_command_bundle(rnd);
+    return *this;
+  }
+
+  usize renderer_3d::end_bundle() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    return detail::end_command_bundle(rnd);
+  }
+
+  renderer_3d& renderer_3d::present_bundle(const usize bundle) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& win = reference_cast<detail::window_impl>(parent().implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_TRACE_ZONE("present bundle");
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    OBERON_PRECONDITION(bundle < std::size(rnd.bundles));
+    if (start_frame(ctx, win, rnd))
     {
-      return result;
+      return *this;
     }
-    result = vkQueueSubmit(ctx.graphics_transfer_queue, 1, &submit_info, rnd.in_flight_fences[rnd.frame_index]);
-    if (result != VK_SUCCESS)
+    auto& command_bundle = rnd.bundles[bundle];
+    if (OBERON_IS_IERROR(detail::record_command_bundle(ctx, rnd, command_bundle, rnd.acquired_image_index)))
     {
-      return result;
+      throw fatal_error{ "Failed to record Vulkan command bundle." };
     }
-    auto present_info = VkPresentInfoKHR{ };
-    OBERON_INIT_VK_STRUCT(present_info, PRESENT_INFO_KHR);
-    present_info.pImageIndices = &rnd.acquired_image_index;
-    present_info.pSwapchains = &rnd.swapchain;
-    present_info.swapchainCount = 1;
-    present_info.pWaitSemaphores = &rnd.render_complete_semaphores[rnd.frame_index];
-    present_info.waitSemaphoreCount = 1;
-    result = vkQueuePresentKHR(ctx.presentation_queue, &present_info);
-    if (result != VK_SUCCESS)
+    finish_frame(ctx, rnd, command_bundle.command_buffers[rnd.acquired_image_index]);
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::discard_bundle(const usize bundle) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_PRECONDITION(bundle < std::size(rnd.bundles));
+    // The bundle's command buffers may still be executing.
+    detail::drain_frame_pipeline(rnd);
+    detail::wait_for_device_idle(ctx);
+    detail::destroy_command_bundle(ctx, rnd, rnd.bundles[bundle]);
+    return *this;
+  }
+
+  buffer_handle renderer_3d::create_buffer(const usize size, const u32 usage, const memory_location location) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    auto result = buffer_handle{ };
+    if (OBERON_IS_IERROR(detail::create_registry_buffer(ctx, rnd.resources, size, usage, location, result)))
     {
-      return result;
+      throw fatal_error{ "Failed to create Vulkan buffer." };
     }
-    rnd.in_flight_images[rnd.acquired_image_index] = rnd.in_flight_fences[rnd.frame_index];
-    rnd.acquired_image_index = -1U;
-    rnd.frame_index = (rnd.frame_index + 1) & (MAX_FRAMES_IN_FLIGHT - 1); // frame_index % MAX_FRAMES_IN_FLIGHT
-    return 0;
+    return result;
   }
-}
 
-  void renderer_3d::v_dispose() noexcept {
+  image_handle renderer_3d::create_image(const extent_2d& extent, const image_format format, const u32 usage) {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
-    detail::wait_for_device_idle(ctx);
-    detail::destroy_vulkan_synchronization_objects(ctx, rnd);
-    detail::destroy_vulkan_graphics_pipelines(ctx, rnd);
-    detail::release_graphics_pipeline_configurations(ctx, rnd);
-    detail::destroy_vulkan_pipeline_cache(ctx, rnd);
-    detail::destroy_vulkan_command_buffers(ctx, rnd);
-    detail::destroy_vulkan_framebuffers(ctx, rnd);
-    detail::destroy_vulkan_command_pools(ctx, rnd);
-    detail::destroy_vulkan_renderpasses(ctx, rnd);
-    detail::destroy_vulkan_swapchain(ctx, rnd);
+    auto result = image_handle{ };
+    if (OBERON_IS_IERROR(detail::create_registry_image(ctx, rnd.resources, extent, format, usage, result)))
+    {
+      throw fatal_error{ "Failed to create Vulkan image." };
+    }
+    return result;
   }
 
-  renderer_3d::renderer_3d(const window& win) : object{ new detail::renderer_3d_impl{ }, &win } {
+  sampler_handle renderer_3d::create_sampler(const sampler_filter filter, const sampler_address_mode address_mode) {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
-    auto& win_impl = reference_cast<detail::window_impl>(parent().implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
-    rnd.graphics_pipeline_configs.resize(detail::BUILTIN_SHADER_COUNT);
-    rnd.graphics_pipelines.resize(detail::BUILTIN_SHADER_COUNT);
-    detail::retrieve_vulkan_surface_info(ctx, win_impl, rnd);
-    if (OBERON_IS_IERROR(detail::create_vulkan_swapchain(ctx, win_impl, rnd)))
+    auto result = sampler_handle{ };
+    if (OBERON_IS_IERROR(detail::create_registry_sampler(ctx, rnd.resources, filter, address_mode, result)))
     {
-      throw fatal_error{ "Failed to create Vulkan swapchain." };
+      throw fatal_error{ "Failed to create Vulkan sampler." };
     }
-    //TODO create depth/stencil images with some kind of allocator here.
-    if (OBERON_IS_IERROR(detail::create_vulkan_renderpasses(ctx, rnd)))
+    return result;
+  }
+
+  mesh_handle renderer_3d::create_mesh(
+    const buffer_handle vertices,
+    const buffer_handle indices,
+    const u32 index_count
+  ) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto result = mesh_handle{ };
+    if (OBERON_IS_IERROR(detail::create_registry_mesh(rnd.resources, vertices, indices, index_count, 0, result)))
     {
-      throw fatal_error{ "Failed to create Vulkan render passes." };
+      throw fatal_error{ "Failed to create mesh from invalid buffers." };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_command_pools(ctx, rnd)))
+    return result;
+  }
+
+  std::span<std::byte> renderer_3d::map_buffer(const buffer_handle buffer) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto result = std::span<std::byte>{ };
+    if (OBERON_IS_IERROR(detail::map_registry_buffer(rnd.resources, buffer, result)))
     {
-      throw fatal_error{ "Failed to create Vulkan command pools." };
+      throw fatal_error{ "Attempted to map an invalid buffer handle or a buffer in device memory." };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_framebuffers(ctx, win_impl, rnd)))
+    return result;
+  }
+
+  std::span<std::byte> renderer_3d::frame_instance_memory(const usize size) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    if (rnd.is_frame_skipped || !size)
     {
-      throw fatal_error{ "Failed to create Vulkan framebuffers." };
+      return { };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_command_buffers(ctx, rnd)))
+    if (OBERON_IS_IERROR(detail::reserve_frame_instance_buffer(ctx, rnd, size)))
     {
-      throw fatal_error{ "Failed to allocate Vulkan command buffers." };
+      throw fatal_error{ "Failed to create Vulkan instance buffer." };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_pipeline_cache(ctx, rnd)))
+    return map_buffer(rnd.instance_buffers[rnd.frame_index]).first(size);
+  }
+
+  buffer_handle renderer_3d::frame_instance_buffer() const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    return rnd.instance_buffers[rnd.frame_index];
+  }
+
+  renderer_3d& renderer_3d::destroy_buffer(const buffer_handle buffer) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    if (OBERON_IS_IERROR(detail::destroy_registry_buffer(rnd.resources, buffer)))
     {
-      throw fatal_error{ "Failed to create Vulkan pipeline cache." };
+      throw fatal_error{ "Attempted to destroy an invalid buffer handle." };
     }
-    if (OBERON_IS_IERROR(detail::configure_test_frame_pipeline(ctx, rnd)))
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::destroy_image(const image_handle image) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    if (OBERON_IS_IERROR(detail::destroy_registry_image(rnd.resources, image)))
     {
-      throw fatal_error{ "Failed to configure test_frame pipeline." };
+      throw fatal_error{ "Attempted to destroy an invalid image handle." };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_graphics_pipelines(ctx, rnd)))
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::destroy_sampler(const sampler_handle sampler) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    if (OBERON_IS_IERROR(detail::destroy_registry_sampler(rnd.resources, sampler)))
     {
-      throw fatal_error{ "Failed to create Vulkan graphics pipelines." };
+      throw fatal_error{ "Attempted to destroy an invalid sampler handle." };
     }
-    if (OBERON_IS_IERROR(detail::create_vulkan_synchronization_objects(ctx, rnd)))
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::destroy_mesh(const mesh_handle mesh) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    if (OBERON_IS_IERROR(detail::destroy_registry_mesh(rnd.resources, mesh)))
     {
-      throw fatal_error{ "Failed to create Vulkan semaphores." };
+      throw fatal_error{ "Attempted to destroy an invalid mesh handle." };
     }
+    return *this;
   }
 
-  renderer_3d::~renderer_3d() noexcept {
-    dispose();
+  bool renderer_3d::is_valid(const buffer_handle buffer) const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto lock = std::lock_guard{ rnd.resources.mutex };
+    return rnd.resources.buffers.contains(buffer.value());
   }
 
+  bool renderer_3d::is_valid(const image_handle image) const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto lock = std::lock_guard{ rnd.resources.mutex };
+    return rnd.resources.images.contains(image.value());
+  }
 
-  renderer_3d& renderer_3d::begin_frame() {
+  bool renderer_3d::is_valid(const sampler_handle sampler) const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto lock = std::lock_guard{ rnd.resources.mutex };
+    return rnd.resources.samplers.contains(sampler.value());
+  }
+
+  bool renderer_3d::is_valid(const mesh_handle mesh) const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto lock = std::lock_guard{ rnd.resources.mutex };
+    return rnd.resources.meshes.contains(mesh.value());
+  }
+
+  renderer_3d& renderer_3d::draw_test_frame() {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
-    if (OBERON_IS_IERROR(detail::acquire_frame(ctx, rnd)))
+    if (rnd.is_recording_bundle)
     {
-      throw fatal_error{ "Failed to acquire next image for drawing." };
+      rnd.bundles.back().commands.push_back({ detail::bundle_command_type::draw_test_frame });
+      return *this;
     }
-    if (OBERON_IS_IERROR(detail::begin_vulkan_command_buffers(ctx, rnd)))
+    if (rnd.is_frame_skipped)
     {
-      throw fatal_error{ "Failed to begin Vulkan command buffer recording." };
+      return *this;
     }
-    detail::begin_main_render_pass(ctx, rnd);
+    detail::draw_test_frame(ctx, rnd);
     return *this;
   }
 
-  renderer_3d& renderer_3d::end_frame() {
+  usize renderer_3d::cull_instances(
+    const mesh_handle mesh,
+    const buffer_handle bounds,
+    const buffer_handle transforms,
+    const u32 instance_count,
+    const frustum& f
+  ) {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
-    detail::end_main_render_pass(ctx, rnd);
-    if (OBERON_IS_IERROR(detail::end_vulkan_command_buffers(ctx, rnd)))
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    if (!ctx.has_draw_indirect_count || !ctx.has_draw_indirect_first_instance)
     {
-      throw fatal_error{ "Failed to end Vulkan command buffer recording." };
+      throw fatal_error{ "GPU culling requires the Vulkan drawIndirectCount and drawIndirectFirstInstance features." };
     }
-    auto result = detail::submit_frame(ctx, rnd);
-    switch (result)
+    if (rnd.is_frame_skipped)
+    {
+      return 0;
+    }
+    if (rnd.is_main_render_pass_open)
+    {
+      throw fatal_error{ "Instances must be culled before anything is drawn in the frame." };
+    }
+    auto result = usize{ };
+    if (OBERON_IS_IERROR(detail::cull_mesh_instances(ctx, rnd, mesh, bounds, transforms, instance_count, f, result)))
+    {
+      throw fatal_error{ "Failed to cull instances." };
+    }
+    return result;
+  }
+
+  renderer_3d& renderer_3d::draw_culled_instances(const usize batch, const mat4& view_projection) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_PRECONDITION(!rnd.is_recording_bundle);
+    if (rnd.is_frame_skipped)
+    {
+      return *this;
+    }
+    if (batch >= std::size(rnd.culled_batches))
+    {
+      throw fatal_error{ "Attempted to draw an invalid culled batch." };
+    }
+    detail::draw_culled_batch(ctx, rnd, batch, view_projection);
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::begin_label([[maybe_unused]] const cstring name) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    [[maybe_unused]] auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    if (rnd.is_recording_bundle || rnd.is_frame_skipped)
+    {
+      return *this;
+    }
+    OBERON_BEGIN_VK_LABEL(ctx, rnd.graphics_transfer_command_buffers[rnd.frame_index], name);
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::end_label() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    [[maybe_unused]] auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    if (rnd.is_recording_bundle || rnd.is_frame_skipped)
+    {
+      return *this;
+    }
+    OBERON_END_VK_LABEL(ctx, rnd.graphics_transfer_command_buffers[rnd.frame_index]);
+    return *this;
+  }
+
+  scoped_label::scoped_label(renderer_3d& renderer, const cstring name) : m_renderer{ &renderer } {
+    m_renderer->begin_label(name);
+  }
+
+  scoped_label::~scoped_label() noexcept {
+    m_renderer->end_label();
+  }
+
+namespace {
+
+  constexpr VkPresentModeKHR to_vulkan_present_mode(const presentation_mode mode) noexcept {
+    switch (mode)
+    {
+    case presentation_mode::fifo_relaxed:
+      return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+    case presentation_mode::mailbox:
+      return VK_PRESENT_MODE_MAILBOX_KHR;
+    case presentation_mode::immediate:
+      return VK_PRESENT_MODE_IMMEDIATE_KHR;
+    default:
+      return VK_PRESENT_MODE_FIFO_KHR;
+    }
+  }
+
+}
+
+  renderer_3d& renderer_3d::request_presentation_mode(const presentation_mode mode) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.requested_presentation_mode = to_vulkan_present_mode(mode);
+    if (rnd.requested_presentation_mode != rnd.current_presentation_mode)
     {
-    case VK_ERROR_OUT_OF_DATE_KHR: // Rebuild swapchain
-    case VK_SUBOPTIMAL_KHR:
       rnd.should_rebuild = true;
-    case 0:
-      break;
+    }
+    return *this;
+  }
+
+  presentation_mode renderer_3d::current_presentation_mode() const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    switch (rnd.current_presentation_mode)
+    {
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+      return presentation_mode::fifo_relaxed;
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+      return presentation_mode::mailbox;
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+      return presentation_mode::immediate;
     default:
-      throw fatal_error{ "Failed to submit image for presentation." };
+      return presentation_mode::fifo;
     }
+  }
+
+  renderer_3d& renderer_3d::pace_to_refresh_rate() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.pacing = detail::frame_pacing::refresh_rate;
     return *this;
   }
 
-  renderer_3d& renderer_3d::draw_test_frame() {
+  renderer_3d& renderer_3d::pace_to_frame_rate(const f64 frames_per_second) {
+    OBERON_PRECONDITION(frames_per_second > 0.0);
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.pacing = detail::frame_pacing::fixed_rate;
+    rnd.frame_period = std::chrono::nanoseconds{ static_cast<i64>(1'000'000'000.0 / frames_per_second) };
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::disable_frame_pacing() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.pacing = detail::frame_pacing::none;
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::mark_frame_unchanged() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.is_frame_unchanged = true;
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::add_damage(const bounding_rect& rect) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    detail::add_frame_damage(rnd, rect);
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::set_occlusion_policy(const occlusion_policy policy) {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    rnd.occlusion = policy;
+    return *this;
+  }
+
+  bool renderer_3d::is_pipelined() const {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    return rnd.is_pipelined;
+  }
+
+  renderer_3d& renderer_3d::watch_shader_directory(const cstring directory) {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
-    detail::draw_test_frame(ctx, rnd);
+    detail::stop_shader_hot_reload(ctx, rnd);
+    if (OBERON_IS_IERROR(detail::start_shader_hot_reload(ctx, rnd, directory)))
+    {
+      throw fatal_error{ "Failed to watch shader directory." };
+    }
+    return *this;
+  }
+
+  renderer_3d& renderer_3d::stop_watching_shaders() {
+    auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
+    auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    detail::stop_shader_hot_reload(ctx, rnd);
     return *this;
   }
 
@@ -940,11 +2652,28 @@ namespace {
     auto& rnd = reference_cast<detail::renderer_3d_impl>(implementation());
     auto& win = reference_cast<detail::window_impl>(parent().implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().parent().implementation());
+    OBERON_TRACE_ZONE("rebuild renderer");
+    // The present thread holds images of the old swapchain so the pipeline is restarted around the rebuild.
+    detail::stop_frame_pipeline(rnd);
     detail::wait_for_device_idle(ctx);
+    // The new swapchain images have undefined contents.
+    rnd.drawn_content_generation = -1ULL;
+    // The shader watcher builds pipelines against the render pass so it has to wait until the rebuild is complete.
+    // Pending pipelines are discarded but their shaders are used by the rebuilt pipelines.
+    auto reload_lock = std::lock_guard{ rnd.hot_reload.mutex };
+    detail::merge_reloaded_shader_modules(ctx, rnd);
+    // Bundles reference the old framebuffers and pipelines.
+    detail::invalidate_command_bundles(ctx, rnd);
     detail::destroy_vulkan_graphics_pipelines(ctx, rnd);
     detail::destroy_vulkan_framebuffers(ctx, rnd);
     detail::destroy_vulkan_renderpasses(ctx, rnd);
     detail::destroy_vulkan_swapchain(ctx, rnd);
+    // Images acquired but never drawn leave their semaphores signaled.
+    detail::destroy_vulkan_synchronization_objects(ctx, rnd);
+    if (OBERON_IS_IERROR(detail::create_vulkan_synchronization_objects(ctx, rnd)))
+    {
+      throw fatal_error{ "Failed to create Vulkan semaphores." };
+    }
     detail::retrieve_vulkan_surface_info(ctx, win, rnd);
     if (OBERON_IS_IERROR(detail::create_vulkan_swapchain(ctx, win, rnd)))
     {
@@ -964,6 +2693,11 @@ namespace {
       throw fatal_error{ "Failed to create Vulkan graphics pipelines." };
     }
     rnd.should_rebuild = false; // :-( don't forget to reset this flag!
+    // The new swapchain may have too few images for pipelined execution or enough for it again.
+    if (rnd.requested_execution == frame_execution::pipelined)
+    {
+      detail::start_frame_pipeline(ctx, rnd);
+    }
     return *this;
   }
 }
@@ -0,0 +1,198 @@
+#include "oberon/trace.hpp"
+
+#include <cstdio>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <chrono>
+
+namespace oberon {
+
+namespace {
+
+  // Events per thread. Each event is 32 bytes so every thread that records costs 2MiB.
+  constexpr usize TRACE_BUFFER_SIZE{ 64 * 1024 };
+
+  constexpr u32 CPU_TRACE_PROCESS{ 1 };
+  constexpr u32 GPU_TRACE_PROCESS{ 2 };
+
+  struct trace_event final {
+    cstring name{ };
+    trace_track track{ };
+    i64 begin{ };
+    i64 end{ };
+  };
+
+  struct trace_buffer final {
+    std::array<trace_event, TRACE_BUFFER_SIZE> events{ };
+    // Only the owning thread writes events. Readers only read events below size.
+    std::atomic<usize> size{ };
+    // The trace the events belong to. Buffers from earlier traces are emptied lazily by their owners.
+    std::atomic<u64> epoch{ };
+    std::atomic<cstring> name{ };
+    u32 thread_id{ };
+  };
+
+  std::atomic<bool> g_is_trace_active{ };
+  std::atomic<u64> g_trace_epoch{ };
+  std::atomic<i64> g_trace_start{ };
+  std::atomic<u64> g_dropped_trace_events{ };
+
+  // Buffers are never freed because thread local pointers to them may outlive their threads' use of them.
+  struct trace_buffer_list final {
+    std::mutex mutex{ };
+    std::vector<std::unique_ptr<trace_buffer>> buffers{ };
+  };
+
+  trace_buffer_list& get_trace_buffers() {
+    static auto buffers = trace_buffer_list{ };
+    return buffers;
+  }
+
+  thread_local ptr<trace_buffer> t_trace_buffer{ };
+
+  trace_buffer& get_thread_trace_buffer() {
+    if (!t_trace_buffer)
+    {
+      auto& list = get_trace_buffers();
+      auto lock = std::lock_guard{ list.mutex };
+      auto& buffer = list.buffers.emplace_back(new trace_buffer{ });
+      buffer->thread_id = std::size(list.buffers);
+      t_trace_buffer = buffer.get();
+    }
+    return *t_trace_buffer;
+  }
+
+  void write_json_string(const ptr<std::FILE> file, const cstring str) {
+    std::fputc('"', file);
+    for (auto cur = str; *cur; ++cur)
+    {
+      if (*cur == '"' || *cur == '\\')
+      {
+        std::fputc('\\', file);
+      }
+      std::fputc(*cur, file);
+    }
+    std::fputc('"', file);
+  }
+
+}
+
+  void start_trace() noexcept {
+    g_trace_start.store(trace_time(), std::memory_order_relaxed);
+    g_dropped_trace_events.store(0, std::memory_order_relaxed);
+    g_trace_epoch.fetch_add(1, std::memory_order_release);
+    g_is_trace_active.store(true, std::memory_order_release);
+  }
+
+  void stop_trace() noexcept {
+    g_is_trace_active.store(false, std::memory_order_release);
+  }
+
+  bool is_trace_active() noexcept {
+    return g_is_trace_active.load(std::memory_order_relaxed);
+  }
+
+  bool write_trace(const cstring path) noexcept {
+    auto file = std::fopen(path, "w");
+    if (!file)
+    {
+      return false;
+    }
+    auto start = g_trace_start.load(std::memory_order_relaxed);
+    auto epoch = g_trace_epoch.load(std::memory_order_acquire);
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"CPU\"}},\n",
+                 CPU_TRACE_PROCESS);
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"GPU\"}},\n",
+                 GPU_TRACE_PROCESS);
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":1,"
+                       "\"args\":{\"name\":\"graphics queue\"}}", GPU_TRACE_PROCESS);
+    auto& list = get_trace_buffers();
+    auto lock = std::lock_guard{ list.mutex };
+    for (const auto& buffer : list.buffers)
+    {
+      if (auto name = buffer->name.load(std::memory_order_relaxed); name)
+      {
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                     CPU_TRACE_PROCESS, buffer->thread_id);
+        write_json_string(file, name);
+        std::fprintf(file, "}}");
+      }
+      if (buffer->epoch.load(std::memory_order_relaxed) != epoch)
+      {
+        continue;
+      }
+      auto size = buffer->size.load(std::memory_order_acquire);
+      for (auto i = usize{ 0 }; i < size; ++i)
+      {
+        const auto& event = buffer->events[i];
+        auto is_gpu = event.track == trace_track::gpu;
+        std::fprintf(file, ",\n{\"name\":");
+        write_json_string(file, event.name);
+        // Chrome trace timestamps are in microseconds.
+        std::fprintf(file, ",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     is_gpu ? GPU_TRACE_PROCESS : CPU_TRACE_PROCESS, is_gpu ? 1 : buffer->thread_id,
+                     (event.begin - start) / 1000.0, (event.end - event.begin) / 1000.0);
+      }
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    auto is_written = !std::ferror(file);
+    return !std::fclose(file) && is_written;
+  }
+
+  u64 dropped_trace_events() noexcept {
+    return g_dropped_trace_events.load(std::memory_order_relaxed);
+  }
+
+  void set_trace_thread_name(const cstring name) noexcept {
+    get_thread_trace_buffer().name.store(name, std::memory_order_relaxed);
+  }
+
+  i64 trace_time() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+  }
+
+  void record_trace_event(const cstring name, const trace_track track, const i64 begin, const i64 end) noexcept {
+    if (!g_is_trace_active.load(std::memory_order_acquire))
+    {
+      return;
+    }
+    auto& buffer = get_thread_trace_buffer();
+    auto epoch = g_trace_epoch.load(std::memory_order_acquire);
+    if (buffer.epoch.load(std::memory_order_relaxed) != epoch)
+    {
+      buffer.size.store(0, std::memory_order_relaxed);
+      buffer.epoch.store(epoch, std::memory_order_relaxed);
+    }
+    auto size = buffer.size.load(std::memory_order_relaxed);
+    if (size == TRACE_BUFFER_SIZE)
+    {
+      g_dropped_trace_events.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    buffer.events[size] = { name, track, begin, end };
+    buffer.size.store(size + 1, std::memory_order_release);
+  }
+
+  trace_zone::trace_zone(const cstring name) noexcept {
+    if (is_trace_active())
+    {
+      m_name = name;
+      m_begin = trace_time();
+    }
+  }
+
+  trace_zone::~trace_zone() noexcept {
+    if (m_name)
+    {
+      record_trace_event(m_name, trace_track::cpu, m_begin, trace_time());
+    }
+  }
+
+}
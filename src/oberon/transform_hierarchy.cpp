@@ -0,0 +1,332 @@
+#include "oberon/transform_hierarchy.hpp"
+
+#include <algorithm>
+#include <array>
+
+#include "oberon/memory.hpp"
+#include "oberon/errors.hpp"
+#include "oberon/debug.hpp"
+#include "oberon/trace.hpp"
+
+#include "oberon/detail/worker_pool.hpp"
+
+namespace oberon {
+
+namespace {
+
+  // Large enough that claiming a chunk is negligible and small enough to balance deep, narrow hierarchies.
+  constexpr usize UPDATE_CHUNK_SIZE{ 2048 };
+  // Parent matrices are gathered into a stack buffer of this many matrices before each batch multiply.
+  constexpr usize MULTIPLY_BATCH_SIZE{ 64 };
+
+  template <typename Type>
+  void permute(std::vector<Type>& values, const std::vector<u32>& order) {
+    auto permuted = std::vector<Type>(std::size(values));
+    for (auto i = usize{ 0 }; i < std::size(order); ++i)
+    {
+      permuted[i] = values[order[i]];
+    }
+    values = std::move(permuted);
+  }
+
+}
+
+  u32 transform_hierarchy::position_of(const transform_node node) const {
+    if (node >= std::size(m_positions))
+    {
+      throw fatal_error{ "Invalid transform node." };
+    }
+    return m_positions[node];
+  }
+
+  void transform_hierarchy::mark_dirty(const u32 position) noexcept {
+    if (!m_local_dirty[position])
+    {
+      m_local_dirty[position] = true;
+      ++m_dirty_count;
+    }
+  }
+
+  // Stable counting sort by depth. Parents are always created before their children so the relative order of any
+  // two nodes of one depth is already consistent with the order of their parents.
+  void transform_hierarchy::sort_breadth_first() {
+    OBERON_TRACE_ZONE("sort transform hierarchy");
+    auto depth_count = usize{ 0 };
+    for (const auto depth : m_depths)
+    {
+      depth_count = std::max<usize>(depth_count, depth + 1);
+    }
+    m_depth_offsets.assign(depth_count + 1, 0);
+    for (const auto depth : m_depths)
+    {
+      ++m_depth_offsets[depth + 1];
+    }
+    for (auto i = usize{ 1 }; i < std::size(m_depth_offsets); ++i)
+    {
+      m_depth_offsets[i] += m_depth_offsets[i - 1];
+    }
+    auto order = std::vector<u32>(std::size(m_nodes));
+    {
+      auto next = std::vector<usize>(std::begin(m_depth_offsets), std::end(m_depth_offsets) - 1);
+      for (auto i = usize{ 0 }; i < std::size(m_depths); ++i)
+      {
+        order[next[m_depths[i]]++] = i;
+      }
+    }
+    auto new_positions = std::vector<u32>(std::size(order));
+    for (auto i = usize{ 0 }; i < std::size(order); ++i)
+    {
+      new_positions[order[i]] = i;
+    }
+    for (auto& parent : m_parents)
+    {
+      parent = parent != NO_POSITION ? new_positions[parent] : NO_POSITION;
+    }
+    permute(m_nodes, order);
+    permute(m_parents, order);
+    permute(m_depths, order);
+    permute(m_translations, order);
+    permute(m_rotations, order);
+    permute(m_scales, order);
+    permute(m_local_matrices, order);
+    permute(m_world_matrices, order);
+    permute(m_local_dirty, order);
+    permute(m_world_changed, order);
+    for (auto i = usize{ 0 }; i < std::size(m_nodes); ++i)
+    {
+      m_positions[m_nodes[i]] = i;
+    }
+    m_is_order_stale = false;
+  }
+
+  // Every parent of a node in [begin, end) has already been updated.
+  void transform_hierarchy::update_range(const usize begin, const usize end) noexcept {
+    for (auto i = begin; i < end; ++i)
+    {
+      auto parent = m_parents[i];
+      auto is_local_dirty = m_local_dirty[i];
+      if (is_local_dirty)
+      {
+        m_local_matrices[i] = compose_transform(m_translations[i], m_rotations[i], m_scales[i]);
+        m_local_dirty[i] = false;
+      }
+      m_world_changed[i] = is_local_dirty || (parent != NO_POSITION && m_world_changed[parent]);
+    }
+    // Multiply runs of changed nodes in batches so that the SIMD kernel sees contiguous locals and outputs.
+    auto parent_worlds = std::array<mat4, MULTIPLY_BATCH_SIZE>{ };
+    auto i = begin;
+    while (i < end)
+    {
+      if (!m_world_changed[i])
+      {
+        ++i;
+        continue;
+      }
+      auto batch_begin = i;
+      auto batch_size = usize{ 0 };
+      for (; i < end && batch_size < MULTIPLY_BATCH_SIZE && m_world_changed[i]; ++i, ++batch_size)
+      {
+        auto parent = m_parents[i];
+        parent_worlds[batch_size] = parent != NO_POSITION ? m_world_matrices[parent] : identity_mat4();
+      }
+      multiply_mat4({ std::data(parent_worlds), batch_size }, { &m_local_matrices[batch_begin], batch_size },
+                    { &m_world_matrices[batch_begin], batch_size });
+    }
+  }
+
+  transform_node transform_hierarchy::create_node(const transform_node parent, const transform& local) {
+    auto parent_position = parent != NO_TRANSFORM_NODE ? position_of(parent) : NO_POSITION;
+    auto depth = parent_position != NO_POSITION ? m_depths[parent_position] + 1 : 0;
+    auto node = static_cast<transform_node>(std::size(m_positions));
+    auto position = static_cast<u32>(std::size(m_nodes));
+    if (!std::empty(m_depths) && depth < m_depths.back())
+    {
+      m_is_order_stale = true;
+    }
+    m_positions.push_back(position);
+    m_nodes.push_back(node);
+    m_parents.push_back(parent_position);
+    m_depths.push_back(depth);
+    m_translations.push_back(local.translation);
+    m_rotations.push_back(local.rotation);
+    m_scales.push_back(local.scale);
+    m_local_matrices.push_back(identity_mat4());
+    m_world_matrices.push_back(identity_mat4());
+    m_local_dirty.push_back(false);
+    m_world_changed.push_back(false);
+    mark_dirty(position);
+    if (!m_is_order_stale)
+    {
+      if (depth + 1 >= std::size(m_depth_offsets))
+      {
+        m_depth_offsets.push_back(m_depth_offsets.back());
+      }
+      ++m_depth_offsets.back();
+    }
+    return node;
+  }
+
+  transform_node transform_hierarchy::create_node(const transform_node parent) {
+    return create_node(parent, transform{ });
+  }
+
+  void transform_hierarchy::clear() noexcept {
+    m_positions.clear();
+    m_nodes.clear();
+    m_parents.clear();
+    m_depths.clear();
+    m_translations.clear();
+    m_rotations.clear();
+    m_scales.clear();
+    m_local_matrices.clear();
+    m_world_matrices.clear();
+    m_local_dirty.clear();
+    m_world_changed.clear();
+    m_depth_offsets.assign(1, 0);
+    m_dirty_count = 0;
+    m_has_changed_worlds = false;
+    m_is_order_stale = false;
+  }
+
+  void transform_hierarchy::reserve(const usize node_count) {
+    m_positions.reserve(node_count);
+    m_nodes.reserve(node_count);
+    m_parents.reserve(node_count);
+    m_depths.reserve(node_count);
+    m_translations.reserve(node_count);
+    m_rotations.reserve(node_count);
+    m_scales.reserve(node_count);
+    m_local_matrices.reserve(node_count);
+    m_world_matrices.reserve(node_count);
+    m_local_dirty.reserve(node_count);
+    m_world_changed.reserve(node_count);
+  }
+
+  transform_hierarchy& transform_hierarchy::set_local(const transform_node node, const transform& local) {
+    auto position = position_of(node);
+    m_translations[position] = local.translation;
+    m_rotations[position] = local.rotation;
+    m_scales[position] = local.scale;
+    mark_dirty(position);
+    return *this;
+  }
+
+  transform_hierarchy& transform_hierarchy::set_translation(const transform_node node, const vec3& translation) {
+    auto position = position_of(node);
+    m_translations[position] = translation;
+    mark_dirty(position);
+    return *this;
+  }
+
+  transform_hierarchy& transform_hierarchy::set_rotation(const transform_node node, const quat& rotation) {
+    auto position = position_of(node);
+    m_rotations[position] = rotation;
+    mark_dirty(position);
+    return *this;
+  }
+
+  transform_hierarchy& transform_hierarchy::set_scale(const transform_node node, const vec3& scale) {
+    auto position = position_of(node);
+    m_scales[position] = scale;
+    mark_dirty(position);
+    return *this;
+  }
+
+  transform transform_hierarchy::local(const transform_node node) const {
+    auto position = position_of(node);
+    return { m_translations[position], m_rotations[position], m_scales[position] };
+  }
+
+  transform_node transform_hierarchy::parent(const transform_node node) const {
+    auto parent_position = m_parents[position_of(node)];
+    return parent_position != NO_POSITION ? m_nodes[parent_position] : NO_TRANSFORM_NODE;
+  }
+
+  const mat4& transform_hierarchy::world_matrix(const transform_node node) const {
+    return m_world_matrices[position_of(node)];
+  }
+
+  bool transform_hierarchy::has_changed(const transform_node node) const {
+    return m_world_changed[position_of(node)];
+  }
+
+  usize transform_hierarchy::instance_index(const transform_node node) const {
+    return position_of(node);
+  }
+
+  std::span<const mat4> transform_hierarchy::world_matrices() const noexcept {
+    return m_world_matrices;
+  }
+
+  usize transform_hierarchy::size() const noexcept {
+    return std::size(m_nodes);
+  }
+
+  usize transform_hierarchy::depth_count() const noexcept {
+    return std::size(m_depth_offsets) - 1;
+  }
+
+  void transform_hierarchy::update() {
+    OBERON_TRACE_ZONE("update transform hierarchy");
+    if (m_is_order_stale)
+    {
+      sort_breadth_first();
+    }
+    if (!m_dirty_count)
+    {
+      // Nothing changed this time so forget what changed last time.
+      if (m_has_changed_worlds)
+      {
+        std::fill(std::begin(m_world_changed), std::end(m_world_changed), false);
+        m_has_changed_worlds = false;
+      }
+      return;
+    }
+    auto& pool = detail::default_worker_pool();
+    for (auto depth = usize{ 0 }; depth < depth_count(); ++depth)
+    {
+      auto depth_begin = m_depth_offsets[depth];
+      pool.parallel_for(m_depth_offsets[depth + 1] - depth_begin, UPDATE_CHUNK_SIZE,
+                        [this, depth_begin](const usize begin, const usize end) {
+        update_range(depth_begin + begin, depth_begin + end);
+      });
+    }
+    m_dirty_count = 0;
+    m_has_changed_worlds = true;
+  }
+
+  void transform_hierarchy::update(const std::span<mat4> instances) {
+    OBERON_TRACE_ZONE("update transform hierarchy instances");
+    if (std::size(instances) < size())
+    {
+      throw fatal_error{ "Instance storage is too small for the transform hierarchy." };
+    }
+    if (m_is_order_stale)
+    {
+      sort_breadth_first();
+    }
+    auto is_dirty = m_dirty_count > 0;
+    if (!is_dirty && m_has_changed_worlds)
+    {
+      std::fill(std::begin(m_world_changed), std::end(m_world_changed), false);
+      m_has_changed_worlds = false;
+    }
+    auto& pool = detail::default_worker_pool();
+    for (auto depth = usize{ 0 }; depth < depth_count(); ++depth)
+    {
+      auto depth_begin = m_depth_offsets[depth];
+      pool.parallel_for(m_depth_offsets[depth + 1] - depth_begin, UPDATE_CHUNK_SIZE,
+                        [this, depth_begin, is_dirty, instances](const usize begin, const usize end) {
+        if (is_dirty)
+        {
+          update_range(depth_begin + begin, depth_begin + end);
+        }
+        std::copy(std::begin(m_world_matrices) + depth_begin + begin, std::begin(m_world_matrices) + depth_begin + end,
+                  std::begin(instances) + depth_begin + begin);
+      });
+    }
+    m_dirty_count = 0;
+    m_has_changed_worlds = m_has_changed_worlds || is_dirty;
+  }
+
+}
@@ -25,6 +25,7 @@ namespace detail {
       auto value_mask = XCB_CW_BACK_PIXEL | XCB_CW_OVERRIDE_REDIRECT | XCB_CW_EVENT_MASK;
       auto event_mask = XCB_EVENT_MASK_EXPOSURE |
                         XCB_EVENT_MASK_STRUCTURE_NOTIFY |
+                        XCB_EVENT_MASK_VISIBILITY_CHANGE |
                         XCB_EVENT_MASK_KEY_PRESS |
                         XCB_EVENT_MASK_KEY_RELEASE |
                         XCB_EVENT_MASK_POINTER_MOTION |
@@ -47,14 +48,9 @@ namespace detail {
       );
     }
     {
-      auto protocols_cookie = xcb_intern_atom(ctx.x11_connection, false, 12, "WM_PROTOCOLS");
-      auto delete_cookie = xcb_intern_atom(ctx.x11_connection, false, 16, "WM_DELETE_WINDOW");
-      auto* protocols_reply = xcb_intern_atom_reply(ctx.x11_connection, protocols_cookie, nullptr);
-      auto* delete_reply = xcb_intern_atom_reply(ctx.x11_connection, delete_cookie, nullptr);
-      window.x11_wm_protocols_atom = protocols_reply->atom;
-      window.x11_delete_atom = delete_reply->atom;
-      std::free(protocols_reply);
-      std::free(delete_reply);
+      // Atoms are interned when the context is created so that window creation never waits on the server.
+      window.x11_wm_protocols_atom = get_x11_atom(ctx, x11_atom::WM_PROTOCOLS);
+      window.x11_delete_atom = get_x11_atom(ctx, x11_atom::WM_DELETE_WINDOW);
       xcb_change_property(
         ctx.x11_connection,
         XCB_PROP_MODE_REPLACE,
@@ -77,10 +73,55 @@ namespace detail {
       );
     }
     window.bounds = bounds;
+    update_x11_window_monitor(ctx, window);
     OBERON_POSTCONDITION(window.x11_window);
     return 0;
   }
 
+  iresult create_fullscreen_x11_window(const context_impl& ctx, window_impl& window, bounding_rect& bounds) noexcept {
+    OBERON_PRECONDITION(ctx.x11_connection);
+    OBERON_PRECONDITION(!xcb_connection_has_error(ctx.x11_connection));
+    OBERON_PRECONDITION(ctx.x11_screen);
+    if (auto monitor = select_x11_monitor(ctx); monitor)
+    {
+      bounds = monitor->bounds;
+    }
+    else
+    {
+      bounds = { { 0, 0 }, { ctx.x11_screen->width_in_pixels, ctx.x11_screen->height_in_pixels } };
+    }
+    if (auto result = create_x11_window(ctx, window, bounds); OBERON_IS_IERROR(result))
+    {
+      return result;
+    }
+    // This must be set before the window is mapped. Afterwards the window manager has to be messaged instead.
+    auto fullscreen_atom = get_x11_atom(ctx, x11_atom::_NET_WM_STATE_FULLSCREEN);
+    xcb_change_property(
+      ctx.x11_connection,
+      XCB_PROP_MODE_REPLACE,
+      window.x11_window,
+      get_x11_atom(ctx, x11_atom::_NET_WM_STATE),
+      XCB_ATOM_ATOM,
+      32,
+      1,
+      &fullscreen_atom
+    );
+    // Ask compositors to unredirect the window. Otherwise every frame is copied by the compositor and displayed one
+    // composition cycle late.
+    auto bypass_compositor = u32{ 1 };
+    xcb_change_property(
+      ctx.x11_connection,
+      XCB_PROP_MODE_REPLACE,
+      window.x11_window,
+      get_x11_atom(ctx, x11_atom::_NET_WM_BYPASS_COMPOSITOR),
+      XCB_ATOM_CARDINAL,
+      32,
+      1,
+      &bypass_compositor
+    );
+    return 0;
+  }
+
   iresult create_vulkan_surface(const context_impl& ctx, window_impl& window) noexcept {
     OBERON_PRECONDITION(ctx.instance);
     OBERON_PRECONDITION(ctx.vkft.vkCreateXcbSurfaceKHR);
@@ -92,7 +133,7 @@ namespace detail {
     OBERON_INIT_VK_STRUCT(surface_info, XCB_SURFACE_CREATE_INFO_KHR);
     surface_info.connection = ctx.x11_connection;
     surface_info.window = window.x11_window;
-    auto result = vkCreateXcbSurfaceKHR(ctx.instance, &surface_info, nullptr, &window.surface);
+    auto result = vkCreateXcbSurfaceKHR(ctx.instance, &surface_info, ctx.host_allocator, &window.surface);
     if (result != VK_SUCCESS)
     {
       return result;
@@ -112,6 +153,29 @@ namespace detail {
 
 
 
+  iresult update_x11_window_monitor(const context_impl& ctx, window_impl& window) noexcept {
+    auto center_x = window.bounds.position.x + static_cast<isize>(window.bounds.size.width / 2);
+    auto center_y = window.bounds.position.y + static_cast<isize>(window.bounds.size.height / 2);
+    for (const auto& monitor : ctx.x11_monitors)
+    {
+      const auto& [ position, size ] = monitor.bounds;
+      if (center_x >= position.x && center_x < position.x + static_cast<isize>(size.width) &&
+          center_y >= position.y && center_y < position.y + static_cast<isize>(size.height))
+      {
+        window.x11_crtc = monitor.crtc;
+        window.refresh_rate = monitor.refresh_rate;
+        return 0;
+      }
+    }
+    // Fall back to the primary monitor so that a rate is always available when any monitor is known.
+    if (auto monitor = select_x11_monitor(ctx); monitor)
+    {
+      window.x11_crtc = monitor->crtc;
+      window.refresh_rate = monitor->refresh_rate;
+    }
+    return -1;
+  }
+
   iresult handle_x11_configure(window_impl& window, const ptr<xcb_configure_notify_event_t> ev) noexcept {
     OBERON_PRECONDITION(window.x11_window);
     auto result = iresult{ 0 };
@@ -139,6 +203,31 @@ namespace detail {
     return -1;
   }
 
+  iresult handle_x11_visibility(window_impl& window, const ptr<xcb_generic_event_t> ev) noexcept {
+    OBERON_PRECONDITION(window.x11_window);
+    switch (ev->response_type & 0x7f)
+    {
+    case XCB_MAP_NOTIFY:
+      window.is_hidden = false;
+      ++window.content_generation;
+      break;
+    case XCB_UNMAP_NOTIFY:
+      window.is_hidden = true;
+      break;
+    case XCB_VISIBILITY_NOTIFY:
+      window.is_obscured =
+        reinterpret_cast<ptr<xcb_visibility_notify_event_t>>(ev)->state == XCB_VISIBILITY_FULLY_OBSCURED;
+      break;
+    default:
+      return -1;
+    }
+    return is_window_visible(window);
+  }
+
+  bool is_window_visible(const window_impl& window) noexcept {
+    return !window.is_hidden && !window.is_obscured;
+  }
+
   iresult hide_x11_window(const context_impl& ctx, window_impl& window) noexcept {
     OBERON_PRECONDITION(ctx.x11_connection);
     OBERON_PRECONDITION(!xcb_connection_has_error(ctx.x11_connection));
@@ -156,7 +245,7 @@ namespace detail {
     OBERON_ASSERT(ctx.instance);
     OBERON_ASSERT(ctx.vkft.vkDestroySurfaceKHR);
     auto vkDestroySurfaceKHR = ctx.vkft.vkDestroySurfaceKHR;
-    vkDestroySurfaceKHR(ctx.instance, window.surface, nullptr);
+    vkDestroySurfaceKHR(ctx.instance, window.surface, ctx.host_allocator);
     window.surface = nullptr;
     OBERON_POSTCONDITION(!window.surface);
     return 0;
@@ -185,6 +274,16 @@ namespace detail {
   window::window(const context& ctx, const ptr<detail::window_impl> impl) : object{ impl, &ctx } { }
 
   window::window(const context& ctx) : object{ new detail::window_impl{ }, &ctx } {
+    auto& win = reference_cast<detail::window_impl>(implementation());
+    auto& ctx_impl = reference_cast<detail::context_impl>(parent().implementation());
+    auto bounds = bounding_rect{ };
+    detail::create_fullscreen_x11_window(ctx_impl, win, bounds);
+    detail::add_window_to_context(ctx_impl, win.x11_window, this);
+    if (OBERON_IS_IERROR(detail::create_vulkan_surface(ctx_impl, win)))
+    {
+      throw fatal_error{ "Failed to create Vulkan window surface." };
+    }
+    detail::display_x11_window(ctx_impl, win);
   }
 
   window::window(const context& ctx, const bounding_rect& bounds) : object{ new detail::window_impl{ }, &ctx } {
@@ -213,6 +312,11 @@ namespace detail {
     return win.is_hidden;
   }
 
+  bool window::is_visible() const {
+    auto& win = reference_cast<detail::window_impl>(implementation());
+    return detail::is_window_visible(win);
+  }
+
   window& window::show() {
     auto& win = reference_cast<detail::window_impl>(implementation());
     auto& ctx = reference_cast<detail::context_impl>(parent().implementation());
@@ -233,6 +337,11 @@ namespace detail {
     return *this;
   }
 
+  f64 window::refresh_rate() const {
+    auto& win = reference_cast<detail::window_impl>(implementation());
+    return win.refresh_rate;
+  }
+
   const extent_2d& window::size() const {
     auto& win = reference_cast<detail::window_impl>(implementation());
     return win.bounds.size;
@@ -0,0 +1,21 @@
+#version 450 core
+
+layout (location = 0) in vec3 i_position;
+
+// Indexed by the instance index each culled draw carries in its first_instance.
+layout (set = 0, binding = 0, std430) readonly buffer instance_transforms {
+  mat4 transforms[];
+};
+
+layout (push_constant) uniform view_parameters {
+  mat4 view_projection;
+} view;
+
+layout (location = 0) out vec4 o_color;
+
+void main() {
+  gl_Position = view.view_projection * transforms[gl_InstanceIndex] * vec4(i_position, 1.0);
+  // Neighbouring instances get unrelated colors so that they can be told apart without any material data.
+  uint hash = uint(gl_InstanceIndex) * 2654435761u;
+  o_color = vec4(vec3((hash >> 8) & 0xffu, (hash >> 16) & 0xffu, (hash >> 24) & 0xffu) / 255.0, 1.0);
+}
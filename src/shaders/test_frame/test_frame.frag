@@ -1,9 +1,16 @@
 #version 450 core
 
+// Specialized per pipeline variant so the branch is folded away by the driver.
+layout (constant_id = 0) const bool GRAYSCALE = false;
+
 layout (location = 0) in vec4 i_color;
 
 layout (location = 0) out vec4 final_color;
 
 void main() {
   final_color = i_color;
+  if (GRAYSCALE)
+  {
+    final_color.rgb = vec3(dot(i_color.rgb, vec3(0.2126, 0.7152, 0.0722)));
+  }
 }
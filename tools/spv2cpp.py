@@ -1,5 +1,8 @@
 #!/usr/bin/env python3
 
+import json
+import struct
+
 from pathlib import Path
 from argparse import ArgumentParser
 
@@ -11,12 +14,653 @@ from argparse import ArgumentParser
 #    subprocess.run(cmd, check=True)
 #    return output.read_bytes()
 
-def format_binary(name: str, binary: bytes):
-    binary_str = ''
-    for b in binary:
-        binary_str += f'0x{b:02x},'
+# SPIR-V reflection. Only the subset of the binary format needed to build pipeline layouts and vertex input state is
+# understood. Everything is resolved here so that the renderer never parses SPIR-V at runtime.
+
+SPIRV_MAGIC = 0x07230203
+
+OP_NAME = 5
+OP_ENTRY_POINT = 15
+OP_EXECUTION_MODE = 16
+OP_TYPE_BOOL = 20
+OP_TYPE_INT = 21
+OP_TYPE_FLOAT = 22
+OP_TYPE_VECTOR = 23
+OP_TYPE_MATRIX = 24
+OP_TYPE_IMAGE = 25
+OP_TYPE_SAMPLER = 26
+OP_TYPE_SAMPLED_IMAGE = 27
+OP_TYPE_ARRAY = 28
+OP_TYPE_RUNTIME_ARRAY = 29
+OP_TYPE_STRUCT = 30
+OP_TYPE_POINTER = 32
+OP_CONSTANT = 43
+OP_SPEC_CONSTANT_TRUE = 48
+OP_SPEC_CONSTANT_FALSE = 49
+OP_SPEC_CONSTANT = 50
+OP_VARIABLE = 59
+OP_DECORATE = 71
+OP_MEMBER_DECORATE = 72
+OP_TYPE_ACCELERATION_STRUCTURE = 5341
+
+DECORATION_SPEC_ID = 1
+DECORATION_BLOCK = 2
+DECORATION_BUFFER_BLOCK = 3
+DECORATION_ARRAY_STRIDE = 6
+DECORATION_MATRIX_STRIDE = 7
+DECORATION_BUILT_IN = 11
+DECORATION_LOCATION = 30
+DECORATION_BINDING = 33
+DECORATION_DESCRIPTOR_SET = 34
+DECORATION_OFFSET = 35
+
+EXECUTION_MODE_LOCAL_SIZE = 17
+
+STORAGE_UNIFORM_CONSTANT = 0
+STORAGE_INPUT = 1
+STORAGE_UNIFORM = 2
+STORAGE_PUSH_CONSTANT = 9
+STORAGE_STORAGE_BUFFER = 12
+
+DIM_BUFFER = 5
+DIM_SUBPASS_DATA = 6
+
+EXECUTION_MODEL_STAGES = {
+    0: 'VK_SHADER_STAGE_VERTEX_BIT',
+    1: 'VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT',
+    2: 'VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT',
+    3: 'VK_SHADER_STAGE_GEOMETRY_BIT',
+    4: 'VK_SHADER_STAGE_FRAGMENT_BIT',
+    5: 'VK_SHADER_STAGE_COMPUTE_BIT'
+}
+
+SCALAR_FORMAT_SUFFIXES = { 'float': 'SFLOAT', 'int': 'SINT', 'uint': 'UINT' }
+COMPONENT_NAMES = [ 'R', 'G', 'B', 'A' ]
+
+class ReflectionError(Exception):
+    pass
+
+def decode_words(path: Path, binary: bytes):
+    # Modules may be stored in either byte order. Words are always returned in their logical order.
+    if len(binary) % 4 != 0 or len(binary) < 20:
+        raise ReflectionError(f'{path} is not a SPIR-V module.')
+    words = struct.unpack(f'<{len(binary) // 4}I', binary)
+    if words[0] != SPIRV_MAGIC:
+        words = struct.unpack(f'>{len(binary) // 4}I', binary)
+        if words[0] != SPIRV_MAGIC:
+            raise ReflectionError(f'{path} is not a SPIR-V module.')
+    return words
+
+class Module:
+    def __init__(self, path: Path, words: tuple):
+        self.path = path
+        self.names = { }
+        self.decorations = { }
+        self.member_decorations = { }
+        self.types = { }
+        self.constants = { }
+        self.spec_constants = [ ]
+        self.variables = [ ]
+        self.stage = None
+        self.interface = set()
+        self.workgroup_size = None
+        cur = 5
+        while cur < len(words):
+            length = words[cur] >> 16
+            opcode = words[cur] & 0xffff
+            if length == 0:
+                raise ReflectionError(f'{path} contains an invalid instruction.')
+            self.parse_instruction(opcode, words[cur + 1:cur + length])
+            cur += length
+        if self.stage is None:
+            raise ReflectionError(f'{path} has no entry point.')
+
+    def parse_instruction(self, opcode: int, operands: tuple):
+        if opcode == OP_NAME:
+            self.names[operands[0]] = decode_string(operands[1:])
+        elif opcode == OP_ENTRY_POINT:
+            if self.stage is not None:
+                raise ReflectionError(f'{self.path} contains more than one entry point.')
+            if operands[0] not in EXECUTION_MODEL_STAGES:
+                raise ReflectionError(f'{self.path} uses an unsupported execution model.')
+            self.stage = EXECUTION_MODEL_STAGES[operands[0]]
+            name_words = (len(decode_string(operands[2:]).encode()) // 4) + 1
+            self.interface = set(operands[2 + name_words:])
+        elif opcode == OP_EXECUTION_MODE:
+            if operands[1] == EXECUTION_MODE_LOCAL_SIZE:
+                self.workgroup_size = tuple(operands[2:5])
+        elif opcode == OP_DECORATE:
+            self.decorations.setdefault(operands[0], { })[operands[1]] = operands[2:]
+        elif opcode == OP_MEMBER_DECORATE:
+            self.member_decorations.setdefault((operands[0], operands[1]), { })[operands[2]] = operands[3:]
+        elif opcode == OP_TYPE_BOOL:
+            self.types[operands[0]] = ('bool',)
+        elif opcode == OP_TYPE_INT:
+            self.types[operands[0]] = ('int' if operands[2] else 'uint', operands[1])
+        elif opcode == OP_TYPE_FLOAT:
+            self.types[operands[0]] = ('float', operands[1])
+        elif opcode == OP_TYPE_VECTOR or opcode == OP_TYPE_MATRIX:
+            kind = 'vector' if opcode == OP_TYPE_VECTOR else 'matrix'
+            self.types[operands[0]] = (kind, operands[1], operands[2])
+        elif opcode == OP_TYPE_IMAGE:
+            self.types[operands[0]] = ('image', operands[2], operands[6])
+        elif opcode == OP_TYPE_SAMPLER:
+            self.types[operands[0]] = ('sampler',)
+        elif opcode == OP_TYPE_SAMPLED_IMAGE:
+            self.types[operands[0]] = ('sampled_image',)
+        elif opcode == OP_TYPE_ARRAY:
+            self.types[operands[0]] = ('array', operands[1], operands[2])
+        elif opcode == OP_TYPE_RUNTIME_ARRAY:
+            self.types[operands[0]] = ('runtime_array', operands[1])
+        elif opcode == OP_TYPE_STRUCT:
+            self.types[operands[0]] = ('struct', operands[1:])
+        elif opcode == OP_TYPE_POINTER:
+            self.types[operands[0]] = ('pointer', operands[1], operands[2])
+        elif opcode == OP_TYPE_ACCELERATION_STRUCTURE:
+            self.types[operands[0]] = ('acceleration_structure',)
+        elif opcode in (OP_SPEC_CONSTANT_TRUE, OP_SPEC_CONSTANT_FALSE, OP_SPEC_CONSTANT):
+            self.spec_constants.append((operands[0], operands[1]))
+        elif opcode == OP_CONSTANT:
+            self.constants[operands[1]] = operands[2]
+        elif opcode == OP_VARIABLE:
+            self.variables.append((operands[0], operands[1]))
+
+    def decoration(self, id: int, decoration: int):
+        return self.decorations.get(id, { }).get(decoration)
+
+    def type_size(self, type_id: int):
+        type = self.types[type_id]
+        if type[0] in SCALAR_FORMAT_SUFFIXES:
+            return type[1] // 8
+        elif type[0] == 'vector':
+            return self.type_size(type[1]) * type[2]
+        elif type[0] == 'array':
+            stride = self.decoration(type_id, DECORATION_ARRAY_STRIDE)
+            if stride is None:
+                raise ReflectionError(f'{self.path} contains an array without an explicit stride.')
+            return stride[0] * self.constants[type[2]]
+        elif type[0] == 'struct':
+            size = 0
+            for index, member in enumerate(type[1]):
+                member_decorations = self.member_decorations.get((type_id, index), { })
+                offset = member_decorations.get(DECORATION_OFFSET, (0,))[0]
+                member_type = self.types[member]
+                if member_type[0] == 'matrix':
+                    stride = member_decorations.get(DECORATION_MATRIX_STRIDE)
+                    if stride is None:
+                        raise ReflectionError(f'{self.path} contains a matrix without an explicit stride.')
+                    member_size = stride[0] * member_type[2]
+                else:
+                    member_size = self.type_size(member)
+                size = max(size, offset + member_size)
+            return size
+        raise ReflectionError(f'{self.path} contains a block member with an unsupported type.')
+
+    def descriptor_type(self, variable_id: int, storage: int, type_id: int):
+        count = 1
+        type = self.types[type_id]
+        while type[0] == 'array' or type[0] == 'runtime_array':
+            if type[0] == 'runtime_array':
+                raise ReflectionError(f'{self.path} contains an unbounded descriptor array.')
+            count *= self.constants[type[2]]
+            type_id = type[1]
+            type = self.types[type_id]
+        if storage == STORAGE_STORAGE_BUFFER:
+            return 'VK_DESCRIPTOR_TYPE_STORAGE_BUFFER', count
+        elif storage == STORAGE_UNIFORM:
+            if self.decoration(type_id, DECORATION_BUFFER_BLOCK) is not None:
+                return 'VK_DESCRIPTOR_TYPE_STORAGE_BUFFER', count
+            return 'VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER', count
+        elif type[0] == 'sampler':
+            return 'VK_DESCRIPTOR_TYPE_SAMPLER', count
+        elif type[0] == 'sampled_image':
+            return 'VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER', count
+        elif type[0] == 'image':
+            dim, sampled = type[1], type[2]
+            if dim == DIM_SUBPASS_DATA:
+                return 'VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT', count
+            elif dim == DIM_BUFFER:
+                texel_type = 'UNIFORM' if sampled == 1 else 'STORAGE'
+                return f'VK_DESCRIPTOR_TYPE_{texel_type}_TEXEL_BUFFER', count
+            return ('VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE' if sampled == 1 else 'VK_DESCRIPTOR_TYPE_STORAGE_IMAGE'), count
+        elif type[0] == 'acceleration_structure':
+            return 'VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR', count
+        name = self.names.get(variable_id, str(variable_id))
+        raise ReflectionError(f'{self.path} uses an unsupported descriptor type for "{name}".')
+
+    def vertex_attributes(self):
+        attributes = [ ]
+        for type_id, id in self.variables:
+            pointer = self.types[type_id]
+            if pointer[1] != STORAGE_INPUT or id not in self.interface:
+                continue
+            if self.decoration(id, DECORATION_BUILT_IN) is not None:
+                continue
+            location = self.decoration(id, DECORATION_LOCATION)
+            if location is None:
+                raise ReflectionError(f'{self.path} contains a vertex input without a location.')
+            type = self.types[pointer[2]]
+            # Matrices occupy one location per column.
+            columns = 1
+            if type[0] == 'matrix':
+                columns = type[2]
+                type = self.types[type[1]]
+            components = 1
+            if type[0] == 'vector':
+                components = type[2]
+                type = self.types[type[1]]
+            if type[0] not in SCALAR_FORMAT_SUFFIXES or type[1] != 32:
+                raise ReflectionError(f'{self.path} contains a vertex input with an unsupported type.')
+            format = ''.join(f'{component}32' for component in COMPONENT_NAMES[:components])
+            for column in range(columns):
+                attributes.append((location[0] + column, f'VK_FORMAT_{format}_{SCALAR_FORMAT_SUFFIXES[type[0]]}',
+                                   components * 4))
+        return attributes
+
+    def specialization_constants(self):
+        constants = [ ]
+        for type_id, id in self.spec_constants:
+            spec_id = self.decoration(id, DECORATION_SPEC_ID)
+            if spec_id is None:
+                continue
+            type = self.types[type_id]
+            # Booleans are specialized with a VkBool32.
+            size = 4 if type[0] == 'bool' else type[1] // 8
+            constants.append((spec_id[0], size))
+        return constants
+
+    def resources(self):
+        bindings = [ ]
+        push_constant_size = 0
+        for type_id, id in self.variables:
+            pointer = self.types[type_id]
+            storage = pointer[1]
+            if storage == STORAGE_PUSH_CONSTANT:
+                push_constant_size = max(push_constant_size, self.type_size(pointer[2]))
+            elif storage in (STORAGE_UNIFORM_CONSTANT, STORAGE_UNIFORM, STORAGE_STORAGE_BUFFER):
+                set = self.decoration(id, DECORATION_DESCRIPTOR_SET)
+                binding = self.decoration(id, DECORATION_BINDING)
+                if set is None or binding is None:
+                    name = self.names.get(id, str(id))
+                    raise ReflectionError(f'{self.path} contains a resource "{name}" without a set or binding.')
+                descriptor_type, count = self.descriptor_type(id, storage, pointer[2])
+                bindings.append((set[0], binding[0], descriptor_type, count))
+        return bindings, push_constant_size
+
+def decode_string(words: tuple):
+    raw = struct.pack(f'<{len(words)}I', *words)
+    return raw[:raw.index(0)].decode()
+
+def fnv1a(text: str):
+    hash = 0xcbf29ce484222325
+    for b in text.encode():
+        hash ^= b
+        hash = (hash * 0x100000001b3) & 0xffffffffffffffff
+    return hash
+
+class ShaderLayout:
+    def __init__(self):
+        self.attributes = [ ]
+        self.bindings = { }
+        self.push_constant_stages = [ ]
+        self.push_constant_size = 0
+        self.specialization_constants = { }
+        self.stages = [ ]
+        self.workgroup_size = (0, 0, 0)
+
+    def add_module(self, module: Module):
+        self.stages.append(module.stage)
+        if 'VK_SHADER_STAGE_COMPUTE_BIT' in self.stages and len(self.stages) > 1:
+            raise ReflectionError(f'{module.path} combines a compute stage with other stages.')
+        if module.stage == 'VK_SHADER_STAGE_VERTEX_BIT':
+            self.attributes = sorted(module.vertex_attributes())
+        elif module.stage == 'VK_SHADER_STAGE_COMPUTE_BIT':
+            if module.workgroup_size is None:
+                raise ReflectionError(f'{module.path} has no literal workgroup size.')
+            self.workgroup_size = module.workgroup_size
+        bindings, push_constant_size = module.resources()
+        for set, binding, descriptor_type, count in bindings:
+            key = (set, binding)
+            if key in self.bindings:
+                existing = self.bindings[key]
+                if existing[0] != descriptor_type or existing[1] != count:
+                    raise ReflectionError(f'{module.path} redefines set {set} binding {binding} with a different type.')
+                existing[2].append(module.stage)
+            else:
+                self.bindings[key] = (descriptor_type, count, [ module.stage ])
+        for constant_id, size in module.specialization_constants():
+            existing = self.specialization_constants.setdefault(constant_id, (size, [ ]))
+            if existing[0] != size:
+                raise ReflectionError(f'{module.path} redefines specialization constant {constant_id} with a '
+                                      'different size.')
+            existing[1].append(module.stage)
+        if push_constant_size:
+            self.push_constant_stages.append(module.stage)
+            self.push_constant_size = max(self.push_constant_size, push_constant_size)
+
+    def is_compute(self):
+        return self.stages == [ 'VK_SHADER_STAGE_COMPUTE_BIT' ]
+
+    def sets(self):
+        # Sets are dense. Unused set numbers below the highest set get empty layouts.
+        count = max([ set for set, _ in self.bindings ], default=-1) + 1
+        result = [ [ ] for _ in range(count) ]
+        for (set, binding), (descriptor_type, count, stages) in sorted(self.bindings.items()):
+            result[set].append((binding, descriptor_type, count, ' | '.join(stages)))
+        return result
+
+def set_key(bindings: list):
+    return fnv1a(';'.join(f'{binding},{type},{count},{stages}' for binding, type, count, stages in bindings))
+
+def layout_key(sets: list, push_constant_stages: str, push_constant_size: int):
+    text = '/'.join(f'{set_key(bindings):016x}' for bindings in sets)
+    return fnv1a(f'{text}|{push_constant_stages},{push_constant_size}')
+
+def format_layout(name: str, layout: ShaderLayout):
+    stride = 0
+    attributes = ''
+    for location, format, size in layout.attributes:
+        attributes += f'{{ {location}, {format}, {stride} }},'
+        stride += size
+    sets = layout.sets()
+    set_arrays = ''
+    set_entries = ''
+    for index, bindings in enumerate(sets):
+        entries = ''.join(f'{{ {binding}, {type}, {count}, {stages} }},' for binding, type, count, stages in bindings)
+        set_arrays += f"""
+  constexpr std::array<oberon::detail::builtin_descriptor_binding, {len(bindings)}>
+  sg_{name}_set_{index}{{ {{ {entries} }} }};
+"""
+        set_entries += f'{{ sg_{name}_set_{index}, 0x{set_key(bindings):016x}ULL }},'
+    push_constant_stages = ' | '.join(layout.push_constant_stages) or '0'
+    push_constant_ranges = ''
+    if layout.push_constant_size:
+        push_constant_ranges = f'{{ {push_constant_stages}, 0, {layout.push_constant_size} }},'
+    key = layout_key(sets, push_constant_stages, layout.push_constant_size)
+    constants = sorted(layout.specialization_constants.items())
+    constant_entries = ''.join(f'{{ {id}, {size}, {" | ".join(stages)} }},' for id, (size, stages) in constants)
+    workgroup_size = ', '.join(str(size) for size in layout.workgroup_size)
+    return f"""
+  constexpr std::array<oberon::detail::builtin_vertex_attribute, {len(layout.attributes)}>
+  sg_{name}_vertex_attributes{{ {{ {attributes} }} }};
+{set_arrays}
+  constexpr std::array<oberon::detail::builtin_descriptor_set, {len(sets)}>
+  sg_{name}_sets{{ {{ {set_entries} }} }};
+
+  constexpr std::array<VkPushConstantRange, {1 if layout.push_constant_size else 0}>
+  sg_{name}_push_constant_ranges{{ {{ {push_constant_ranges} }} }};
+
+  constexpr std::array<oberon::detail::builtin_specialization_constant, {len(constants)}>
+  sg_{name}_specialization_constants{{ {{ {constant_entries} }} }};
+
+  constexpr oberon::detail::builtin_shader_layout sg_{name}_layout{{
+    sg_{name}_vertex_attributes, {stride}, sg_{name}_sets, sg_{name}_push_constant_ranges, 0x{key:016x}ULL,
+    sg_{name}_specialization_constants, {{ {workgroup_size} }}
+  }};
+"""
+
+def format_layout_template(name: str):
     return f"""
-  static const std::array<uchar, {len(binary)}> sg_{name}{{ {binary_str} }};
+  template <>
+  const builtin_shader_layout& get_builtin_shader_layout<builtin_shader_name::{name}>() noexcept {{
+    return sg_{name}_layout;
+  }}
+"""
+
+# Pipeline descriptions. A description is a JSON object naming the fixed function state of a shader's pipeline. Every
+# key is optional. Enumerants are written as the lower case suffix of their Vulkan name (e.g. "triangle_list" for
+# VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST). Viewports and scissors are always dynamic.
+#
+#   topology, primitive_restart, patch_control_points, polygon_mode, cull_mode, front_face, line_width, samples,
+#   depth (an object with test, write and compare_op), blend (a list of objects with enable, src_color, dst_color,
+#   color_op, src_alpha, dst_alpha, alpha_op and write_mask), dynamic_states
+
+PIPELINE_DEFAULTS = {
+    'topology': 'triangle_list',
+    'primitive_restart': False,
+    'patch_control_points': 0,
+    'polygon_mode': 'fill',
+    'cull_mode': 'back',
+    'front_face': 'counter_clockwise',
+    'line_width': 1.0,
+    'samples': 1,
+    'depth': None,
+    'blend': [ { } ],
+    'dynamic_states': [ ]
+}
+
+DEPTH_DEFAULTS = { 'test': True, 'write': True, 'compare_op': 'less' }
+
+BLEND_DEFAULTS = {
+    'enable': False,
+    'src_color': 'one',
+    'dst_color': 'zero',
+    'color_op': 'add',
+    'src_alpha': 'one',
+    'dst_alpha': 'zero',
+    'alpha_op': 'add',
+    'write_mask': 'rgba'
+}
+
+CULL_MODES = {
+    'none': 'VK_CULL_MODE_NONE',
+    'front': 'VK_CULL_MODE_FRONT_BIT',
+    'back': 'VK_CULL_MODE_BACK_BIT',
+    'front_and_back': 'VK_CULL_MODE_FRONT_AND_BACK'
+}
+
+ALWAYS_DYNAMIC_STATES = [ 'viewport', 'scissor' ]
+
+class DescriptionError(Exception):
+    pass
+
+def apply_defaults(path: Path, what: str, value, defaults: dict):
+    if not isinstance(value, dict):
+        raise DescriptionError(f'{path}: {what} must be an object.')
+    unknown = sorted(set(value) - set(defaults))
+    if unknown:
+        raise DescriptionError(f'{path}: {what} has unknown keys {", ".join(unknown)}.')
+    return { **defaults, **value }
+
+def enumerant(path: Path, prefix: str, value):
+    if not isinstance(value, str) or not value.replace('_', '').isalnum():
+        raise DescriptionError(f'{path}: "{value}" is not a valid {prefix} enumerant.')
+    return f'{prefix}{value.upper()}'
+
+def boolean(value):
+    return 'VK_TRUE' if value else 'VK_FALSE'
+
+def read_pipeline_description(path: Path):
+    try:
+        description = json.loads(path.read_text())
+    except json.JSONDecodeError as error:
+        raise DescriptionError(f'{path}: {error}')
+    description = apply_defaults(path, 'the description', description, PIPELINE_DEFAULTS)
+    if description['depth'] is not None:
+        description['depth'] = apply_defaults(path, 'depth', description['depth'], DEPTH_DEFAULTS)
+    if not isinstance(description['blend'], list):
+        raise DescriptionError(f'{path}: blend must be a list with one entry per color attachment.')
+    description['blend'] = [ apply_defaults(path, 'a blend attachment', attachment, BLEND_DEFAULTS)
+                             for attachment in description['blend'] ]
+    if description['cull_mode'] not in CULL_MODES:
+        raise DescriptionError(f'{path}: "{description["cull_mode"]}" is not a valid cull mode.')
+    if description['samples'] not in (1, 2, 4, 8, 16, 32, 64):
+        raise DescriptionError(f'{path}: samples must be a power of two no greater than 64.')
+    return description
+
+def format_write_mask(path: Path, mask: str):
+    if any(component not in 'rgba' for component in mask):
+        raise DescriptionError(f'{path}: "{mask}" is not a valid write mask.')
+    return ' | '.join(f'VK_COLOR_COMPONENT_{component.upper()}_BIT' for component in 'rgba' if component in mask) or '0'
+
+def format_struct(type: str, name: str, fields: list):
+    # Every member is named so that the tables stay readable and nothing is silently value initialized.
+    members = ',\n'.join(f'    .{field} = {value}' for field, value in fields)
+    return f"""
+  constexpr {type} {name}{{
+{members}
+  }};
+"""
+
+def create_info_header(structure_type: str):
+    return [ ('sType', f'VK_STRUCTURE_TYPE_{structure_type}'), ('pNext', 'nullptr'), ('flags', '0') ]
+
+def format_pipeline_description(name: str, path: Path, description: dict, layout: ShaderLayout):
+    # Vertex input comes from reflection rather than the description.
+    stride = 0
+    attributes = ''
+    for location, format, size in layout.attributes:
+        attributes += f'{{ {location}, 0, {format}, {stride} }},'
+        stride += size
+    bindings = f'{{ 0, {stride}, VK_VERTEX_INPUT_RATE_VERTEX }},' if layout.attributes else ''
+    result = f"""
+  constexpr std::array<VkVertexInputAttributeDescription, {len(layout.attributes)}>
+  sg_{name}_vertex_attribute_descriptions{{ {{ {attributes} }} }};
+
+  constexpr std::array<VkVertexInputBindingDescription, {1 if layout.attributes else 0}>
+  sg_{name}_vertex_binding_descriptions{{ {{ {bindings} }} }};
+"""
+    result += format_struct('VkPipelineVertexInputStateCreateInfo', f'sg_{name}_vertex_input_state',
+                            create_info_header('PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO') + [
+        ('vertexBindingDescriptionCount', f'std::size(sg_{name}_vertex_binding_descriptions)'),
+        ('pVertexBindingDescriptions', f'std::data(sg_{name}_vertex_binding_descriptions)'),
+        ('vertexAttributeDescriptionCount', f'std::size(sg_{name}_vertex_attribute_descriptions)'),
+        ('pVertexAttributeDescriptions', f'std::data(sg_{name}_vertex_attribute_descriptions)')
+    ])
+    result += format_struct('VkPipelineInputAssemblyStateCreateInfo', f'sg_{name}_input_assembly_state',
+                            create_info_header('PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO') + [
+        ('topology', enumerant(path, 'VK_PRIMITIVE_TOPOLOGY_', description['topology'])),
+        ('primitiveRestartEnable', boolean(description['primitive_restart']))
+    ])
+    tessellation = 'nullptr'
+    if description['patch_control_points']:
+        tessellation = f'&sg_{name}_tessellation_state'
+        result += format_struct('VkPipelineTessellationStateCreateInfo', f'sg_{name}_tessellation_state',
+                                create_info_header('PIPELINE_TESSELLATION_STATE_CREATE_INFO') + [
+            ('patchControlPoints', str(int(description['patch_control_points'])))
+        ])
+    result += format_struct('VkPipelineViewportStateCreateInfo', f'sg_{name}_viewport_state',
+                            create_info_header('PIPELINE_VIEWPORT_STATE_CREATE_INFO') + [
+        ('viewportCount', '1'),
+        ('pViewports', 'nullptr'),
+        ('scissorCount', '1'),
+        ('pScissors', 'nullptr')
+    ])
+    result += format_struct('VkPipelineRasterizationStateCreateInfo', f'sg_{name}_rasterization_state',
+                            create_info_header('PIPELINE_RASTERIZATION_STATE_CREATE_INFO') + [
+        ('depthClampEnable', 'VK_FALSE'),
+        ('rasterizerDiscardEnable', 'VK_FALSE'),
+        ('polygonMode', enumerant(path, 'VK_POLYGON_MODE_', description['polygon_mode'])),
+        ('cullMode', CULL_MODES[description['cull_mode']]),
+        ('frontFace', enumerant(path, 'VK_FRONT_FACE_', description['front_face'])),
+        ('depthBiasEnable', 'VK_FALSE'),
+        ('depthBiasConstantFactor', '0.0f'),
+        ('depthBiasClamp', '0.0f'),
+        ('depthBiasSlopeFactor', '0.0f'),
+        ('lineWidth', f'{float(description["line_width"])}f')
+    ])
+    result += format_struct('VkPipelineMultisampleStateCreateInfo', f'sg_{name}_multisample_state',
+                            create_info_header('PIPELINE_MULTISAMPLE_STATE_CREATE_INFO') + [
+        ('rasterizationSamples', f'VK_SAMPLE_COUNT_{description["samples"]}_BIT'),
+        ('sampleShadingEnable', 'VK_FALSE'),
+        ('minSampleShading', '0.0f'),
+        ('pSampleMask', 'nullptr'),
+        ('alphaToCoverageEnable', 'VK_FALSE'),
+        ('alphaToOneEnable', 'VK_FALSE')
+    ])
+    depth_stencil = 'nullptr'
+    if description['depth'] is not None:
+        depth = description['depth']
+        depth_stencil = f'&sg_{name}_depth_stencil_state'
+        result += format_struct('VkPipelineDepthStencilStateCreateInfo', f'sg_{name}_depth_stencil_state',
+                                create_info_header('PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO') + [
+            ('depthTestEnable', boolean(depth['test'])),
+            ('depthWriteEnable', boolean(depth['write'])),
+            ('depthCompareOp', enumerant(path, 'VK_COMPARE_OP_', depth['compare_op'])),
+            ('depthBoundsTestEnable', 'VK_FALSE'),
+            ('stencilTestEnable', 'VK_FALSE'),
+            ('front', '{ }'),
+            ('back', '{ }'),
+            ('minDepthBounds', '0.0f'),
+            ('maxDepthBounds', '1.0f')
+        ])
+    blend_attachments = ''
+    for attachment in description['blend']:
+        blend_attachments += f"""
+    {{
+      {boolean(attachment['enable'])},
+      {enumerant(path, 'VK_BLEND_FACTOR_', attachment['src_color'])},
+      {enumerant(path, 'VK_BLEND_FACTOR_', attachment['dst_color'])},
+      {enumerant(path, 'VK_BLEND_OP_', attachment['color_op'])},
+      {enumerant(path, 'VK_BLEND_FACTOR_', attachment['src_alpha'])},
+      {enumerant(path, 'VK_BLEND_FACTOR_', attachment['dst_alpha'])},
+      {enumerant(path, 'VK_BLEND_OP_', attachment['alpha_op'])},
+      {format_write_mask(path, attachment['write_mask'])}
+    }},"""
+    result += f"""
+  constexpr std::array<VkPipelineColorBlendAttachmentState, {len(description['blend'])}>
+  sg_{name}_color_blend_attachments{{ {{{blend_attachments}
+  }} }};
+"""
+    result += format_struct('VkPipelineColorBlendStateCreateInfo', f'sg_{name}_color_blend_state',
+                            create_info_header('PIPELINE_COLOR_BLEND_STATE_CREATE_INFO') + [
+        ('logicOpEnable', 'VK_FALSE'),
+        ('logicOp', 'VK_LOGIC_OP_CLEAR'),
+        ('attachmentCount', f'std::size(sg_{name}_color_blend_attachments)'),
+        ('pAttachments', f'std::data(sg_{name}_color_blend_attachments)'),
+        ('blendConstants', '{ 0.0f, 0.0f, 0.0f, 0.0f }')
+    ])
+    dynamic_states = list(ALWAYS_DYNAMIC_STATES)
+    for state in description['dynamic_states']:
+        if state not in dynamic_states:
+            dynamic_states.append(state)
+    dynamic_state_entries = ', '.join(enumerant(path, 'VK_DYNAMIC_STATE_', state) for state in dynamic_states)
+    result += f"""
+  constexpr std::array<VkDynamicState, {len(dynamic_states)}>
+  sg_{name}_dynamic_states{{ {{ {dynamic_state_entries} }} }};
+"""
+    result += format_struct('VkPipelineDynamicStateCreateInfo', f'sg_{name}_dynamic_state',
+                            create_info_header('PIPELINE_DYNAMIC_STATE_CREATE_INFO') + [
+        ('dynamicStateCount', f'std::size(sg_{name}_dynamic_states)'),
+        ('pDynamicStates', f'std::data(sg_{name}_dynamic_states)')
+    ])
+    return result + f"""
+  constexpr oberon::detail::builtin_pipeline_description sg_{name}_pipeline_description{{
+    &sg_{name}_vertex_input_state,
+    &sg_{name}_input_assembly_state,
+    {tessellation},
+    &sg_{name}_viewport_state,
+    &sg_{name}_rasterization_state,
+    &sg_{name}_multisample_state,
+    {depth_stencil},
+    &sg_{name}_color_blend_state,
+    &sg_{name}_dynamic_state
+  }};
+"""
+
+# Compute shaders have no fixed function state so they're given an empty description in place of one.
+def format_empty_pipeline_description(name: str):
+    return f"""
+  constexpr oberon::detail::builtin_pipeline_description sg_{name}_pipeline_description{{ }};
+"""
+
+def format_pipeline_description_template(name: str):
+    return f"""
+  template <>
+  const builtin_pipeline_description& get_builtin_pipeline_description<builtin_shader_name::{name}>() noexcept {{
+    return sg_{name}_pipeline_description;
+  }}
+"""
+
+def format_binary(name: str, words: tuple):
+    # Vulkan consumes SPIR-V as host order u32 words so the module is embedded as words rather than bytes. That keeps
+    # the code correctly aligned for VkShaderModuleCreateInfo without copying it at runtime.
+    rows = [ ','.join(f'0x{word:08x}' for word in words[i:i + 8]) for i in range(0, len(words), 8) ]
+    words_str = ',\n    '.join(rows)
+    return f"""
+  alignas(4) constexpr std::array<u32, {len(words)}> sg_{name}{{ {{
+    {words_str}
+  }} }};
 """
 
 def stage_name_from_path(src: Path):
@@ -46,12 +690,27 @@ def format_template(name: str, array_name: str, stage: str):
   template <>
   iresult
   get_builtin_shader_binary<builtin_shader_name::{name}, {stage}>(readonly_ptr<u32>& code, usize& size) noexcept {{
-    code = reinterpret_cast<readonly_ptr<u32>>(std::data(sg_{array_name}));
-    size = std::size(sg_{array_name});
+    code = std::data(sg_{array_name});
+    size = std::size(sg_{array_name}) * sizeof(u32);
     return 0;
   }}
 """
 
+def format_stages(name: str, stages: list):
+    entries = ''.join(f'{{ {stage}, sg_{array_name} }},' for stage, array_name in stages)
+    return f"""
+  constexpr std::array<oberon::detail::builtin_shader_stage, {len(stages)}>
+  sg_{name}_stages{{ {{ {entries} }} }};
+"""
+
+def format_stages_template(name: str):
+    return f"""
+  template <>
+  std::span<const builtin_shader_stage> get_builtin_shader_stages<builtin_shader_name::{name}>() noexcept {{
+    return sg_{name}_stages;
+  }}
+"""
+
 
 SOURCE_FILE = """
 #include "oberon/detail/builtin_shaders.hpp"
@@ -59,7 +718,7 @@ SOURCE_FILE = """
 #include <array>
 
 namespace {{
-    using oberon::uchar;
+    using oberon::u32;
 
     {binaries}
 
@@ -80,6 +739,8 @@ parser.add_argument('sources', metavar='SOURCES', nargs='+', type=str,
                     help='SPIR-V files to build C++ source from.')
 parser.add_argument('--shader-name', dest='shader_name', type=str, default='',
                     help='The desired name of the resulting shader. If no name is provided it will be inferred.')
+parser.add_argument('--pipeline', type=str, default='',
+                    help='A JSON pipeline description to build fixed function state tables from.')
 parser.add_argument('-o', '--output', type=str, default='.',
                     help='A path to write output to.')
 parser.add_argument('-v', '--version', action='version', version='1.0.0',
@@ -88,12 +749,42 @@ args = parser.parse_args()
 
 binaries = ''
 templates = ''
+layouts = { }
+stages = { }
 for src in [ Path(src) for src in args.sources ]:
     stage_name = stage_name_from_path(src)
+    stage_bit = stage_bit_from_name(stage_name)
     shader_name = args.shader_name if len(args.shader_name) > 0 else src.stem.replace('.', '_')
     array_name = f'{shader_name}_{stage_name}'
-    binaries += format_binary(array_name, src.read_bytes())
-    templates += format_template(shader_name, array_name, stage_bit_from_name(stage_name))
+    try:
+        words = decode_words(src, src.read_bytes())
+        layouts.setdefault(shader_name, ShaderLayout()).add_module(Module(src, words))
+    except ReflectionError as error:
+        parser.exit(1, f'spv2cpp: error: {error}\n')
+    binaries += format_binary(array_name, words)
+    templates += format_template(shader_name, array_name, stage_bit)
+    stages.setdefault(shader_name, [ ]).append((stage_bit, array_name))
+
+if args.pipeline and len(layouts) != 1:
+    parser.error('a pipeline description requires every source to belong to the same shader')
+
+for shader_name, layout in layouts.items():
+    binaries += format_layout(shader_name, layout)
+    binaries += format_stages(shader_name, stages[shader_name])
+    templates += format_layout_template(shader_name)
+    templates += format_stages_template(shader_name)
+    if layout.is_compute():
+        if args.pipeline:
+            parser.error('a pipeline description can\'t be used with a compute shader')
+        binaries += format_empty_pipeline_description(shader_name)
+        templates += format_pipeline_description_template(shader_name)
+    elif args.pipeline:
+        try:
+            pipeline = Path(args.pipeline)
+            binaries += format_pipeline_description(shader_name, pipeline, read_pipeline_description(pipeline), layout)
+        except DescriptionError as error:
+            parser.exit(1, f'spv2cpp: error: {error}\n')
+        templates += format_pipeline_description_template(shader_name)
 
 output_file = open(Path(args.output), 'w')
 print(SOURCE_FILE.format(binaries=binaries, templates=templates), file=output_file)
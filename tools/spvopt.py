@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+import struct
+import shutil
+import subprocess
+
+from pathlib import Path
+from argparse import ArgumentParser
+
+SPIRV_MAGIC = 0x07230203
+SPIRV_HEADER_WORDS = 5
+
+def count_instructions(binary: bytes):
+    if len(binary) % 4 != 0 or len(binary) < SPIRV_HEADER_WORDS * 4:
+        return 0
+    order = '<' if struct.unpack('<I', binary[:4])[0] == SPIRV_MAGIC else '>'
+    words = struct.unpack(f'{order}{len(binary) // 4}I', binary)
+    count = 0
+    cur = SPIRV_HEADER_WORDS
+    while cur < len(words):
+        length = words[cur] >> 16
+        if length == 0:
+            break
+        count += 1
+        cur += length
+    return count
+
+def format_change(before: int, after: int):
+    if before == 0:
+        return f'{before:>8} -> {after:>8}'
+    return f'{before:>8} -> {after:>8} ({(after - before) * 100 / before:+6.1f}%)'
+
+def optimize(spirv_opt: str, mode: str, target_env: str, source: Path, output: Path):
+    if mode == 'none' or not spirv_opt:
+        shutil.copyfile(source, output)
+        return
+    flag = '-Os' if mode == 'size' else '-O'
+    cmd = [ spirv_opt, flag, f'--target-env={target_env}', '-o', str(output), str(source) ]
+    subprocess.run(cmd, check=True)
+
+def validate(spirv_val: str, target_env: str, output: Path):
+    if not spirv_val:
+        return
+    cmd = [ spirv_val, '--target-env', target_env, str(output) ]
+    subprocess.run(cmd, check=True)
+
+
+parser = ArgumentParser(description='Optimizes and validates SPIR-V binaries and reports how they changed.')
+parser.add_argument('--inputs', metavar='INPUTS', nargs='+', type=str, required=True,
+                    help='SPIR-V files to optimize.')
+parser.add_argument('--outputs', metavar='OUTPUTS', nargs='+', type=str, required=True,
+                    help='Paths to write optimized SPIR-V to. One per input in the same order.')
+parser.add_argument('--report', type=str, required=True,
+                    help='A path to write the instruction count and size report to.')
+parser.add_argument('--mode', choices=[ 'performance', 'size', 'none' ], default='performance',
+                    help='The spirv-opt pass set to run. None only validates.')
+parser.add_argument('--target-env', dest='target_env', type=str, default='vulkan1.2',
+                    help='The target environment passed to spirv-opt and spirv-val.')
+parser.add_argument('--spirv-opt', dest='spirv_opt', type=str, default='',
+                    help='The spirv-opt executable. If empty the binaries are copied unchanged.')
+parser.add_argument('--spirv-val', dest='spirv_val', type=str, default='',
+                    help='The spirv-val executable. If empty the binaries are not validated.')
+parser.add_argument('-v', '--version', action='version', version='1.0.0',
+                    help='Report version information.')
+args = parser.parse_args()
+
+if len(args.inputs) != len(args.outputs):
+    parser.error('the number of inputs and outputs must match')
+
+lines = [ f'mode: {args.mode}', f'{"stage":<32} {"instructions":<28} {"bytes"}' ]
+for source, output in zip([ Path(src) for src in args.inputs ], [ Path(dst) for dst in args.outputs ]):
+    try:
+        optimize(args.spirv_opt, args.mode, args.target_env, source, output)
+        validate(args.spirv_val, args.target_env, output)
+    except subprocess.CalledProcessError as error:
+        parser.exit(1, f'spvopt: error: {error}\n')
+    before = source.read_bytes()
+    after = output.read_bytes()
+    instructions = format_change(count_instructions(before), count_instructions(after))
+    size = format_change(len(before), len(after))
+    lines.append(f'{source.stem:<32} {instructions:<28} {size}')
+
+report_file = open(Path(args.report), 'w')
+print('\n'.join(line.rstrip() for line in lines), file=report_file)
+report_file.close()